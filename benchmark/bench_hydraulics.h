@@ -0,0 +1,248 @@
+﻿#pragma once
+
+/// @brief Расчет профиля давления методом Эйлера (задача PQ с партиями)
+static void bench_solve_euler(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+    vector<double> density(point_count, 850);
+    vector<double> viscosity(point_count, 15e-6);
+    vector<double> pressure(point_count);
+
+    int euler_direction = +1;
+    isothermal_pipe_PQ_parties_t<double> pipe_model(pipe, density, viscosity, 0.2, euler_direction);
+
+    for (auto _ : state) {
+        solve_euler<1>(pipe_model, euler_direction, 6e6, &pressure);
+        benchmark::DoNotOptimize(pressure.data());
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK(bench_solve_euler)->Apply(grid_sizes);
+
+/// @brief Расчет профиля давления накопленной суммой; аргумент 2 - количество потоков (1 - без разбиения)
+static void bench_solve_euler_state_independent(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    size_t thread_count = static_cast<size_t>(state.range(1));
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+    vector<double> density(point_count, 850);
+    vector<double> viscosity(point_count, 15e-6);
+    vector<double> pressure(point_count);
+
+    int euler_direction = +1;
+    isothermal_pipe_PQ_parties_t<double> pipe_model(pipe, density, viscosity, 0.2, euler_direction);
+    thread_pool_t pool(thread_count);
+    domain_decomposition_t decomposition(pool, point_count);
+    const domain_decomposition_t* used_decomposition = thread_count > 1 ? &decomposition : nullptr;
+
+    for (auto _ : state) {
+        solve_euler_state_independent<1>(pipe_model, euler_direction, 6e6, &pressure, used_decomposition);
+        benchmark::DoNotOptimize(pressure.data());
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK(bench_solve_euler_state_independent)
+    ->ArgsProduct({ { 1000, 100000, 1000000 }, { 1, 4 } })
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+/// @brief Стационарный расчет по граничным давлениям (метод Ньютона поверх метода Эйлера)
+static void bench_solve_pipe_PP(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+    oil_parameters_t oil;
+    PipeModelPGConstArea pipe_model(pipe, oil);
+
+    profile_collection_t<2> layer(point_count);
+    profile_wrapper<double, 2> start_layer(get_profiles_pointers(layer.point_double));
+
+    for (auto _ : state) {
+        double G = solve_pipe_PP(pipe_model, 6e6, 1e6, &start_layer);
+        benchmark::DoNotOptimize(G);
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK(bench_solve_pipe_PP)->Apply(grid_sizes);
+
+/// @brief Стационарный расчет по однородным участкам партий (10 партий): расход по граничным давлениям
+/// и давление на выходе; время расчета не зависит от шага сетки
+static void bench_batch_hydraulic_solver(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+    vector<double> density(point_count - 1);
+    vector<double> viscosity(point_count - 1);
+    for (size_t index = 0; index < density.size(); ++index) {
+        size_t batch = 10 * index / density.size();
+        density[index] = batch % 2 == 0 ? 850 : 870;
+        viscosity[index] = batch % 2 == 0 ? 15e-6 : 25e-6;
+    }
+    batch_hydraulic_solver_t solver(pipe, batch_hydraulic_solver_t::get_batches(pipe, density, viscosity));
+
+    for (auto _ : state) {
+        double flow = solver.solve_PP(6e6, 1e6);
+        double pressure_out = solver.solve_PQ(6e6, flow);
+        benchmark::DoNotOptimize(pressure_out);
+    }
+}
+BENCHMARK(bench_batch_hydraulic_solver)->Apply(grid_sizes);
+
+/// @brief Шаг квазистационарной задачи: партии и гидравлический расчет
+/// @tparam Solver Солвер партий
+/// @tparam IncrementalPressure Инкрементальный расчет давления (set_incremental_pressure)
+template <typename Solver, bool IncrementalPressure>
+static void bench_quasistatic_task_step(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+
+    isothermal_quasistatic_task_t<Solver> task(pipe);
+    task.set_incremental_pressure(IncrementalPressure);
+    task.solve(boundaries);
+    double v = boundaries.volumetric_flow / pipe.wall.getArea();
+    double dt = 0.5 * task.get_time_step_assuming_max_speed(v);
+
+    size_t step = 0;
+    for (auto _ : state) {
+        // Партии чередуются: фронты движутся по трубе
+        bool heavy_batch = (step++ / 200) % 2 == 1;
+        boundaries.density = heavy_batch ? 870 : 850;
+        boundaries.viscosity = heavy_batch ? 25e-6 : 15e-6;
+        task.step(dt, boundaries);
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK(bench_quasistatic_task_step<quickest_ultimate_fv_solver, false>)->Apply(grid_sizes);
+BENCHMARK(bench_quasistatic_task_step<quickest_ultimate_fv_solver, true>)->Apply(grid_sizes);
+BENCHMARK(bench_quasistatic_task_step<advection_moc_solver, false>)->Apply(grid_sizes);
+BENCHMARK(bench_quasistatic_task_step<advection_moc_solver, true>)->Apply(grid_sizes);
+
+/// @brief Конвейерный шаг квазистационарной задачи (set_pipelined): давление шага n
+/// рассчитывается одновременно с партиями шага n + 1
+template <typename Solver>
+static void bench_quasistatic_task_pipelined_step(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+
+    isothermal_quasistatic_task_t<Solver> task(pipe);
+    task.set_pipelined(true);
+    task.solve(boundaries);
+    double v = boundaries.volumetric_flow / pipe.wall.getArea();
+    double dt = 0.5 * task.get_time_step_assuming_max_speed(v);
+
+    size_t step = 0;
+    for (auto _ : state) {
+        bool heavy_batch = (step++ / 200) % 2 == 1;
+        boundaries.density = heavy_batch ? 870 : 850;
+        boundaries.viscosity = heavy_batch ? 25e-6 : 15e-6;
+        task.step(dt, boundaries);
+    }
+    task.flush_pipeline();
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK(bench_quasistatic_task_pipelined_step<quickest_ultimate_fv_solver>)->Apply(grid_sizes)->UseRealTime();
+BENCHMARK(bench_quasistatic_task_pipelined_step<advection_moc_solver>)->Apply(grid_sizes)->UseRealTime();
+
+/// @brief Шаг квазистационарной задачи в установившемся режиме с пропуском шагов
+/// (set_steady_state_skipping): труба заполнена одной партией, краевые условия не меняются
+static void bench_quasistatic_task_steady_step(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> task(pipe);
+    task.set_steady_state_skipping(true);
+    task.solve(boundaries);
+    double v = boundaries.volumetric_flow / pipe.wall.getArea();
+    double dt = 0.5 * task.get_time_step_assuming_max_speed(v);
+
+    for (auto _ : state) {
+        task.step(dt, boundaries);
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+    state.counters["skipped"] = static_cast<double>(task.get_step_stats().skipped_steps) /
+        static_cast<double>(state.iterations());
+}
+BENCHMARK(bench_quasistatic_task_steady_step)->Apply(grid_sizes);
+
+/// @brief Ответвление 100 сценариев от текущего состояния квазистационарной задачи
+/// Слои и труба разделяются с исходной задачей, поэтому время не зависит от размера сетки
+static void bench_quasistatic_task_fork(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> task(pipe);
+    task.solve(boundaries);
+
+    const size_t fork_count = 100;
+    for (auto _ : state) {
+        vector<isothermal_quasistatic_task_t<quickest_ultimate_fv_solver>> scenarios;
+        scenarios.reserve(fork_count);
+        for (size_t index = 0; index < fork_count; ++index) {
+            scenarios.push_back(task.fork());
+        }
+        benchmark::DoNotOptimize(scenarios.data());
+    }
+    state.SetItemsProcessed(state.iterations() * fork_count);
+}
+BENCHMARK(bench_quasistatic_task_fork)->Apply(grid_sizes);
+
+/// @brief Таблицы вязкости профиля из чередующихся партий (ФФТ и Филонов-Рейнольдс)
+inline vector<array<double, 3>> create_bench_viscosity_tables(size_t point_count)
+{
+    array<double, 3> vft_table{ 50e-6, 20e-6, 8e-6 };
+    array<double, 3> filonov_reynolds_table{ 40e-6, 20e-6, 7.071067811865475e-6 };
+    vector<array<double, 3>> tables(point_count);
+    for (size_t index = 0; index < point_count; ++index) {
+        tables[index] = (index / 50) % 2 == 0 ? vft_table : filonov_reynolds_table;
+    }
+    return tables;
+}
+
+/// @brief Профиль вязкости поточечно: viscosity_table_model_t::calc с ветвлением по модели
+static void bench_viscosity_pointwise(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    vector<array<double, 3>> tables = create_bench_viscosity_tables(point_count);
+    vector<array<double, 3>> approximations(point_count);
+    std::transform(tables.begin(), tables.end(), approximations.begin(), &viscosity_table_model_t::reconstruct);
+    vector<double> temperature(point_count, KELVIN_OFFSET + 15);
+    vector<double> viscosity(point_count);
+
+    for (auto _ : state) {
+        for (size_t index = 0; index < point_count; ++index) {
+            viscosity[index] = viscosity_table_model_t::calc(approximations[index], temperature[index]);
+        }
+        benchmark::DoNotOptimize(viscosity.data());
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK(bench_viscosity_pointwise)->Apply(grid_sizes);
+
+/// @brief Профиль вязкости через viscosity_table_profile_t (без ветвлений, векторизуется)
+static void bench_viscosity_profile(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    viscosity_table_profile_t profile =
+        viscosity_table_profile_t::reconstruct(create_bench_viscosity_tables(point_count));
+    vector<double> temperature(point_count, KELVIN_OFFSET + 15);
+    vector<double> viscosity(point_count);
+
+    for (auto _ : state) {
+        profile.calc(temperature, &viscosity);
+        benchmark::DoNotOptimize(viscosity.data());
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK(bench_viscosity_profile)->Apply(grid_sizes);
@@ -0,0 +1,40 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+#include <benchmark/benchmark.h>
+
+#include <fixed/fixed.h>
+#include <pde_solvers/pde_solvers.h>
+#include <pde_solvers/timeseries.h>
+
+using namespace pde_solvers;
+
+/// @brief Размеры сеток (количество точек) для бенчмарков: 10^2 .. 10^6
+inline void grid_sizes(benchmark::internal::Benchmark* benchmark)
+{
+    for (int64_t point_count = 100; point_count <= 1000000; point_count *= 10) {
+        benchmark->Arg(point_count);
+    }
+    benchmark->Unit(benchmark::kMicrosecond);
+}
+
+/// @brief Труба 100 км, 700 мм с заданным количеством точек сетки
+/// Длина трубы не зависит от сетки, чтобы гидравлика была одинаковой для всех размеров
+inline pipe_properties_t create_bench_pipe(size_t point_count)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 100e3;
+    simple_pipe.diameter = 0.7;
+    simple_pipe.dx = simple_pipe.length / (point_count - 1);
+    return pipe_properties_t::build_simple_pipe(simple_pipe);
+}
+
+#include "bench_solvers.h"
+#include "bench_hydraulics.h"
+#include "bench_timeseries.h"
+#include "bench_profile.h"
+
+BENCHMARK_MAIN();
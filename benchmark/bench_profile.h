@@ -0,0 +1,45 @@
+﻿#pragma once
+
+/// @brief Текст файла профиля (формат km;m) из point_count неравномерно расставленных точек
+inline string create_bench_profile_text(size_t point_count)
+{
+    std::ostringstream text;
+    text << std::setprecision(12);
+    text << "km;m\n";
+    double coordinate = 0;
+    for (size_t index = 0; index < point_count; ++index) {
+        text << coordinate / 1000 << ";" << 100 + 50 * std::sin(1e-3 * coordinate) << "\n";
+        coordinate += 50 + 100 * static_cast<double>(index % 3);
+    }
+    return text.str();
+}
+
+/// @brief Разбор текста профиля (координаты и высотки)
+static void bench_parse_coordinates_and_heights(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    string text = create_bench_profile_text(point_count);
+
+    for (auto _ : state) {
+        vector<vector<double>> coord_heights = parse_coordinates_and_heights(text.data(), text.size());
+        benchmark::DoNotOptimize(coord_heights.data());
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(bench_parse_coordinates_and_heights)->Apply(grid_sizes);
+
+/// @brief Построение профиля с постоянным шагом 100 м по исходному профилю
+static void bench_uniform_profile(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    string text = create_bench_profile_text(point_count);
+    vector<vector<double>> coord_heights = parse_coordinates_and_heights(text.data(), text.size());
+
+    for (auto _ : state) {
+        PipeProfile profile = pipe_profile_uniform::get_uniform_profile(coord_heights, 100);
+        benchmark::DoNotOptimize(profile.heights.data());
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK(bench_uniform_profile)->Apply(grid_sizes);
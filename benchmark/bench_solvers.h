@@ -0,0 +1,131 @@
+﻿#pragma once
+
+/// @brief Шаг солвера МКО по плотности (Cr = 0.5)
+template <typename Solver>
+static void bench_fv_solver_step(benchmark::State& state)
+{
+    typedef composite_layer_t<typename Solver::var_layer_data, typename Solver::specific_layer> layer_t;
+
+    size_t point_count = static_cast<size_t>(state.range(0));
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+    vector<double> Q(point_count, 0.5);
+    PipeQAdvection advection_model(pipe, Q);
+    const auto& x = advection_model.get_grid();
+    double dt = 0.5 * (x[1] - x[0]) / advection_model.getEquationsCoeffs(0, 0);
+
+    ring_buffer_t<layer_t> buffer(2, point_count);
+    auto& rho_initial = buffer.previous().vars.cell_double[0];
+    std::fill(rho_initial.begin(), rho_initial.end(), 850);
+
+    for (auto _ : state) {
+        Solver solver(advection_model, buffer);
+        solver.step(dt, 860, 850);
+        buffer.advance(+1);
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK_TEMPLATE(bench_fv_solver_step, upstream_fv_solver)->Apply(grid_sizes);
+BENCHMARK_TEMPLATE(bench_fv_solver_step, quick_fv_solver)->Apply(grid_sizes);
+BENCHMARK_TEMPLATE(bench_fv_solver_step, quickest_fv_solver)->Apply(grid_sizes);
+BENCHMARK_TEMPLATE(bench_fv_solver_step, quickest_ultimate_fv_solver)->Apply(grid_sizes);
+BENCHMARK_TEMPLATE(bench_fv_solver_step,
+    quickest_ultimate_fv_solver_t<scalar_fv_solver_traits<float>>)->Apply(grid_sizes);
+
+/// @brief Шаг солвера МКО на слоях фиксированного размера (короткая труба, 32 точки)
+template <typename Solver>
+static void bench_fixed_fv_solver_step(benchmark::State& state)
+{
+    constexpr size_t point_count = 32;
+    typedef composite_layer_t<typename Solver::var_layer_data, typename Solver::specific_layer> layer_t;
+
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+    vector<double> Q(point_count, 0.5);
+    PipeQAdvection advection_model(pipe, Q);
+    const auto& x = advection_model.get_grid();
+    double dt = 0.5 * (x[1] - x[0]) / advection_model.getEquationsCoeffs(0, 0);
+
+    fixed_ring_buffer_t<layer_t, 2> buffer(point_count);
+    buffer.previous().vars.cell_double[0].fill(850);
+
+    for (auto _ : state) {
+        Solver solver(advection_model, buffer);
+        solver.step(dt, 860, 850);
+        buffer.advance(+1);
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK_TEMPLATE(bench_fixed_fv_solver_step, fixed_quickest_ultimate_fv_solver<32>);
+
+/// @brief Шаг солвера партий методом характеристик с Cr = 1 (advection_moc_solver)
+template <typename Scalar>
+static void bench_advection_moc_step(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+
+    ring_buffer_t<vector<Scalar>> buffer(2, point_count);
+    std::fill(buffer.previous().begin(), buffer.previous().end(), static_cast<Scalar>(850));
+
+    for (auto _ : state) {
+        advection_moc_solver_t<Scalar> solver(pipe, 0.5, buffer.previous(), buffer.current());
+        solver.step(solver.prepare_step(), 860, 850);
+        buffer.advance(+1);
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK_TEMPLATE(bench_advection_moc_step, double)->Apply(grid_sizes);
+BENCHMARK_TEMPLATE(bench_advection_moc_step, float)->Apply(grid_sizes);
+
+/// @brief Шаг метода характеристик для уравнения адвекции (moc_solver<1>)
+static void bench_moc_solver_1_step(benchmark::State& state)
+{
+    typedef composite_layer_t<profile_collection_t<1>, moc_solver<1>::specific_layer> layer_t;
+
+    size_t point_count = static_cast<size_t>(state.range(0));
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+    vector<double> Q(point_count, 0.5);
+    PipeQAdvection advection_model(pipe, Q);
+
+    ring_buffer_t<layer_t> buffer(2, point_count);
+    auto& rho_initial = buffer.previous().vars.point_double[0];
+    std::fill(rho_initial.begin(), rho_initial.end(), 850);
+
+    for (auto _ : state) {
+        moc_solver<1> solver(advection_model, buffer.previous(), buffer.current());
+        double dt = solver.prepare_step();
+        solver.step_optional_boundaries(dt, 860, 850);
+        buffer.advance(+1);
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK(bench_moc_solver_1_step)->Apply(grid_sizes);
+
+/// @brief Шаг метода характеристик для гидроудара (moc_solver<2>, давление и массовый расход)
+static void bench_moc_solver_2_step(benchmark::State& state)
+{
+    typedef composite_layer_t<profile_collection_t<2>, moc_solver<2>::specific_layer> layer_t;
+
+    size_t point_count = static_cast<size_t>(state.range(0));
+    pipe_properties_t pipe = create_bench_pipe(point_count);
+    oil_parameters_t oil;
+    PipeModelPGConstArea pipe_model(pipe, oil);
+
+    ring_buffer_t<layer_t> buffer(2, point_count);
+    double G = 400;
+    double Pout = 5e5;
+    profile_wrapper<double, 2> start_layer(get_profiles_pointers(buffer.current().vars.point_double));
+    solve_euler_corrector<2>(pipe_model, -1, { Pout, G }, &start_layer);
+
+    auto left_boundary = pipe_model.const_mass_flow_equation(G + 50);
+    auto right_boundary = pipe_model.const_pressure_equation(Pout);
+
+    for (auto _ : state) {
+        buffer.advance(+1);
+        moc_layer_wrapper<2> moc_current(buffer.current().vars, std::get<0>(buffer.current().specific));
+        moc_layer_wrapper<2> moc_previous(buffer.previous().vars, std::get<0>(buffer.previous().specific));
+        moc_solver<2> solver(pipe_model, moc_previous, moc_current);
+        solver.step(left_boundary, right_boundary);
+    }
+    state.SetItemsProcessed(state.iterations() * point_count);
+}
+BENCHMARK(bench_moc_solver_2_step)->Apply(grid_sizes);
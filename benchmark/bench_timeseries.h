@@ -0,0 +1,70 @@
+﻿#pragma once
+
+/// @brief Два временных ряда по point_count точек с шагом 60 с
+inline vector<pair<vector<time_t>, vector<double>>> create_bench_timeseries(size_t point_count)
+{
+    vector<time_t> times(point_count);
+    vector<double> pressure(point_count);
+    vector<double> density(point_count);
+    for (size_t index = 0; index < point_count; ++index) {
+        times[index] = static_cast<time_t>(60 * index);
+        pressure[index] = 5e6 + 1e3 * static_cast<double>(index % 97);
+        density[index] = 850 + 0.1 * static_cast<double>(index % 13);
+    }
+    return { { times, pressure }, { times, density } };
+}
+
+/// @brief Интерполяция рядов во всех моментах между точками (vector_timeseries_t::operator())
+static void bench_timeseries_interpolation(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    auto data = create_bench_timeseries(point_count);
+
+    for (auto _ : state) {
+        // operator() не позволяет вернуться назад во времени - ряды создаются заново
+        state.PauseTiming();
+        vector_timeseries_t timeseries(data);
+        state.ResumeTiming();
+        for (size_t index = 0; index + 1 < point_count; ++index) {
+            vector<double> values = timeseries(static_cast<time_t>(60 * index + 17));
+            benchmark::DoNotOptimize(values.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (point_count - 1));
+}
+BENCHMARK(bench_timeseries_interpolation)->Apply(grid_sizes);
+
+/// @brief Интерполяция рядов во всех моментах между точками курсором (без выделения памяти)
+static void bench_timeseries_cursor(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    vector_timeseries_t timeseries(create_bench_timeseries(point_count));
+    vector<double> values(timeseries.get_series_count());
+
+    for (auto _ : state) {
+        vector_timeseries_cursor_t cursor(timeseries);
+        for (size_t index = 0; index + 1 < point_count; ++index) {
+            cursor.interpolate(static_cast<time_t>(60 * index + 17), values.data());
+            benchmark::DoNotOptimize(values.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (point_count - 1));
+}
+BENCHMARK(bench_timeseries_cursor)->Apply(grid_sizes);
+
+/// @brief Построение матрицы значений на равномерной сетке (шаг 60 с) и чтение всех строк
+static void bench_timeseries_matrix(benchmark::State& state)
+{
+    size_t point_count = static_cast<size_t>(state.range(0));
+    vector_timeseries_t timeseries(create_bench_timeseries(point_count));
+
+    for (auto _ : state) {
+        timeseries_matrix_t matrix(timeseries, 17, 60, point_count - 1);
+        for (size_t index = 0; index < matrix.get_row_count(); ++index) {
+            const double* values = matrix.row(index);
+            benchmark::DoNotOptimize(values);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (point_count - 1));
+}
+BENCHMARK(bench_timeseries_matrix)->Apply(grid_sizes);
@@ -0,0 +1,75 @@
+import argparse
+import json
+import sys
+
+# Сравнение результатов двух запусков pde_solvers_bench в формате JSON
+# (--benchmark_out=<файл> --benchmark_out_format=json).
+# Печатает отношение времени нового запуска к базовому для каждого бенчмарка
+# и завершается с кодом 1, если хотя бы один бенчмарк замедлился больше порога
+
+TIME_UNITS = {'ns': 1e-9, 'us': 1e-6, 'ms': 1e-3, 's': 1.0}
+
+
+def read_benchmarks(filename, field):
+    """Возвращает словарь {имя бенчмарка: время в секундах}.
+    При повторениях (--benchmark_repetitions) берется медиана, если она записана"""
+    with open(filename, encoding='utf-8') as file:
+        data = json.load(file)
+
+    result = {}
+    medians = {}
+    for benchmark in data['benchmarks']:
+        if benchmark.get('error_occurred'):
+            continue
+        seconds = benchmark[field] * TIME_UNITS[benchmark.get('time_unit', 'ns')]
+        name = benchmark.get('run_name', benchmark['name'])
+        aggregate = benchmark.get('aggregate_name')
+        if aggregate == 'median':
+            medians[name] = seconds
+        elif aggregate is None and name not in result:
+            result[name] = seconds
+    result.update(medians)
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Сравнение результатов pde_solvers_bench')
+    parser.add_argument('baseline', help='JSON базового запуска')
+    parser.add_argument('contender', help='JSON нового запуска')
+    parser.add_argument('--threshold', type=float, default=0.1,
+                        help='допустимое относительное замедление (по умолчанию 0.1 = 10%%)')
+    parser.add_argument('--field', choices=['real_time', 'cpu_time'], default='cpu_time',
+                        help='сравниваемое время')
+    args = parser.parse_args()
+
+    baseline = read_benchmarks(args.baseline, args.field)
+    contender = read_benchmarks(args.contender, args.field)
+
+    names = [name for name in contender if name in baseline]
+    width = max([len(name) for name in names] + [len('benchmark')])
+    print('%-*s %14s %14s %9s' % (width, 'benchmark', 'baseline, s', 'contender, s', 'ratio'))
+
+    regressions = []
+    for name in names:
+        ratio = contender[name] / baseline[name] if baseline[name] > 0 else float('inf')
+        mark = ''
+        if ratio > 1 + args.threshold:
+            mark = '  REGRESSION'
+            regressions.append(name)
+        elif ratio < 1 - args.threshold:
+            mark = '  improvement'
+        print('%-*s %14.6g %14.6g %9.3f%s' % (width, name, baseline[name], contender[name], ratio, mark))
+
+    for name in sorted(set(baseline) - set(contender)):
+        print('%-*s missing in contender' % (width, name))
+    for name in sorted(set(contender) - set(baseline)):
+        print('%-*s new' % (width, name))
+
+    if regressions:
+        print('%d benchmark(s) slower by more than %.0f%%' % (len(regressions), 100 * args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
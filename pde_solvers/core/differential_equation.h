@@ -29,6 +29,24 @@ public:
     /// @return Значение правой части ОДУ
     virtual right_party_type ode_right_party(
         size_t grid_index, const var_type& point_vector) const = 0;
+
+    /// @brief Признак того, что правая часть зависит только от индекса сетки, но не от решения
+    /// Тогда решение - накопленная сумма приращений, и его можно рассчитать параллельно
+    /// (см. solve_euler_state_independent)
+    virtual bool is_state_independent() const {
+        return false;
+    }
+
+    /// @brief Правые части в точках [begin, end) для ОДУ, не зависящих от решения
+    /// Наследники переопределяют для расчета одним циклом без виртуального вызова на точку
+    /// @param result Буфер для end - begin значений
+    virtual void ode_right_party_range(size_t begin, size_t end, right_party_type* result) const
+    {
+        var_type point_vector{};
+        for (size_t grid_index = begin; grid_index < end; ++grid_index) {
+            result[grid_index - begin] = ode_right_party(grid_index, point_vector);
+        }
+    }
 };
 
 
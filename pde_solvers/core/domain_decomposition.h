@@ -0,0 +1,107 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <vector>
+#include "thread_pool.h"
+
+namespace pde_solvers {
+;
+
+/// @brief Разбиение сетки одной трубы на непрерывные подобласти для параллельного шага солвера
+/// Каждая фаза шага (собственные числа, потоки через границы ячеек, новый слой) выполняется
+/// по подобластям параллельно, возврат из for_each_subdomain - барьер между фазами.
+/// Подобласти не копируются: соседние точки за границей подобласти (halo, 1 точка для метода
+/// характеристик и 2 ячейки для QUICK) читаются непосредственно из слоев, которые в данной фазе
+/// только читаются. Каждый элемент рассчитывается тем же кодом, что и при последовательном расчете,
+/// поэтому результат побитово совпадает с последовательным
+class domain_decomposition_t {
+    /// @brief Пул потоков
+    thread_pool_t& pool;
+    /// @brief Границы подобластей: подобласть k - точки [bounds[k], bounds[k + 1])
+    std::vector<size_t> bounds;
+public:
+    /// @brief Разбивает сетку на подобласти примерно равного размера
+    /// @param pool Пул потоков
+    /// @param point_count Количество точек сетки
+    /// @param min_subdomain_size Минимальный размер подобласти (мелкие подобласти не окупают синхронизацию)
+    domain_decomposition_t(thread_pool_t& pool, size_t point_count, size_t min_subdomain_size = 1000)
+        : pool(pool)
+    {
+        size_t subdomain_count = (std::min)(pool.get_thread_count(),
+            (std::max<size_t>)(1, point_count / (std::max<size_t>)(1, min_subdomain_size)));
+        for (size_t subdomain = 0; subdomain <= subdomain_count; ++subdomain) {
+            bounds.push_back(point_count * subdomain / subdomain_count);
+        }
+    }
+
+    /// @brief Количество подобластей
+    size_t get_subdomain_count() const {
+        return bounds.size() - 1;
+    }
+
+    /// @brief Границы подобласти [begin, end)
+    std::pair<size_t, size_t> get_subdomain(size_t subdomain) const {
+        return { bounds[subdomain], bounds[subdomain + 1] };
+    }
+
+    /// @brief Вызывает function(subdomain_begin, subdomain_end) параллельно для пересечений
+    /// подобластей с диапазоном [begin, end). Возвращает управление после обработки всех подобластей
+    void for_each_subdomain(size_t begin, size_t end, const std::function<void(size_t, size_t)>& function) const
+    {
+        pool.parallel_for(get_subdomain_count(), [&](size_t subdomain) {
+            size_t subdomain_begin = (std::max)(begin, bounds[subdomain]);
+            size_t subdomain_end = subdomain + 1 == get_subdomain_count()
+                ? end // последняя подобласть забирает остаток (диапазон ячеек и т.п.)
+                : (std::min)(end, bounds[subdomain + 1]);
+            if (subdomain_begin < subdomain_end) {
+                function(subdomain_begin, subdomain_end);
+            }
+        });
+    }
+};
+
+/// @brief Обработка диапазона [begin, end) по подобластям разбиения или целиком, если разбиение не задано
+/// При последовательном расчете function вызывается напрямую, без обертки std::function
+/// (для коротких сеток ее создание на каждом шаге сопоставимо с самим расчетом)
+/// @param decomposition Разбиение сетки (nullptr - последовательный расчет)
+/// @param function Обработка поддиапазона function(subdomain_begin, subdomain_end)
+template <typename Function>
+inline void for_each_subdomain(const domain_decomposition_t* decomposition, size_t begin, size_t end,
+    const Function& function)
+{
+    if (decomposition == nullptr) {
+        if (begin < end) {
+            function(begin, end);
+        }
+    }
+    else {
+        decomposition->for_each_subdomain(begin, end, function);
+    }
+}
+
+/// @brief Максимум величин, рассчитанных по подобластям разбиения (см. for_each_subdomain)
+/// Максимум не зависит от порядка обработки, поэтому совпадает с последовательным расчетом
+/// @param function Расчет величины на поддиапазоне function(subdomain_begin, subdomain_end)
+template <typename Function>
+inline double max_over_subdomains(const domain_decomposition_t* decomposition, size_t begin, size_t end,
+    const Function& function)
+{
+    if (decomposition == nullptr) {
+        return begin < end
+            ? function(begin, end)
+            : -std::numeric_limits<double>::infinity();
+    }
+    double result = -std::numeric_limits<double>::infinity();
+    std::mutex mutex;
+    for_each_subdomain(decomposition, begin, end, [&](size_t subdomain_begin, size_t subdomain_end) {
+        double maximum = function(subdomain_begin, subdomain_end);
+        std::lock_guard<std::mutex> lock(mutex);
+        result = (std::max)(result, maximum);
+    });
+    return result;
+}
+
+}
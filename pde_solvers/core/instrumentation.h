@@ -0,0 +1,279 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <ostream>
+
+namespace pde_solvers {
+;
+
+/// @brief Статистика вызовов фазы расчета (время в секундах)
+struct phase_stats_t {
+    /// @brief Количество вызовов
+    uint64_t call_count{ 0 };
+    /// @brief Суммарное время
+    double total_time{ 0 };
+    /// @brief Максимальное время одного вызова
+    double max_time{ 0 };
+    /// @brief Среднее время одного вызова
+    double mean_time() const {
+        return call_count == 0 ? 0.0 : total_time / call_count;
+    }
+};
+
+/// @brief Снимок статистики инструментирования горячих участков расчета
+/// Вложенные фазы учитываются в обеих (step_inner включает в себя prepare_step)
+struct instrumentation_stats_t {
+    /// @brief Расчет собственных чисел и шага по Куранту в moc_solver
+    phase_stats_t prepare_step;
+    /// @brief Расчет внутренних точек в moc_solver
+    phase_stats_t step_inner;
+    /// @brief Шаг движения партий в isothermal_quasistatic_task_t
+    phase_stats_t make_rheology_step;
+    /// @brief Гидравлический расчет в isothermal_quasistatic_task_t
+    phase_stats_t calc_pressure_layer;
+    /// @brief Стационарный расчет по граничным давлениям solve_pipe_PP
+    phase_stats_t solve_pipe_PP;
+    /// @brief Вычисления невязки в методе Ньютона solve_pipe_PP (каждое - один проход Эйлера)
+    uint64_t newton_iterations{ 0 };
+    /// @brief Вызовы коэффициентов и правых частей ДУЧП/ОДУ солверами (getEquationsCoeffs,
+    /// getSourceTerm, GetLeftEigens, ode_right_party)
+    uint64_t pde_callbacks{ 0 };
+    /// @brief Выделения динамической памяти (см. PDE_SOLVERS_COUNT_ALLOCATIONS)
+    uint64_t allocations{ 0 };
+};
+
+/// @brief Потокобезопасный накопитель статистики одной фазы
+class phase_counter_t {
+    std::atomic<uint64_t> call_count{ 0 };
+    std::atomic<uint64_t> total_ns{ 0 };
+    std::atomic<uint64_t> max_ns{ 0 };
+public:
+    /// @brief Учитывает один вызов длительностью duration_ns наносекунд
+    void add(uint64_t duration_ns) {
+        call_count.fetch_add(1, std::memory_order_relaxed);
+        total_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+        uint64_t max_value = max_ns.load(std::memory_order_relaxed);
+        while (duration_ns > max_value &&
+            !max_ns.compare_exchange_weak(max_value, duration_ns, std::memory_order_relaxed))
+        {
+        }
+    }
+    /// @brief Текущая статистика фазы
+    phase_stats_t get() const {
+        phase_stats_t result;
+        result.call_count = call_count.load(std::memory_order_relaxed);
+        result.total_time = 1e-9 * total_ns.load(std::memory_order_relaxed);
+        result.max_time = 1e-9 * max_ns.load(std::memory_order_relaxed);
+        return result;
+    }
+    /// @brief Обнуление статистики
+    void reset() {
+        call_count = 0;
+        total_ns = 0;
+        max_ns = 0;
+    }
+};
+
+/// @brief Накопители статистики инструментирования (один экземпляр на процесс)
+/// Заполняются только при сборке с PDE_SOLVERS_INSTRUMENTATION, иначе точки замера
+/// (PDE_SOLVERS_TIME_PHASE, PDE_SOLVERS_COUNT) не компилируются и статистика остается нулевой
+class instrumentation_t {
+public:
+    phase_counter_t prepare_step;
+    phase_counter_t step_inner;
+    phase_counter_t make_rheology_step;
+    phase_counter_t calc_pressure_layer;
+    phase_counter_t solve_pipe_PP;
+    std::atomic<uint64_t> newton_iterations{ 0 };
+    std::atomic<uint64_t> pde_callbacks{ 0 };
+    std::atomic<uint64_t> allocations{ 0 };
+
+#ifdef PDE_SOLVERS_INSTRUMENTATION
+    /// @brief Признак того, что точки замера скомпилированы
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+public:
+    /// @brief Единственный экземпляр накопителей
+    static instrumentation_t& instance() {
+        static instrumentation_t stats;
+        return stats;
+    }
+    /// @brief Снимок текущей статистики
+    instrumentation_stats_t get_stats() const {
+        instrumentation_stats_t result;
+        result.prepare_step = prepare_step.get();
+        result.step_inner = step_inner.get();
+        result.make_rheology_step = make_rheology_step.get();
+        result.calc_pressure_layer = calc_pressure_layer.get();
+        result.solve_pipe_PP = solve_pipe_PP.get();
+        result.newton_iterations = newton_iterations.load(std::memory_order_relaxed);
+        result.pde_callbacks = pde_callbacks.load(std::memory_order_relaxed);
+        result.allocations = allocations.load(std::memory_order_relaxed);
+        return result;
+    }
+    /// @brief Обнуление всей статистики
+    void reset() {
+        prepare_step.reset();
+        step_inner.reset();
+        make_rheology_step.reset();
+        calc_pressure_layer.reset();
+        solve_pipe_PP.reset();
+        newton_iterations = 0;
+        pde_callbacks = 0;
+        allocations = 0;
+    }
+};
+
+/// @brief Снимок статистики инструментирования
+inline instrumentation_stats_t get_instrumentation_stats() {
+    return instrumentation_t::instance().get_stats();
+}
+
+/// @brief Обнуление статистики инструментирования
+inline void reset_instrumentation() {
+    instrumentation_t::instance().reset();
+}
+
+/// @brief Замер длительности фазы от создания до разрушения объекта
+class scoped_phase_timer_t {
+    phase_counter_t& counter;
+    std::chrono::steady_clock::time_point start;
+public:
+    scoped_phase_timer_t(phase_counter_t& counter)
+        : counter(counter)
+        , start(std::chrono::steady_clock::now())
+    {
+    }
+    ~scoped_phase_timer_t() {
+        auto duration = std::chrono::steady_clock::now() - start;
+        counter.add(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+    }
+    scoped_phase_timer_t(const scoped_phase_timer_t&) = delete;
+    scoped_phase_timer_t& operator=(const scoped_phase_timer_t&) = delete;
+};
+
+/// @brief Вывод статистики таблицей: фаза, вызовы, суммарное/среднее/максимальное время в мкс
+inline void print_instrumentation_stats(std::ostream& output, const instrumentation_stats_t& stats)
+{
+    auto print_phase = [&](const char* name, const phase_stats_t& phase) {
+        output << std::left << std::setw(20) << name << std::right
+            << std::setw(12) << phase.call_count
+            << std::setw(14) << 1e6 * phase.total_time
+            << std::setw(12) << 1e6 * phase.mean_time()
+            << std::setw(12) << 1e6 * phase.max_time << "\n";
+    };
+    std::ios_base::fmtflags flags = output.flags();
+    std::streamsize precision = output.precision();
+    output << std::fixed << std::setprecision(1);
+    output << std::left << std::setw(20) << "phase" << std::right
+        << std::setw(12) << "calls" << std::setw(14) << "total, us"
+        << std::setw(12) << "mean, us" << std::setw(12) << "max, us" << "\n";
+    print_phase("prepare_step", stats.prepare_step);
+    print_phase("step_inner", stats.step_inner);
+    print_phase("make_rheology_step", stats.make_rheology_step);
+    print_phase("calc_pressure_layer", stats.calc_pressure_layer);
+    print_phase("solve_pipe_PP", stats.solve_pipe_PP);
+    output << "newton_iterations " << stats.newton_iterations
+        << ", pde_callbacks " << stats.pde_callbacks
+        << ", allocations " << stats.allocations << "\n";
+    output.flags(flags);
+    output.precision(precision);
+}
+
+/// @brief Периодический вывод статистики из цикла расчета
+/// poll() вызывается на каждой итерации цикла; по истечении периода выводит статистику
+/// за прошедший период и обнуляет ее, так что максимумы относятся к последнему периоду
+class periodic_instrumentation_dump_t {
+    std::ostream& output;
+    std::chrono::steady_clock::duration period;
+    std::chrono::steady_clock::time_point last_dump;
+public:
+    /// @param output Поток вывода
+    /// @param period_seconds Период вывода, с
+    periodic_instrumentation_dump_t(std::ostream& output, double period_seconds)
+        : output(output)
+        , period(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(period_seconds)))
+        , last_dump(std::chrono::steady_clock::now())
+    {
+    }
+    /// @brief Выводит статистику, если с прошлого вывода прошел период
+    /// @return Признак того, что статистика выведена
+    bool poll() {
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_dump < period) {
+            return false;
+        }
+        dump();
+        last_dump = now;
+        return true;
+    }
+    /// @brief Выводит статистику немедленно и обнуляет ее
+    void dump() {
+        instrumentation_t& instrumentation = instrumentation_t::instance();
+        print_instrumentation_stats(output, instrumentation.get_stats());
+        instrumentation.reset();
+    }
+};
+
+}
+
+#define PDE_SOLVERS_CONCAT_IMPL(a, b) a##b
+#define PDE_SOLVERS_CONCAT(a, b) PDE_SOLVERS_CONCAT_IMPL(a, b)
+
+#ifdef PDE_SOLVERS_INSTRUMENTATION
+/// @brief Замер длительности фазы до конца текущей области видимости
+#define PDE_SOLVERS_TIME_PHASE(phase) \
+    pde_solvers::scoped_phase_timer_t PDE_SOLVERS_CONCAT(pde_solvers_phase_timer_, __LINE__)( \
+        pde_solvers::instrumentation_t::instance().phase)
+/// @brief Увеличение счетчика на value
+#define PDE_SOLVERS_COUNT(counter, value) \
+    pde_solvers::instrumentation_t::instance().counter.fetch_add( \
+        static_cast<uint64_t>(value), std::memory_order_relaxed)
+#else
+#define PDE_SOLVERS_TIME_PHASE(phase)
+#define PDE_SOLVERS_COUNT(counter, value)
+#endif
+
+#if defined(PDE_SOLVERS_INSTRUMENTATION) && defined(PDE_SOLVERS_COUNT_ALLOCATIONS)
+// Подсчет выделений памяти заменой глобальных operator new/delete.
+// PDE_SOLVERS_COUNT_ALLOCATIONS определяется ровно в одной единице трансляции программы
+// перед включением pde_solvers.h
+void* operator new(std::size_t size)
+{
+    PDE_SOLVERS_COUNT(allocations, 1);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+#endif
@@ -31,6 +31,24 @@ inline array<vector<DataType>*, Dimension> get_profiles_pointers(array<vector<Da
     return create_array<Dimension>([&](int dimension) { return &profiles[dimension]; });
 }
 
+/// @brief Объем памяти, выделенной под профиль, байт
+template <typename T>
+inline size_t get_allocated_size(const vector<T>& values)
+{
+    return values.capacity() * sizeof(T);
+}
+
+/// @brief Объем памяти, выделенной под набор профилей, байт
+template <typename T, size_t Dimension>
+inline size_t get_allocated_size(const array<vector<T>, Dimension>& profiles)
+{
+    size_t result = 0;
+    for (const vector<T>& profile : profiles) {
+        result += get_allocated_size(profile);
+    }
+    return result;
+}
+
 
 /// @brief Собирает из составной профиль
 /// Из скалярных профилей собрать векторный профиль: double -> array<double, Dim>
@@ -117,7 +135,7 @@ public:
     }
 
 
-    double& operator()(size_t dimension, size_t profile_index)
+    T& operator()(size_t dimension, size_t profile_index)
     {
         return profiles[dimension]->at(profile_index);
     }
@@ -170,32 +188,39 @@ inline profile_wrapper<double, 1>::profile_wrapper(array<vector<double>*, 1>* pr
 /// Скалярный профиль на точках
 /// Скалярный профиль на ячейках
 /// Векторный профиль (заданной размерности)
+/// Скалярные профили хранятся в типе Scalar (например, float для расчета партий)
 template <size_t PointScalar, size_t CellScalar = 0,
     size_t PointVector = 0, size_t PointVectorDimension = 0,
-    size_t CellVector = 0, size_t CellVectorDimension = 0>
+    size_t CellVector = 0, size_t CellVectorDimension = 0,
+    typename Scalar = double>
 struct profile_collection_t
 {
     typedef typename fixed_system_types<PointVectorDimension>::var_type point_vector_type;
     typedef typename fixed_system_types<CellVectorDimension>::var_type cell_vector_type;
-
+    /// @brief Тип значений скалярных профилей
+    typedef Scalar scalar_type;
+    /// @brief Тип скалярного профиля на точках
+    typedef vector<Scalar> point_profile_type;
+    /// @brief Тип скалярного профиля на ячейках
+    typedef vector<Scalar> cell_profile_type;
 
     /// @brief Список скалярных профилей на границах ячеек
-    array<vector<double>, PointScalar> point_double;
+    array<point_profile_type, PointScalar> point_double;
     /// @brief Список скалярных профилей в ячейках
-    array<vector<double>, CellScalar> cell_double;
+    array<cell_profile_type, CellScalar> cell_double;
     /// @brief Список векторных профилей на границах ячеек
     array<vector<point_vector_type>, PointVector> point_vector;
     /// @brief Список векторных профилей в ячейках
     array<vector<cell_vector_type>, CellVector> cell_vector;
 
-    vector<double>& get_point_profile(size_t profile_index) {
+    point_profile_type& get_point_profile(size_t profile_index) {
         return point_double[profile_index];
     }
 
     profile_collection_t(size_t point_count)
-        : point_double{ array_maker<vector<double>, PointScalar>::make_array(vector<double>(point_count)) }
+        : point_double{ array_maker<point_profile_type, PointScalar>::make_array(point_profile_type(point_count)) }
         , point_vector{ array_maker<vector<point_vector_type>, PointVector>::make_array(vector<point_vector_type>(point_count)) }
-        , cell_double{ array_maker<vector<double>, CellScalar>::make_array(vector<double>(point_count - 1)) }
+        , cell_double{ array_maker<cell_profile_type, CellScalar>::make_array(cell_profile_type(point_count - 1)) }
         , cell_vector{ array_maker<vector<cell_vector_type>, CellVector>::make_array(vector<cell_vector_type>(point_count)) }
     {
 
@@ -207,12 +232,12 @@ struct profile_collection_t
     /// @param t Время
     /// @param os Поток для вывода
     void print(double t, std::ostream& os) {
-        auto print_vector = [&](const vector<double>& data) {
+        auto print_vector = [&](const vector<Scalar>& data) {
             if (data.empty())
                 return;
             os << data[0];
             std::for_each(data.begin() + 1, data.end(),
-                [&](double value)
+                [&](Scalar value)
                 {
                     os << "; " << value;
                 });
@@ -240,6 +265,57 @@ struct profile_collection_t
     }
 };
 
+/// @brief Объем памяти, выделенной под профили слоя, байт
+template <size_t PointScalar, size_t CellScalar, size_t PointVector, size_t PointVectorDimension,
+    size_t CellVector, size_t CellVectorDimension, typename Scalar>
+inline size_t get_allocated_size(const profile_collection_t<PointScalar, CellScalar,
+    PointVector, PointVectorDimension, CellVector, CellVectorDimension, Scalar>& layer)
+{
+    return get_allocated_size(layer.point_double) + get_allocated_size(layer.cell_double)
+        + get_allocated_size(layer.point_vector) + get_allocated_size(layer.cell_vector);
+}
+
+/// @brief Слой с количеством точек сетки PointCount, заданным на этапе компиляции
+/// Аналог profile_collection_t для коротких труб (десятки точек), которые рассчитываются
+/// многократно: профили хранятся в std::array внутри слоя, без выделения динамической памяти,
+/// а длина циклов по точкам и ячейкам известна компилятору. Векторные профили не поддерживаются
+/// @tparam PointCount Количество точек сетки
+/// @tparam PointScalar Количество скалярных профилей на точках
+/// @tparam CellScalar Количество скалярных профилей на ячейках
+/// @tparam Scalar Тип значений профилей
+template <size_t PointCount, size_t PointScalar, size_t CellScalar = 0, typename Scalar = double>
+struct fixed_profile_collection_t
+{
+    static_assert(PointCount >= 2, "fixed_profile_collection_t: at least one cell is required");
+
+    /// @brief Тип значений скалярных профилей
+    typedef Scalar scalar_type;
+    /// @brief Тип скалярного профиля на точках
+    typedef array<Scalar, PointCount> point_profile_type;
+    /// @brief Тип скалярного профиля на ячейках
+    typedef array<Scalar, PointCount - 1> cell_profile_type;
+
+    /// @brief Список скалярных профилей на границах ячеек
+    array<point_profile_type, PointScalar> point_double{};
+    /// @brief Список скалярных профилей в ячейках
+    array<cell_profile_type, CellScalar> cell_double{};
+
+    point_profile_type& get_point_profile(size_t profile_index) {
+        return point_double[profile_index];
+    }
+
+    fixed_profile_collection_t() = default;
+
+    /// @brief Конструктор для совместимости с profile_collection_t (в т.ч. для composite_layer_t)
+    /// @param point_count Количество точек сетки, должно совпадать с PointCount
+    fixed_profile_collection_t(size_t point_count)
+    {
+        if (point_count != PointCount) {
+            throw std::runtime_error("fixed_profile_collection_t: point_count != PointCount");
+        }
+    }
+};
+
 /// @brief Составной слой, включающий в себя слой переменных и слои со специальными структурами
 /// @tparam VarLayer Тип слоя с целевыми переменными
 /// @tparam ...SpecificLayers Типы слоев со специальными слоями
@@ -1,5 +1,10 @@
 ﻿#pragma once
 
+#include <array>
+#include <atomic>
+#include <memory>
+#include <utility>
+
 /// @brief Контейнер слоев с удобным доступом при численном расчете задач на ДУЧП и им подобным
 /// Организует циклическую смену буферов
 /// Наиболее типичное использование - организация двух слоев 
@@ -103,3 +108,228 @@ public:
     }
 
 };
+
+/// @brief Кольцевой буфер с количеством слоев LayerCount, заданным на этапе компиляции
+/// Слои хранятся в std::array внутри буфера, без выделения динамической памяти.
+/// Интерфейс доступа к слоям совпадает с ring_buffer_t. В паре с fixed_profile_collection_t
+/// используется для коротких труб, которые рассчитываются многократно
+/// @tparam LayerType Тип слоя
+/// @tparam LayerCount Количество слоев
+template <typename LayerType, size_t LayerCount>
+class fixed_ring_buffer_t {
+    static_assert(LayerCount > 0, "fixed_ring_buffer_t: at least one layer is required");
+
+    /// @brief Буфер слоев
+    std::array<LayerType, LayerCount> layers;
+    /// @brief Индекс текущего слоя
+    size_t current_layer{ 0 };
+private:
+    /// @brief Заполняет массив слоев копиями layer (LayerType может не иметь конструктора по умолчанию)
+    template <size_t... Index>
+    static std::array<LayerType, LayerCount> make_layers(const LayerType& layer, std::index_sequence<Index...>)
+    {
+        return { { ((void)Index, layer)... } };
+    }
+protected:
+    /// @brief Рассчитывает индекс слоя в layers на основе 
+    /// смещения offset от текущего индекса current_layer
+    size_t advanced_layer_index(int offset) const {
+        return (current_layer + LayerCount + offset) % LayerCount;
+    }
+    /// @brief Эквивалентен advanced_layer_index(-1)
+    size_t previous_layer_index() const {
+        return (current_layer + LayerCount - 1) % LayerCount;
+    }
+public:
+    /// @brief Конструктор с инициализацией буфера слоев по переданному слою layer
+    /// @param layer Слой для инициализации
+    fixed_ring_buffer_t(const LayerType& layer)
+        : layers(make_layers(layer, std::make_index_sequence<LayerCount>()))
+    {
+    }
+    /// @brief Конструктор с инициализацией буфера по размерности каждого слоя
+    /// @param profile_length Передается в конструктор LayerType 
+    fixed_ring_buffer_t(size_t profile_length)
+        : fixed_ring_buffer_t(LayerType(profile_length))
+    {
+    }
+    /// @brief Возвращает внутренний буфер слоев 
+    const std::array<LayerType, LayerCount>& get_layers() const {
+        return layers;
+    }
+    /// @brief Смещает текущий слой на offset
+    void advance(int offset) {
+        current_layer = advanced_layer_index(offset);
+    }
+
+    LayerType& operator[](int offset) { return layers[advanced_layer_index(offset)]; }
+    const LayerType& operator[](int offset) const { return layers[advanced_layer_index(offset)]; }
+
+    /// @brief Ссылка на текущий слой 
+    LayerType& current() { return layers[current_layer]; }
+    /// @brief Константная ссылка на текущий слой
+    const LayerType& current() const { return layers[current_layer]; }
+    /// @brief Ссылка на предыдущий слой 
+    LayerType& previous() { return layers[previous_layer_index()]; }
+    /// @brief Константная ссылка на предыдущий слой 
+    const LayerType& previous() const { return layers[previous_layer_index()]; }
+};
+
+/// @brief Кольцевой буфер с разделяемыми между копиями слоями (копирование при записи)
+/// Копия буфера (например, при ответвлении сценария расчета) не копирует слои, а разделяет их
+/// с исходным буфером. Слой копируется при первом неконстантном доступе к нему, если он
+/// разделяется с другим буфером; константный доступ слои не копирует. Поскольку шаг расчета
+/// перезаписывает текущий слой целиком, разделение делается на уровне слоев, а не частей профилей;
+/// для слоя, который будет перезаписан целиком, есть overwrite_current - без копирования.
+/// Интерфейс доступа к слоям совпадает с ring_buffer_t. Копии можно использовать в разных потоках,
+/// если каждая копия используется одним потоком: количество владельцев слоя - атомарный счетчик,
+/// отказ от слоя уменьшает его с release, а запись на месте начинается только после чтения
+/// счетчика с acquire, поэтому чтения слоя прежними владельцами упорядочены до записи
+/// @tparam LayerType Тип слоя
+template <typename LayerType>
+class cow_ring_buffer_t {
+    /// @brief Слой и количество буферов, которые его разделяют
+    struct shared_layer_t {
+        /// @brief Слой
+        LayerType layer;
+        /// @brief Количество буферов-владельцев
+        std::atomic<size_t> owners{ 1 };
+
+        template <typename... Args>
+        explicit shared_layer_t(Args&&... args)
+            : layer(std::forward<Args>(args)...)
+        {
+        }
+    };
+
+    /// @brief Буфер слоев
+    vector<shared_layer_t*> layers;
+    /// @brief Индекс текущего слоя
+    size_t current_layer{ 0 };
+private:
+    /// @brief Отказ буфера от слоя; последний владелец удаляет слой
+    static void release(shared_layer_t* layer) {
+        if (layer->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete layer;
+        }
+    }
+    /// @brief Отказ от всех слоев
+    void release_all() {
+        for (shared_layer_t* layer : layers) {
+            release(layer);
+        }
+        layers.clear();
+    }
+    /// @brief Признак того, что слой принадлежит только этому буферу
+    /// (с acquire - работа прежних владельцев со слоем завершена до возврата true)
+    bool is_unique(size_t index) const {
+        return layers[index]->owners.load(std::memory_order_acquire) == 1;
+    }
+    /// @brief Заменяет слой новым, принадлежащим только этому буферу
+    template <typename... Args>
+    LayerType& replace_layer(size_t index, Args&&... layer_args) {
+        shared_layer_t* replacement = new shared_layer_t(std::forward<Args>(layer_args)...);
+        release(layers[index]);
+        layers[index] = replacement;
+        return replacement->layer;
+    }
+protected:
+    /// @brief Рассчитывает индекс слоя в layers на основе 
+    /// смещения offset от текущего индекса current_layer
+    size_t advanced_layer_index(int offset) const {
+        return (current_layer + layers.size() + offset) % layers.size();
+    }
+    /// @brief Эквивалентен advanced_layer_index(-1)
+    size_t previous_layer_index() const {
+        return (current_layer + layers.size() - 1) % layers.size();
+    }
+    /// @brief Слой для записи: если слой разделяется с другим буфером, он предварительно копируется
+    LayerType& get_unique_layer(size_t index) {
+        if (is_unique(index)) {
+            return layers[index]->layer;
+        }
+        return replace_layer(index, layers[index]->layer);
+    }
+public:
+    /// @brief Конструктор с инициализацией буфера слоев по переданному слою layer
+    /// @param layer_count Количество слоев в буфере
+    /// @param layer Слой для инициализации
+    cow_ring_buffer_t(size_t layer_count, const LayerType& layer)
+    {
+        layers.reserve(layer_count);
+        try {
+            for (size_t index = 0; index < layer_count; ++index) {
+                layers.push_back(new shared_layer_t(layer));
+            }
+        }
+        catch (...) {
+            release_all();
+            throw;
+        }
+    }
+    /// @brief Конструктор с инициализацией буфера по размерности каждого слоя
+    /// @param layer_count Количество слоев
+    /// @param profile_length Передается в конструктор LayerType 
+    cow_ring_buffer_t(size_t layer_count, size_t profile_length)
+        : cow_ring_buffer_t(layer_count, LayerType(profile_length))
+    {
+    }
+    /// @brief Копия разделяет все слои с исходным буфером
+    cow_ring_buffer_t(const cow_ring_buffer_t& other)
+        : layers(other.layers)
+        , current_layer(other.current_layer)
+    {
+        for (shared_layer_t* layer : layers) {
+            layer->owners.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    cow_ring_buffer_t(cow_ring_buffer_t&& other) noexcept
+        : layers(std::move(other.layers))
+        , current_layer(other.current_layer)
+    {
+        other.layers.clear();
+    }
+    cow_ring_buffer_t& operator=(cow_ring_buffer_t other) noexcept {
+        std::swap(layers, other.layers);
+        std::swap(current_layer, other.current_layer);
+        return *this;
+    }
+    ~cow_ring_buffer_t() {
+        release_all();
+    }
+    /// @brief Количество слоев
+    size_t get_layer_count() const {
+        return layers.size();
+    }
+    /// @brief Признак того, что слой со смещением offset разделяется с другим буфером
+    bool is_shared(int offset) const {
+        return !is_unique(advanced_layer_index(offset));
+    }
+    /// @brief Смещает текущий слой на offset
+    void advance(int offset) {
+        current_layer = advanced_layer_index(offset);
+    }
+
+    LayerType& operator[](int offset) { return get_unique_layer(advanced_layer_index(offset)); }
+    const LayerType& operator[](int offset) const { return layers[advanced_layer_index(offset)]->layer; }
+
+    /// @brief Ссылка на текущий слой (копирует разделяемый слой)
+    LayerType& current() { return get_unique_layer(current_layer); }
+    /// @brief Константная ссылка на текущий слой
+    const LayerType& current() const { return layers[current_layer]->layer; }
+    /// @brief Ссылка на предыдущий слой (копирует разделяемый слой)
+    LayerType& previous() { return get_unique_layer(previous_layer_index()); }
+    /// @brief Константная ссылка на предыдущий слой 
+    const LayerType& previous() const { return layers[previous_layer_index()]->layer; }
+    /// @brief Ссылка на текущий слой, который будет перезаписан целиком
+    /// Разделяемый слой не копируется: он заменяется новым, созданным конструктором LayerType
+    /// по аргументам layer_args (например, количеству точек). Неразделяемый слой возвращается как есть,
+    /// поэтому содержимое результата не определено - все профили слоя должны быть перезаписаны
+    template <typename... Args>
+    LayerType& overwrite_current(Args&&... layer_args) {
+        if (is_unique(current_layer)) {
+            return layers[current_layer]->layer;
+        }
+        return replace_layer(current_layer, std::forward<Args>(layer_args)...);
+    }
+};
@@ -0,0 +1,153 @@
+﻿#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pde_solvers {
+;
+
+/// @brief Пул потоков для параллельных циклов по независимым элементам
+/// Потоки создаются один раз и ждут очередного parallel_for, поэтому пул
+/// можно использовать на каждом шаге расчета без затрат на создание потоков
+/// Вызывающий поток тоже участвует в работе. Вложенные вызовы parallel_for не поддерживаются
+class thread_pool_t {
+    /// @brief Рабочие потоки (без учета вызывающего)
+    std::vector<std::thread> workers;
+    /// @brief Текущая задача: обработка элемента по индексу
+    const std::function<void(size_t)>* task{ nullptr };
+    /// @brief Количество элементов текущей задачи
+    size_t task_count{ 0 };
+    /// @brief Индекс следующего необработанного элемента
+    std::atomic<size_t> next_index{ 0 };
+    /// @brief Номер задачи - по его изменению рабочие потоки узнают о новой задаче
+    size_t generation{ 0 };
+    /// @brief Количество рабочих потоков, еще не завершивших текущую задачу
+    size_t active_workers{ 0 };
+    /// @brief Первое исключение, возникшее при обработке элементов
+    std::exception_ptr error;
+    /// @brief Признак завершения работы пула
+    bool stop{ false };
+
+    std::mutex mutex;
+    std::condition_variable task_started;
+    std::condition_variable task_finished;
+    /// @brief Сериализует вызовы parallel_for из разных потоков
+    std::mutex call_mutex;
+
+private:
+    /// @brief Обрабатывает элементы текущей задачи, пока они не закончатся
+    void run_items(const std::function<void(size_t)>& function, size_t count)
+    {
+        size_t index;
+        while ((index = next_index++) < count) {
+            try {
+                function(index);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next_index = count; // оставшиеся элементы не обрабатываются
+            }
+        }
+    }
+
+    /// @brief Цикл рабочего потока
+    void run()
+    {
+        size_t processed_generation = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            task_started.wait(lock, [&]() { return stop || generation != processed_generation; });
+            if (stop) {
+                break;
+            }
+            processed_generation = generation;
+            const std::function<void(size_t)>& function = *task;
+            size_t count = task_count;
+            lock.unlock();
+            run_items(function, count);
+            lock.lock();
+            if (--active_workers == 0) {
+                task_finished.notify_all();
+            }
+        }
+    }
+
+public:
+    /// @brief Создает пул
+    /// @param thread_count Общее количество потоков, включая вызывающий parallel_for
+    /// (по умолчанию - количество аппаратных потоков)
+    explicit thread_pool_t(size_t thread_count = std::thread::hardware_concurrency())
+    {
+        for (size_t index = 1; index < thread_count; ++index) {
+            workers.emplace_back(&thread_pool_t::run, this);
+        }
+    }
+
+    thread_pool_t(const thread_pool_t&) = delete;
+    thread_pool_t& operator=(const thread_pool_t&) = delete;
+
+    /// @brief Останавливает рабочие потоки
+    ~thread_pool_t()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        task_started.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /// @brief Общее количество потоков, включая вызывающий
+    size_t get_thread_count() const {
+        return workers.size() + 1;
+    }
+
+    /// @brief Вызывает function(index) для index = 0..count-1, распределяя индексы по потокам
+    /// Возвращает управление после обработки всех элементов. Исключение, выброшенное
+    /// при обработке элемента, прекращает раздачу оставшихся элементов и пробрасывается вызывающему
+    void parallel_for(size_t count, const std::function<void(size_t)>& function)
+    {
+        if (workers.empty() || count <= 1) {
+            for (size_t index = 0; index < count; ++index) {
+                function(index);
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> call_lock(call_mutex);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &function;
+            task_count = count;
+            next_index = 0;
+            error = nullptr;
+            active_workers = workers.size();
+            generation++;
+        }
+        task_started.notify_all();
+
+        run_items(function, count);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        task_finished.wait(lock, [this]() { return active_workers == 0; });
+        task = nullptr;
+        if (error) {
+            std::exception_ptr to_throw = error;
+            error = nullptr;
+            lock.unlock();
+            std::rethrow_exception(to_throw);
+        }
+    }
+};
+
+}
@@ -0,0 +1,296 @@
+﻿#pragma once
+
+#include <charconv>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "../timeseries/timeseries_helpers.h"
+
+namespace pde_solvers {
+;
+
+using std::string;
+
+/// @brief Снимок слоя для вывода: момент времени и копии выводимых профилей
+struct layer_snapshot_t {
+    /// @brief Момент времени (модельное или UNIX-время - на усмотрение приемника)
+    double time{ 0 };
+    /// @brief Профили в порядке, заданном при создании приемника
+    vector<vector<double>> profiles;
+};
+
+/// @brief Приемник снимков слоев (CSV, бинарный колоночный формат и т.п.)
+/// Методы вызываются только из фонового потока async_layer_writer_t
+class layer_sink_t {
+public:
+    virtual ~layer_sink_t() = default;
+    /// @brief Запись одного снимка слоя
+    virtual void write(const layer_snapshot_t& snapshot) = 0;
+    /// @brief Сброс буферов приемника на диск
+    virtual void flush() {}
+};
+
+/// @brief Приемник в текстовом формате isothermal_quasistatic_task_t::print:
+/// для каждого профиля свой файл "<path>output <name>.csv",
+/// строка - время в формате "%c" и значения через ";"
+/// Файлы открываются один раз, числа форматируются без потоков (std::to_chars)
+class csv_layer_sink_t : public layer_sink_t {
+    /// @brief Файлы в порядке профилей снимка
+    vector<std::ofstream> files;
+    /// @brief Буфер формирования строки (переиспользуется между вызовами)
+    string line;
+public:
+    /// @brief Открывает (в режиме дозаписи) файлы для всех профилей
+    /// @param path Папка для вывода
+    /// @param profile_names Имена профилей в порядке их передачи в снимке
+    csv_layer_sink_t(const string& path, const vector<string>& profile_names)
+    {
+        for (const string& name : profile_names) {
+            files.emplace_back(path + "output " + name + ".csv", std::ios::app);
+            if (!files.back().is_open()) {
+                throw std::runtime_error("csv_layer_sink_t: cannot open file for profile " + name);
+            }
+        }
+    }
+
+    virtual void write(const layer_snapshot_t& snapshot) override
+    {
+        if (snapshot.profiles.size() != files.size()) {
+            throw std::logic_error("csv_layer_sink_t: wrong profile count in snapshot");
+        }
+        string time_string = UnixToString(static_cast<time_t>(snapshot.time), "%c");
+
+        char number[64];
+        for (size_t index = 0; index < files.size(); ++index) {
+            line = time_string;
+            line += ';';
+            for (double value : snapshot.profiles[index]) {
+                // Формат совпадает с std::to_string(double), т.е. "%f"
+                auto [end, error] = std::to_chars(number, number + sizeof(number),
+                    value, std::chars_format::fixed, 6);
+                line.append(number, end);
+                line += ';';
+            }
+            line += '\n';
+            files[index].write(line.data(), line.size());
+        }
+    }
+
+    virtual void flush() override
+    {
+        for (auto& file : files) {
+            file.flush();
+        }
+    }
+};
+
+/// @brief Настройки фонового писателя результатов
+struct async_layer_writer_settings_t {
+    /// @brief Количество снимков в очереди (2 - двойная буферизация)
+    size_t queue_capacity{ 2 };
+    /// @brief Прореживание по времени: записывается каждый N-ый переданный слой
+    size_t time_decimation{ 1 };
+    /// @brief Прореживание по пространству: записывается каждая N-ая точка профиля
+    /// (последняя точка записывается всегда)
+    size_t space_decimation{ 1 };
+    /// @brief Ждать освобождения очереди (true) или пропускать слой (false), если очередь заполнена
+    /// По умолчанию поток расчета никогда не ждет диск, пропущенные слои учитываются в счетчике
+    bool wait_if_full{ false };
+};
+
+/// @brief Фоновый писатель результатов расчета
+/// Поток расчета только копирует профили в заранее выделенный снимок из ограниченной очереди,
+/// форматирование и запись на диск выполняет фоновый поток через приемник layer_sink_t
+/// Предполагается один поток-производитель (поток расчета)
+class async_layer_writer_t {
+    /// @brief Приемник снимков
+    std::unique_ptr<layer_sink_t> sink;
+    /// @brief Настройки
+    const async_layer_writer_settings_t settings;
+    /// @brief Кольцевая очередь снимков (память переиспользуется между слоями)
+    vector<layer_snapshot_t> slots;
+    /// @brief Индекс первого снимка в очереди
+    size_t head{ 0 };
+    /// @brief Количество снимков в очереди (включая записываемый в данный момент)
+    size_t count{ 0 };
+    /// @brief Количество вызовов push (для прореживания по времени)
+    size_t push_counter{ 0 };
+    /// @brief Количество слоев, пропущенных из-за заполненной очереди
+    size_t dropped_count{ 0 };
+    /// @brief Количество записанных слоев
+    size_t written_count{ 0 };
+    /// @brief Признак завершения работы
+    bool stop{ false };
+    /// @brief Исключение, возникшее в фоновом потоке
+    std::exception_ptr error;
+
+    mutable std::mutex mutex;
+    std::condition_variable queue_changed;
+    std::thread worker;
+
+private:
+    /// @brief Цикл фонового потока
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            queue_changed.wait(lock, [this]() { return count > 0 || stop; });
+            if (count == 0) {
+                break; // stop и очередь пуста
+            }
+            layer_snapshot_t& snapshot = slots[head];
+            lock.unlock();
+            std::exception_ptr write_error;
+            try {
+                sink->write(snapshot);
+            }
+            catch (...) {
+                write_error = std::current_exception();
+            }
+            lock.lock();
+            if (write_error && !error) {
+                error = write_error;
+            }
+            if (!write_error) {
+                written_count++;
+            }
+            head = (head + 1) % slots.size();
+            count--;
+            queue_changed.notify_all();
+        }
+        try {
+            sink->flush();
+        }
+        catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    /// @brief Пробрасывает в поток расчета исключение фонового потока (однократно)
+    void rethrow_error(std::unique_lock<std::mutex>& lock)
+    {
+        if (error) {
+            std::exception_ptr to_throw = error;
+            error = nullptr;
+            lock.unlock();
+            std::rethrow_exception(to_throw);
+        }
+    }
+
+    /// @brief Копирует профиль с учетом прореживания по пространству
+    /// Профили в другом типе (например, float) преобразуются в double
+    template <typename Scalar>
+    void copy_profile(const vector<Scalar>& source, vector<double>* _destination) const
+    {
+        vector<double>& destination = *_destination;
+        size_t step = (std::max<size_t>)(1, settings.space_decimation);
+        if (step == 1 || source.size() <= 2) {
+            destination.assign(source.begin(), source.end());
+            return;
+        }
+        destination.clear();
+        for (size_t index = 0; index < source.size(); index += step) {
+            destination.push_back(source[index]);
+        }
+        if ((source.size() - 1) % step != 0) {
+            destination.push_back(source.back());
+        }
+    }
+
+public:
+    /// @brief Создает писатель и запускает фоновый поток
+    /// @param sink Приемник снимков
+    /// @param settings Настройки очереди и прореживания
+    async_layer_writer_t(std::unique_ptr<layer_sink_t> sink,
+        const async_layer_writer_settings_t& settings = async_layer_writer_settings_t())
+        : sink(std::move(sink))
+        , settings(settings)
+        , slots((std::max<size_t>)(1, settings.queue_capacity))
+    {
+        if (!this->sink) {
+            throw std::logic_error("async_layer_writer_t: sink is not set");
+        }
+        worker = std::thread(&async_layer_writer_t::run, this);
+    }
+
+    async_layer_writer_t(const async_layer_writer_t&) = delete;
+    async_layer_writer_t& operator=(const async_layer_writer_t&) = delete;
+
+    /// @brief Дописывает очередь и останавливает фоновый поток
+    ~async_layer_writer_t()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        queue_changed.notify_all();
+        worker.join();
+    }
+
+    /// @brief Передает слой на запись. Профили копируются, диск не затрагивается
+    /// @param time Момент времени
+    /// @param profiles Профили в порядке, ожидаемом приемником
+    /// @return true, если слой поставлен в очередь;
+    /// false, если пропущен прореживанием или из-за заполненной очереди
+    template <typename... Profiles>
+    bool push(double time, const Profiles&... profiles)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        rethrow_error(lock);
+
+        size_t decimation = (std::max<size_t>)(1, settings.time_decimation);
+        if (push_counter++ % decimation != 0) {
+            return false;
+        }
+
+        if (count == slots.size()) {
+            if (!settings.wait_if_full) {
+                dropped_count++;
+                return false;
+            }
+            queue_changed.wait(lock, [this]() { return count < slots.size(); });
+        }
+        // Слот за концом очереди не виден фоновому потоку, заполняем его без блокировки
+        layer_snapshot_t& snapshot = slots[(head + count) % slots.size()];
+        lock.unlock();
+
+        snapshot.time = time;
+        snapshot.profiles.resize(sizeof...(Profiles));
+        size_t index = 0;
+        (copy_profile(profiles, &snapshot.profiles[index++]), ...);
+
+        lock.lock();
+        count++;
+        lock.unlock();
+        queue_changed.notify_all();
+        return true;
+    }
+
+    /// @brief Ожидает запись всех поставленных в очередь слоев и сбрасывает приемник на диск
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        queue_changed.wait(lock, [this]() { return count == 0; });
+        rethrow_error(lock);
+        // Фоновый поток простаивает, пока удерживается блокировка
+        sink->flush();
+    }
+
+    /// @brief Количество слоев, пропущенных из-за заполненной очереди
+    size_t get_dropped_count() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return dropped_count;
+    }
+    /// @brief Количество записанных слоев
+    size_t get_written_count() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return written_count;
+    }
+};
+
+}
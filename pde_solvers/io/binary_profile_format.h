@@ -0,0 +1,511 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <type_traits>
+#include "mapped_file.h"
+#include "async_layer_writer.h"
+
+namespace pde_solvers {
+;
+
+/// @brief Бинарный колоночный формат истории профилей (*.pdeprof)
+/// Все числа little-endian, все секции выровнены на 8 байт
+/// 
+/// Заголовок:
+///   char[8] "PDEPRF01"; uint32 версия; uint32 флаги (бит 0 - значения float32);
+///   uint32 количество профилей; uint32 резерв;
+///   uint64 количество координат сетки; uint64 размер записи; uint64 смещение первой записи
+/// Описания профилей (для каждого):
+///   uint32 признак профиля на ячейках; uint32 резерв; uint64 количество значений;
+///   uint32 длина имени; имя; uint32 длина единиц измерения; единицы измерения
+/// Сетка: float64[количество координат] (может отсутствовать)
+/// Записи фиксированного размера, по одной на момент времени:
+///   float64 время; для каждого профиля - значения подряд (float64 или float32), 
+///   дополненные до 8 байт
+/// Индекс (дописывается при закрытии):
+///   float64[количество записей] моменты времени; uint64 количество записей;
+///   uint64 смещение индекса; char[8] "PDEIDX01"
+/// 
+/// Если файл не был закрыт (расчет прерван), записи восстанавливаются по размеру файла
+namespace binary_profile_format {
+;
+/// @brief Сигнатура начала файла
+constexpr char header_magic[8] = { 'P', 'D', 'E', 'P', 'R', 'F', '0', '1' };
+/// @brief Сигнатура конца индекса
+constexpr char index_magic[8] = { 'P', 'D', 'E', 'I', 'D', 'X', '0', '1' };
+/// @brief Версия формата
+constexpr uint32_t version = 1;
+/// @brief Флаг значений в формате float32
+constexpr uint32_t flag_float32 = 1;
+/// @brief Размер заголовка до описаний профилей
+constexpr size_t header_size = 48;
+/// @brief Размер окончания индекса (количество записей, смещение, сигнатура)
+constexpr size_t trailer_size = 24;
+
+/// @brief Округление размера вверх до кратного 8 байтам
+inline size_t align8(size_t size) {
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+/// @brief Проверяет, что платформа little-endian (формат не поддерживает другой порядок байт)
+inline void check_byte_order() {
+    const uint16_t probe = 1;
+    unsigned char first_byte;
+    std::memcpy(&first_byte, &probe, 1);
+    if (first_byte != 1) {
+        throw std::runtime_error("binary_profile_format: big-endian platforms are not supported");
+    }
+}
+}
+
+/// @brief Описание профиля в бинарном файле
+struct binary_profile_info_t {
+    /// @brief Имя профиля
+    string name;
+    /// @brief Единицы измерения
+    string units{ "_" };
+    /// @brief Профиль на ячейках (true) или на точках (false)
+    bool on_cells{ false };
+    /// @brief Количество значений профиля. 
+    /// Для binary_layer_sink_t может быть 0 - тогда берется из первого слоя
+    size_t value_count{ 0 };
+};
+
+/// @brief Запись истории профилей в бинарный колоночный формат
+class binary_profile_writer_t {
+    /// @brief Файл
+    std::ofstream file;
+    /// @brief Описания профилей
+    vector<binary_profile_info_t> profiles;
+    /// @brief Запись значений в float32
+    bool use_float32;
+    /// @brief Размер записи одного момента времени, байт
+    size_t record_size{ 0 };
+    /// @brief Смещение первой записи
+    size_t data_offset{ 0 };
+    /// @brief Моменты времени записанных слоев (для индекса)
+    vector<double> times;
+    /// @brief Буфер формирования записи (переиспользуется)
+    vector<char> record;
+    /// @brief Файл закрыт, индекс записан
+    bool closed{ false };
+
+private:
+    template <typename T>
+    void write_value(const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void write_string(const string& value) {
+        write_value(static_cast<uint32_t>(value.size()));
+        file.write(value.data(), value.size());
+    }
+    void write_padding() {
+        static const char zeros[8] = {};
+        size_t position = static_cast<size_t>(file.tellp());
+        file.write(zeros, binary_profile_format::align8(position) - position);
+    }
+    size_t get_value_size() const {
+        return use_float32 ? sizeof(float) : sizeof(double);
+    }
+
+public:
+    /// @brief Создает файл и записывает заголовок
+    /// @param filename Путь к файлу
+    /// @param profiles Описания профилей (количество значений обязательно)
+    /// @param use_float32 Хранить значения в float32 (вдвое компактнее, ~7 значащих цифр)
+    /// @param grid Координаты сетки (необязательно)
+    binary_profile_writer_t(const string& filename, const vector<binary_profile_info_t>& profiles,
+        bool use_float32 = false, const vector<double>& grid = vector<double>())
+        : file(filename, std::ios::binary | std::ios::trunc)
+        , profiles(profiles)
+        , use_float32(use_float32)
+    {
+        binary_profile_format::check_byte_order();
+        if (!file.is_open()) {
+            throw std::runtime_error("binary_profile_writer_t: cannot open file " + filename);
+        }
+
+        record_size = sizeof(double);
+        for (const binary_profile_info_t& profile : profiles) {
+            if (profile.value_count == 0) {
+                throw std::logic_error("binary_profile_writer_t: value count is not set for profile " + profile.name);
+            }
+            record_size += binary_profile_format::align8(profile.value_count * get_value_size());
+        }
+        record.resize(record_size);
+
+        file.write(binary_profile_format::header_magic, sizeof(binary_profile_format::header_magic));
+        write_value(binary_profile_format::version);
+        write_value(use_float32 ? binary_profile_format::flag_float32 : uint32_t{ 0 });
+        write_value(static_cast<uint32_t>(profiles.size()));
+        write_value(uint32_t{ 0 });
+        write_value(static_cast<uint64_t>(grid.size()));
+        write_value(static_cast<uint64_t>(record_size));
+        std::streampos data_offset_position = file.tellp();
+        write_value(uint64_t{ 0 }); // смещение первой записи, известно после описаний
+
+        for (const binary_profile_info_t& profile : profiles) {
+            write_value(static_cast<uint32_t>(profile.on_cells ? 1 : 0));
+            write_value(uint32_t{ 0 });
+            write_value(static_cast<uint64_t>(profile.value_count));
+            write_string(profile.name);
+            write_string(profile.units);
+        }
+        write_padding();
+        file.write(reinterpret_cast<const char*>(grid.data()), grid.size() * sizeof(double));
+
+        data_offset = static_cast<size_t>(file.tellp());
+        file.seekp(data_offset_position);
+        write_value(static_cast<uint64_t>(data_offset));
+        file.seekp(data_offset);
+        if (!file) {
+            throw std::runtime_error("binary_profile_writer_t: cannot write header to " + filename);
+        }
+    }
+
+    binary_profile_writer_t(const binary_profile_writer_t&) = delete;
+    binary_profile_writer_t& operator=(const binary_profile_writer_t&) = delete;
+
+    /// @brief Закрывает файл с записью индекса
+    ~binary_profile_writer_t()
+    {
+        try {
+            close();
+        }
+        catch (...) {
+            // Без индекса файл все равно читается
+        }
+    }
+
+    /// @brief Записывает слой
+    /// @param time Момент времени
+    /// @param values Профили в порядке описаний, заданных при создании
+    void write(double time, const vector<vector<double>>& values)
+    {
+        if (closed) {
+            throw std::logic_error("binary_profile_writer_t: file is already closed");
+        }
+        if (values.size() != profiles.size()) {
+            throw std::logic_error("binary_profile_writer_t: wrong profile count");
+        }
+        char* position = record.data();
+        std::memcpy(position, &time, sizeof(double));
+        position += sizeof(double);
+        for (size_t index = 0; index < profiles.size(); ++index) {
+            const vector<double>& profile = values[index];
+            if (profile.size() != profiles[index].value_count) {
+                throw std::logic_error("binary_profile_writer_t: wrong value count for profile "
+                    + profiles[index].name);
+            }
+            size_t column_size = binary_profile_format::align8(profile.size() * get_value_size());
+            if (use_float32) {
+                float* column = reinterpret_cast<float*>(position);
+                std::transform(profile.begin(), profile.end(), column,
+                    [](double value) { return static_cast<float>(value); });
+            }
+            else {
+                std::memcpy(position, profile.data(), profile.size() * sizeof(double));
+            }
+            size_t used_size = profile.size() * get_value_size();
+            std::fill(position + used_size, position + column_size, '\0');
+            position += column_size;
+        }
+        file.write(record.data(), record.size());
+        if (!file) {
+            throw std::runtime_error("binary_profile_writer_t: write error");
+        }
+        times.push_back(time);
+    }
+
+    /// @brief Сброс буферов на диск
+    void flush() {
+        file.flush();
+    }
+
+    /// @brief Дописывает индекс времен и закрывает файл
+    void close()
+    {
+        if (closed) {
+            return;
+        }
+        closed = true;
+        uint64_t index_offset = static_cast<uint64_t>(file.tellp());
+        file.write(reinterpret_cast<const char*>(times.data()), times.size() * sizeof(double));
+        write_value(static_cast<uint64_t>(times.size()));
+        write_value(index_offset);
+        file.write(binary_profile_format::index_magic, sizeof(binary_profile_format::index_magic));
+        file.close();
+        if (!file) {
+            throw std::runtime_error("binary_profile_writer_t: cannot write index");
+        }
+    }
+
+    /// @brief Количество записанных слоев
+    size_t get_record_count() const {
+        return times.size();
+    }
+};
+
+/// @brief Чтение бинарного файла истории профилей через отображение в память
+/// Значения не разбираются и не копируются: get_values возвращает указатель в отображение
+class binary_profile_reader_t {
+    /// @brief Отображение файла
+    mapped_file_t file;
+    /// @brief Описания профилей
+    vector<binary_profile_info_t> profiles;
+    /// @brief Смещения профилей внутри записи
+    vector<size_t> profile_offsets;
+    /// @brief Значения в формате float32
+    bool use_float32{ false };
+    /// @brief Сетка
+    vector<double> grid;
+    /// @brief Размер записи
+    size_t record_size{ 0 };
+    /// @brief Смещение первой записи
+    size_t data_offset{ 0 };
+    /// @brief Количество записей
+    size_t record_count{ 0 };
+    /// @brief Индекс времен (nullptr, если файл не был закрыт писателем)
+    const double* index_times{ nullptr };
+
+private:
+    /// @brief Читает значение по смещению с проверкой выхода за файл
+    template <typename T>
+    T read_value(size_t* _offset) const {
+        size_t& offset = *_offset;
+        if (offset + sizeof(T) > file.get_size()) {
+            throw std::runtime_error("binary_profile_reader_t: unexpected end of file");
+        }
+        T value;
+        std::memcpy(&value, file.get_data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+    string read_string(size_t* _offset) const {
+        uint32_t length = read_value<uint32_t>(_offset);
+        if (*_offset + length > file.get_size()) {
+            throw std::runtime_error("binary_profile_reader_t: unexpected end of file");
+        }
+        string result(file.get_data() + *_offset, length);
+        *_offset += length;
+        return result;
+    }
+    /// @brief Указатель на начало записи
+    const char* get_record(size_t record) const {
+        if (record >= record_count) {
+            throw std::out_of_range("binary_profile_reader_t: record index is out of range");
+        }
+        return file.get_data() + data_offset + record * record_size;
+    }
+
+public:
+    /// @brief Открывает файл и читает заголовок
+    explicit binary_profile_reader_t(const string& filename)
+        : file(filename)
+    {
+        binary_profile_format::check_byte_order();
+        size_t offset = 0;
+        if (file.get_size() < binary_profile_format::header_size ||
+            std::memcmp(file.get_data(), binary_profile_format::header_magic,
+                sizeof(binary_profile_format::header_magic)) != 0) 
+        {
+            throw std::runtime_error("binary_profile_reader_t: not a profile file " + filename);
+        }
+        offset += sizeof(binary_profile_format::header_magic);
+        uint32_t version = read_value<uint32_t>(&offset);
+        if (version != binary_profile_format::version) {
+            throw std::runtime_error("binary_profile_reader_t: unsupported format version");
+        }
+        use_float32 = (read_value<uint32_t>(&offset) & binary_profile_format::flag_float32) != 0;
+        size_t profile_count = read_value<uint32_t>(&offset);
+        read_value<uint32_t>(&offset);
+        size_t grid_size = static_cast<size_t>(read_value<uint64_t>(&offset));
+        record_size = static_cast<size_t>(read_value<uint64_t>(&offset));
+        data_offset = static_cast<size_t>(read_value<uint64_t>(&offset));
+
+        size_t value_size = use_float32 ? sizeof(float) : sizeof(double);
+        size_t profile_offset = sizeof(double);
+        for (size_t index = 0; index < profile_count; ++index) {
+            binary_profile_info_t profile;
+            profile.on_cells = read_value<uint32_t>(&offset) != 0;
+            read_value<uint32_t>(&offset);
+            profile.value_count = static_cast<size_t>(read_value<uint64_t>(&offset));
+            profile.name = read_string(&offset);
+            profile.units = read_string(&offset);
+            profiles.push_back(profile);
+            profile_offsets.push_back(profile_offset);
+            profile_offset += binary_profile_format::align8(profile.value_count * value_size);
+        }
+        if (profile_offset != record_size) {
+            throw std::runtime_error("binary_profile_reader_t: inconsistent record size");
+        }
+        offset = binary_profile_format::align8(offset);
+        grid.resize(grid_size);
+        for (double& coordinate : grid) {
+            coordinate = read_value<double>(&offset);
+        }
+        if (offset != data_offset || data_offset > file.get_size()) {
+            throw std::runtime_error("binary_profile_reader_t: inconsistent data offset");
+        }
+
+        // Индекс есть только в закрытом файле
+        size_t file_size = file.get_size();
+        if (file_size >= data_offset + binary_profile_format::trailer_size &&
+            std::memcmp(file.get_data() + file_size - sizeof(binary_profile_format::index_magic),
+                binary_profile_format::index_magic, sizeof(binary_profile_format::index_magic)) == 0) 
+        {
+            size_t trailer_offset = file_size - binary_profile_format::trailer_size;
+            record_count = static_cast<size_t>(read_value<uint64_t>(&trailer_offset));
+            size_t index_offset = static_cast<size_t>(read_value<uint64_t>(&trailer_offset));
+            if (index_offset != data_offset + record_count * record_size ||
+                index_offset + record_count * sizeof(double) + binary_profile_format::trailer_size != file_size) 
+            {
+                throw std::runtime_error("binary_profile_reader_t: inconsistent index");
+            }
+            index_times = reinterpret_cast<const double*>(file.get_data() + index_offset);
+        }
+        else {
+            // Файл не закрыт - берем только полностью записанные записи
+            record_count = (file_size - data_offset) / record_size;
+        }
+    }
+
+    /// @brief Описания профилей
+    const vector<binary_profile_info_t>& get_profiles() const {
+        return profiles;
+    }
+    /// @brief Номер профиля по имени
+    size_t find_profile(const string& name) const {
+        for (size_t index = 0; index < profiles.size(); ++index) {
+            if (profiles[index].name == name) {
+                return index;
+            }
+        }
+        throw std::runtime_error("binary_profile_reader_t: profile not found: " + name);
+    }
+    /// @brief Координаты сетки (пусто, если не записывались)
+    const vector<double>& get_grid() const {
+        return grid;
+    }
+    /// @brief Значения хранятся в float32
+    bool is_float32() const {
+        return use_float32;
+    }
+    /// @brief Количество записанных слоев
+    size_t get_record_count() const {
+        return record_count;
+    }
+    /// @brief Момент времени слоя
+    double get_time(size_t record) const {
+        if (index_times != nullptr && record < record_count) {
+            return index_times[record];
+        }
+        double time;
+        std::memcpy(&time, get_record(record), sizeof(double));
+        return time;
+    }
+    /// @brief Номер первого слоя с моментом времени не меньше заданного
+    /// (get_record_count(), если таких нет). Предполагается возрастание времени
+    size_t find_record(double time) const {
+        size_t first = 0;
+        size_t count = record_count;
+        while (count > 0) {
+            size_t step = count / 2;
+            if (get_time(first + step) < time) {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+    /// @brief Указатель на значения профиля в отображении файла (без копирования)
+    /// @tparam T double для файлов float64, float для файлов float32
+    template <typename T>
+    const T* get_values(size_t record, size_t profile) const {
+        static_assert(std::is_same<T, double>::value || std::is_same<T, float>::value,
+            "binary_profile_reader_t: values are stored as double or float");
+        if (use_float32 != std::is_same<T, float>::value) {
+            throw std::logic_error("binary_profile_reader_t: requested value type differs from file");
+        }
+        if (profile >= profiles.size()) {
+            throw std::out_of_range("binary_profile_reader_t: profile index is out of range");
+        }
+        return reinterpret_cast<const T*>(get_record(record) + profile_offsets[profile]);
+    }
+
+    /// @brief Копирует профиль в вектор double (независимо от формата хранения)
+    void read_profile(size_t record, size_t profile, vector<double>* _result) const {
+        vector<double>& result = *_result;
+        size_t count = profiles.at(profile).value_count;
+        if (use_float32) {
+            const float* values = get_values<float>(record, profile);
+            result.assign(values, values + count);
+        }
+        else {
+            const double* values = get_values<double>(record, profile);
+            result.assign(values, values + count);
+        }
+    }
+};
+
+/// @brief Приемник фонового писателя в бинарный колоночный формат
+/// Файл создается при первом слое: незаданные количества значений берутся из него
+/// (так учитывается прореживание по пространству)
+class binary_layer_sink_t : public layer_sink_t {
+    /// @brief Путь к файлу
+    string filename;
+    /// @brief Описания профилей
+    vector<binary_profile_info_t> profiles;
+    /// @brief Хранить значения в float32
+    bool use_float32;
+    /// @brief Координаты сетки
+    vector<double> grid;
+    /// @brief Писатель (создается при первом слое)
+    std::unique_ptr<binary_profile_writer_t> writer;
+public:
+    /// @param filename Путь к файлу
+    /// @param profiles Описания профилей в порядке их передачи в снимке
+    /// @param use_float32 Хранить значения в float32
+    /// @param grid Координаты сетки (с учетом прореживания по пространству)
+    binary_layer_sink_t(const string& filename, const vector<binary_profile_info_t>& profiles,
+        bool use_float32 = false, const vector<double>& grid = vector<double>())
+        : filename(filename)
+        , profiles(profiles)
+        , use_float32(use_float32)
+        , grid(grid)
+    {
+    }
+
+    virtual void write(const layer_snapshot_t& snapshot) override
+    {
+        if (writer == nullptr) {
+            if (snapshot.profiles.size() != profiles.size()) {
+                throw std::logic_error("binary_layer_sink_t: wrong profile count in snapshot");
+            }
+            for (size_t index = 0; index < profiles.size(); ++index) {
+                if (profiles[index].value_count == 0) {
+                    profiles[index].value_count = snapshot.profiles[index].size();
+                }
+            }
+            writer = std::make_unique<binary_profile_writer_t>(filename, profiles, use_float32, grid);
+        }
+        writer->write(snapshot.time, snapshot.profiles);
+    }
+
+    virtual void flush() override
+    {
+        if (writer != nullptr) {
+            writer->flush();
+        }
+    }
+};
+
+}
@@ -0,0 +1,600 @@
+﻿#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include "mapped_file.h"
+
+namespace pde_solvers {
+;
+
+using std::string;
+
+/// @brief Образ контрольной точки в памяти - последовательность байт состояния расчета
+/// Память переиспользуется между сохранениями
+class checkpoint_image_t {
+    /// @brief Данные образа
+    vector<char> data;
+public:
+    /// @brief Очищает образ без освобождения памяти
+    void clear() {
+        data.clear();
+    }
+    /// @brief Добавляет байты в конец образа
+    void write_bytes(const void* bytes, size_t size) {
+        const char* begin = static_cast<const char*>(bytes);
+        data.insert(data.end(), begin, begin + size);
+    }
+    /// @brief Дополняет образ нулями до границы 8 байт
+    void align() {
+        data.resize((data.size() + 7) & ~static_cast<size_t>(7), '\0');
+    }
+    /// @brief Добавляет значение тривиально копируемого типа
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpoint_image_t: type is not trivially copyable");
+        write_bytes(&value, sizeof(T));
+    }
+    /// @brief Данные образа
+    const vector<char>& get_data() const {
+        return data;
+    }
+};
+
+/// @brief Последовательное чтение образа контрольной точки (как правило, отображенного в память)
+class checkpoint_reader_t {
+    /// @brief Начало образа
+    const char* data;
+    /// @brief Размер образа
+    size_t size;
+    /// @brief Текущая позиция
+    size_t offset{ 0 };
+public:
+    checkpoint_reader_t(const char* data, size_t size)
+        : data(data)
+        , size(size)
+    {
+    }
+    /// @brief Количество непрочитанных байт
+    size_t get_remaining() const {
+        return size - offset;
+    }
+    /// @brief Проверяет, что в образе осталось не меньше count элементов размера element_size
+    /// (размеры берутся из образа и проверяются до выделения памяти)
+    void check_remaining(size_t count, size_t element_size) const {
+        if (count > get_remaining() / element_size) {
+            throw std::runtime_error("checkpoint_reader_t: unexpected end of checkpoint");
+        }
+    }
+    /// @brief Копирует байты из образа
+    void read_bytes(void* bytes, size_t count) {
+        if (count > size - offset) {
+            throw std::runtime_error("checkpoint_reader_t: unexpected end of checkpoint");
+        }
+        std::memcpy(bytes, data + offset, count);
+        offset += count;
+    }
+    /// @brief Пропускает дополнение до границы 8 байт
+    void align() {
+        offset = (std::min)((offset + 7) & ~static_cast<size_t>(7), size);
+    }
+    /// @brief Читает значение тривиально копируемого типа
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpoint_reader_t: type is not trivially copyable");
+        T value;
+        read_bytes(&value, sizeof(T));
+        return value;
+    }
+    /// @brief Все ли данные образа прочитаны
+    bool is_finished() const {
+        return offset == size;
+    }
+};
+
+// Сохранение и восстановление состояния: перегрузки write_state/read_state
+// Восстановление выполняется в существующие объекты, размеры векторов берутся из образа
+
+template <typename T>
+inline std::enable_if_t<std::is_arithmetic<T>::value> write_state(checkpoint_image_t* image, const T& value);
+template <typename T>
+inline std::enable_if_t<std::is_arithmetic<T>::value> read_state(checkpoint_reader_t* reader, T* value);
+template <typename T>
+inline void write_state(checkpoint_image_t* image, const vector<T>& values);
+template <typename T>
+inline void read_state(checkpoint_reader_t* reader, vector<T>* values);
+template <typename T, size_t Dimension>
+inline void write_state(checkpoint_image_t* image, const std::array<T, Dimension>& values);
+template <typename T, size_t Dimension>
+inline void read_state(checkpoint_reader_t* reader, std::array<T, Dimension>* values);
+
+/// @brief Сохранение числа
+template <typename T>
+inline std::enable_if_t<std::is_arithmetic<T>::value> write_state(checkpoint_image_t* image, const T& value)
+{
+    image->write(value);
+}
+/// @brief Восстановление числа
+template <typename T>
+inline std::enable_if_t<std::is_arithmetic<T>::value> read_state(checkpoint_reader_t* reader, T* value)
+{
+    *value = reader->read<T>();
+}
+
+/// @brief Сохранение вектора. Векторы чисел копируются одним блоком с выравниванием на 8 байт
+template <typename T>
+inline void write_state(checkpoint_image_t* image, const vector<T>& values)
+{
+    image->write(static_cast<uint64_t>(values.size()));
+    if constexpr (std::is_arithmetic<T>::value) {
+        image->write_bytes(values.data(), values.size() * sizeof(T));
+        image->align();
+    }
+    else {
+        for (const T& value : values) {
+            write_state(image, value);
+        }
+    }
+}
+/// @brief Восстановление вектора
+template <typename T>
+inline void read_state(checkpoint_reader_t* reader, vector<T>* values)
+{
+    uint64_t stored_count = reader->read<uint64_t>();
+    // Каждый элемент занимает в образе хотя бы байт, поэтому поврежденный размер
+    // отклоняется до выделения памяти
+    reader->check_remaining(stored_count > SIZE_MAX ? SIZE_MAX : static_cast<size_t>(stored_count),
+        std::is_arithmetic<T>::value ? sizeof(T) : 1);
+    size_t count = static_cast<size_t>(stored_count);
+    values->resize(count);
+    if constexpr (std::is_arithmetic<T>::value) {
+        reader->read_bytes(values->data(), count * sizeof(T));
+        reader->align();
+    }
+    else {
+        for (T& value : *values) {
+            read_state(reader, &value);
+        }
+    }
+}
+
+/// @brief Сохранение массива
+template <typename T, size_t Dimension>
+inline void write_state(checkpoint_image_t* image, const std::array<T, Dimension>& values)
+{
+    for (const T& value : values) {
+        write_state(image, value);
+    }
+}
+/// @brief Восстановление массива
+template <typename T, size_t Dimension>
+inline void read_state(checkpoint_reader_t* reader, std::array<T, Dimension>* values)
+{
+    for (T& value : *values) {
+        read_state(reader, &value);
+    }
+}
+
+/// @brief Сохранение слоя профилей
+template <size_t PointScalar, size_t CellScalar, size_t PointVector, size_t PointVectorDimension,
+    size_t CellVector, size_t CellVectorDimension, typename Scalar>
+inline void write_state(checkpoint_image_t* image, const profile_collection_t<PointScalar, CellScalar,
+    PointVector, PointVectorDimension, CellVector, CellVectorDimension, Scalar>& layer)
+{
+    write_state(image, layer.point_double);
+    write_state(image, layer.cell_double);
+    write_state(image, layer.point_vector);
+    write_state(image, layer.cell_vector);
+}
+/// @brief Восстановление слоя профилей
+template <size_t PointScalar, size_t CellScalar, size_t PointVector, size_t PointVectorDimension,
+    size_t CellVector, size_t CellVectorDimension, typename Scalar>
+inline void read_state(checkpoint_reader_t* reader, profile_collection_t<PointScalar, CellScalar,
+    PointVector, PointVectorDimension, CellVector, CellVectorDimension, Scalar>* layer)
+{
+    read_state(reader, &layer->point_double);
+    read_state(reader, &layer->cell_double);
+    read_state(reader, &layer->point_vector);
+    read_state(reader, &layer->cell_vector);
+}
+
+/// @brief Сохранение составного слоя
+template <typename VarLayer, typename... SpecificLayers>
+inline void write_state(checkpoint_image_t* image, const composite_layer_t<VarLayer, SpecificLayers...>& layer)
+{
+    write_state(image, layer.vars);
+    std::apply([image](const auto&... specific) { (write_state(image, specific), ...); }, layer.specific);
+}
+/// @brief Восстановление составного слоя
+template <typename VarLayer, typename... SpecificLayers>
+inline void read_state(checkpoint_reader_t* reader, composite_layer_t<VarLayer, SpecificLayers...>* layer)
+{
+    read_state(reader, &layer->vars);
+    std::apply([reader](auto&... specific) { (read_state(reader, &specific), ...); }, layer->specific);
+}
+
+/// @brief Сохранение буфера слоев. Слои сохраняются начиная с текущего,
+/// поэтому восстановленный буфер совпадает с исходным в смысле current/previous/operator[]
+template <typename LayerType>
+inline void write_state(checkpoint_image_t* image, const ring_buffer_t<LayerType>& buffer)
+{
+    size_t layer_count = buffer.get_layers().size();
+    image->write(static_cast<uint64_t>(layer_count));
+    for (size_t offset = 0; offset < layer_count; ++offset) {
+        write_state(image, buffer[static_cast<int>(offset)]);
+    }
+}
+/// @brief Восстановление буфера слоев (количество слоев должно совпадать)
+template <typename LayerType>
+inline void read_state(checkpoint_reader_t* reader, ring_buffer_t<LayerType>* buffer)
+{
+    size_t layer_count = static_cast<size_t>(reader->read<uint64_t>());
+    if (layer_count != buffer->get_layers().size()) {
+        throw std::runtime_error("read_state: checkpoint layer count differs from buffer");
+    }
+    for (size_t offset = 0; offset < layer_count; ++offset) {
+        read_state(reader, &(*buffer)[static_cast<int>(offset)]);
+    }
+}
+
+/// @brief Сохранение буфера слоев с копированием при записи (слои начиная с текущего)
+template <typename LayerType>
+inline void write_state(checkpoint_image_t* image, const cow_ring_buffer_t<LayerType>& buffer)
+{
+    size_t layer_count = buffer.get_layer_count();
+    image->write(static_cast<uint64_t>(layer_count));
+    for (size_t offset = 0; offset < layer_count; ++offset) {
+        write_state(image, buffer[static_cast<int>(offset)]);
+    }
+}
+/// @brief Восстановление буфера слоев с копированием при записи (количество слоев должно совпадать)
+/// Восстанавливаемые слои перестают разделяться с другими буферами
+template <typename LayerType>
+inline void read_state(checkpoint_reader_t* reader, cow_ring_buffer_t<LayerType>* buffer)
+{
+    size_t layer_count = static_cast<size_t>(reader->read<uint64_t>());
+    if (layer_count != buffer->get_layer_count()) {
+        throw std::runtime_error("read_state: checkpoint layer count differs from buffer");
+    }
+    for (size_t offset = 0; offset < layer_count; ++offset) {
+        read_state(reader, &(*buffer)[static_cast<int>(offset)]);
+    }
+}
+
+/// @brief Сохранение профиля трубы
+inline void write_state(checkpoint_image_t* image, const PipeProfile& profile)
+{
+    write_state(image, profile.coordinates);
+    write_state(image, profile.heights);
+    write_state(image, profile.capacity);
+}
+/// @brief Восстановление профиля трубы
+inline void read_state(checkpoint_reader_t* reader, PipeProfile* profile)
+{
+    read_state(reader, &profile->coordinates);
+    read_state(reader, &profile->heights);
+    read_state(reader, &profile->capacity);
+}
+
+/// @brief Сохранение параметров трубы
+/// Функция гидравлического сопротивления не сохраняется (адрес функции не переносим между запусками)
+template <typename AdaptationParameters>
+inline void write_state(checkpoint_image_t* image, const pipe_properties<AdaptationParameters>& pipe)
+{
+    static_assert(std::is_trivially_copyable<AdaptationParameters>::value,
+        "write_state: adaptation parameters must be trivially copyable");
+    write_state(image, pipe.profile);
+    image->write(pipe.wall);
+    image->write(pipe.adaptation);
+}
+/// @brief Восстановление параметров трубы (функция сопротивления остается прежней)
+template <typename AdaptationParameters>
+inline void read_state(checkpoint_reader_t* reader, pipe_properties<AdaptationParameters>* pipe)
+{
+    read_state(reader, &pipe->profile);
+    pipe->wall = reader->read<pipe_wall_model_t>();
+    pipe->adaptation = reader->read<AdaptationParameters>();
+}
+
+/// @brief Хеш FNV-1a (64 бита) последовательности байт
+/// @param data Начало данных
+/// @param size Размер данных
+/// @param hash Начальное значение (для продолжения хеширования)
+inline uint64_t fnv1a_hash(const char* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+    for (size_t index = 0; index < size; ++index) {
+        hash ^= static_cast<unsigned char>(data[index]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/// @brief Файл контрольной точки
+/// Формат (little-endian): char[8] "PDECKPT1"; uint32 версия формата; uint32 длина вида;
+/// float64 момент времени; uint64 размер образа; uint64 контрольная сумма образа;
+/// вид состояния (строка); дополнение до 8 байт; образ
+namespace checkpoint_format {
+;
+/// @brief Сигнатура файла
+constexpr char magic[8] = { 'P', 'D', 'E', 'C', 'K', 'P', 'T', '1' };
+/// @brief Версия формата
+constexpr uint32_t version = 2;
+/// @brief Контрольная сумма образа
+inline uint64_t checksum(const char* data, size_t size)
+{
+    return fnv1a_hash(data, size);
+}
+}
+
+/// @brief Записывает образ в файл контрольной точки
+/// Запись идет во временный файл, который сбрасывается на диск и затем атомарно заменяет прежний;
+/// после замены на диск сбрасывается и каталог. При сбое во время записи или отключении питания
+/// сохраняется предыдущая контрольная точка
+/// @param filename Путь к файлу
+/// @param kind Вид состояния (проверяется при восстановлении)
+/// @param time Момент времени состояния
+/// @param image Образ состояния
+inline void write_checkpoint_file(const string& filename, const string& kind, double time,
+    const checkpoint_image_t& image)
+{
+    // Имя временного файла уникально для потока: одновременная запись одного и того же файла
+    // из разных потоков не портит его, последнее переименование побеждает
+    string temporary_filename = filename + "." +
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream file(temporary_filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("write_checkpoint_file: cannot open file " + temporary_filename);
+        }
+        checkpoint_image_t header;
+        header.write_bytes(checkpoint_format::magic, sizeof(checkpoint_format::magic));
+        header.write(checkpoint_format::version);
+        header.write(static_cast<uint32_t>(kind.size()));
+        header.write(time);
+        header.write(static_cast<uint64_t>(image.get_data().size()));
+        header.write(checkpoint_format::checksum(image.get_data().data(), image.get_data().size()));
+        header.write_bytes(kind.data(), kind.size());
+        header.align();
+        file.write(header.get_data().data(), header.get_data().size());
+        file.write(image.get_data().data(), image.get_data().size());
+        file.close();
+        if (!file) {
+            throw std::runtime_error("write_checkpoint_file: cannot write file " + temporary_filename);
+        }
+    }
+    detail::sync_file(temporary_filename);
+    std::filesystem::rename(temporary_filename, filename);
+    detail::sync_directory(std::filesystem::path(filename).parent_path().string());
+}
+
+/// @brief Файл контрольной точки, отображенный в память
+class checkpoint_file_t {
+    /// @brief Отображение файла
+    mapped_file_t file;
+    /// @brief Вид состояния
+    string kind;
+    /// @brief Момент времени состояния
+    double time{ 0 };
+    /// @brief Смещение образа
+    size_t image_offset{ 0 };
+    /// @brief Размер образа
+    size_t image_size{ 0 };
+public:
+    /// @brief Отображает файл в память и проверяет заголовок
+    explicit checkpoint_file_t(const string& filename)
+        : file(filename)
+    {
+        checkpoint_reader_t header(file.get_data(), file.get_size());
+        char magic[sizeof(checkpoint_format::magic)];
+        header.read_bytes(magic, sizeof(magic));
+        if (std::memcmp(magic, checkpoint_format::magic, sizeof(magic)) != 0) {
+            throw std::runtime_error("checkpoint_file_t: not a checkpoint file " + filename);
+        }
+        if (header.read<uint32_t>() != checkpoint_format::version) {
+            throw std::runtime_error("checkpoint_file_t: unsupported checkpoint version in " + filename);
+        }
+        uint32_t kind_size = header.read<uint32_t>();
+        time = header.read<double>();
+        uint64_t stored_image_size = header.read<uint64_t>();
+        uint64_t stored_checksum = header.read<uint64_t>();
+        header.check_remaining(kind_size, 1);
+        kind.resize(kind_size);
+        header.read_bytes(kind.data(), kind.size());
+        header.align();
+        image_offset = file.get_size() - header.get_remaining();
+        if (stored_image_size != header.get_remaining()) {
+            throw std::runtime_error("checkpoint_file_t: checkpoint file is truncated " + filename);
+        }
+        image_size = static_cast<size_t>(stored_image_size);
+        if (checkpoint_format::checksum(file.get_data() + image_offset, image_size) != stored_checksum) {
+            throw std::runtime_error("checkpoint_file_t: checkpoint file is corrupted " + filename);
+        }
+    }
+    /// @brief Вид состояния
+    const string& get_kind() const {
+        return kind;
+    }
+    /// @brief Момент времени состояния
+    double get_time() const {
+        return time;
+    }
+    /// @brief Чтение образа непосредственно из отображения
+    checkpoint_reader_t get_reader() const {
+        return checkpoint_reader_t(file.get_data() + image_offset, image_size);
+    }
+};
+
+/// @brief Восстанавливает состояние из файла контрольной точки
+/// @param filename Путь к файлу
+/// @param kind Ожидаемый вид состояния
+/// @param state Восстанавливаемый объект (должен иметь перегрузку read_state)
+/// @return Момент времени восстановленного состояния
+template <typename State>
+inline double load_checkpoint(const string& filename, const string& kind, State* state)
+{
+    checkpoint_file_t file(filename);
+    if (file.get_kind() != kind) {
+        throw std::runtime_error("load_checkpoint: checkpoint kind " + file.get_kind()
+            + " differs from expected " + kind);
+    }
+    checkpoint_reader_t reader = file.get_reader();
+    read_state(&reader, state);
+    if (!reader.is_finished()) {
+        throw std::runtime_error("load_checkpoint: checkpoint size differs from state size");
+    }
+    return file.get_time();
+}
+
+/// @brief Периодическое сохранение контрольных точек без остановки расчета
+/// Поток расчета только копирует состояние в свободный образ (двойная буферизация),
+/// запись на диск выполняет фоновый поток. Если предыдущая точка еще записывается,
+/// новая пропускается - расчет никогда не ждет диск
+class checkpoint_writer_t {
+    /// @brief Путь к файлу контрольной точки
+    const string filename;
+    /// @brief Вид состояния
+    const string kind;
+    /// @brief Образ, заполняемый потоком расчета
+    checkpoint_image_t spare_image;
+    /// @brief Образ, записываемый фоновым потоком
+    checkpoint_image_t pending_image;
+    /// @brief Момент времени записываемого образа
+    double pending_time{ 0 };
+    /// @brief Фоновый поток записывает pending_image
+    bool busy{ false };
+    /// @brief Признак завершения работы
+    bool stop{ false };
+    /// @brief Количество записанных контрольных точек
+    size_t written_count{ 0 };
+    /// @brief Количество пропущенных контрольных точек
+    size_t skipped_count{ 0 };
+    /// @brief Исключение, возникшее в фоновом потоке
+    std::exception_ptr error;
+
+    mutable std::mutex mutex;
+    std::condition_variable state_changed;
+    std::thread worker;
+
+private:
+    /// @brief Цикл фонового потока
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            state_changed.wait(lock, [this]() { return busy || stop; });
+            if (!busy) {
+                break;
+            }
+            lock.unlock();
+            std::exception_ptr write_error;
+            try {
+                write_checkpoint_file(filename, kind, pending_time, pending_image);
+            }
+            catch (...) {
+                write_error = std::current_exception();
+            }
+            lock.lock();
+            if (write_error) {
+                error = write_error;
+            }
+            else {
+                written_count++;
+            }
+            busy = false;
+            state_changed.notify_all();
+        }
+    }
+
+    /// @brief Пробрасывает в поток расчета исключение фонового потока (однократно)
+    void rethrow_error(std::unique_lock<std::mutex>& lock)
+    {
+        if (error) {
+            std::exception_ptr to_throw = error;
+            error = nullptr;
+            lock.unlock();
+            std::rethrow_exception(to_throw);
+        }
+    }
+
+public:
+    /// @param filename Путь к файлу контрольной точки
+    /// @param kind Вид состояния (проверяется при восстановлении load_checkpoint)
+    checkpoint_writer_t(const string& filename, const string& kind)
+        : filename(filename)
+        , kind(kind)
+    {
+        worker = std::thread(&checkpoint_writer_t::run, this);
+    }
+
+    checkpoint_writer_t(const checkpoint_writer_t&) = delete;
+    checkpoint_writer_t& operator=(const checkpoint_writer_t&) = delete;
+
+    /// @brief Дописывает последнюю контрольную точку и останавливает фоновый поток
+    ~checkpoint_writer_t()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        state_changed.notify_all();
+        worker.join();
+    }
+
+    /// @brief Сохраняет состояние в фоне
+    /// @param time Момент времени состояния
+    /// @param state Сохраняемый объект (должен иметь перегрузку write_state)
+    /// @return true, если контрольная точка поставлена на запись;
+    /// false, если пропущена из-за записи предыдущей
+    template <typename State>
+    bool save(double time, const State& state)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            rethrow_error(lock);
+            if (busy) {
+                skipped_count++;
+                return false;
+            }
+        }
+        // spare_image не используется фоновым потоком
+        spare_image.clear();
+        write_state(&spare_image, state);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::swap(spare_image, pending_image);
+            pending_time = time;
+            busy = true;
+        }
+        state_changed.notify_all();
+        return true;
+    }
+
+    /// @brief Ожидает окончания записи текущей контрольной точки
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        state_changed.wait(lock, [this]() { return !busy; });
+        rethrow_error(lock);
+    }
+
+    /// @brief Количество записанных контрольных точек
+    size_t get_written_count() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return written_count;
+    }
+    /// @brief Количество пропущенных контрольных точек
+    size_t get_skipped_count() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return skipped_count;
+    }
+};
+
+}
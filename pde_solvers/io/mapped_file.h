@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include <string>
+#include "native_file.h"
+
+namespace pde_solvers {
+;
+
+/// @brief Файл, отображенный в память только для чтения
+/// Данные доступны без копирования и разбора, пока существует объект
+class mapped_file_t {
+    /// @brief Отображение файла
+    detail::native_mapping_t mapping;
+
+public:
+    /// @brief Отображает файл в память
+    /// @param filename Путь к файлу
+    explicit mapped_file_t(const std::string& filename)
+    {
+        detail::map_file(filename, &mapping);
+    }
+
+    mapped_file_t(const mapped_file_t&) = delete;
+    mapped_file_t& operator=(const mapped_file_t&) = delete;
+
+    ~mapped_file_t()
+    {
+        detail::unmap_file(&mapping);
+    }
+
+    /// @brief Указатель на начало данных файла
+    const char* get_data() const {
+        return mapping.data;
+    }
+    /// @brief Размер файла в байтах
+    size_t get_size() const {
+        return mapping.size;
+    }
+};
+
+}
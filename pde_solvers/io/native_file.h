@@ -0,0 +1,183 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <string>
+#include <stdexcept>
+
+// Заголовки ОС подключаются только здесь. Для Windows - без редко используемых API
+// и без макросов min/max; собственные определения этих макросов не выходят за пределы файла
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define PDE_SOLVERS_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#define PDE_SOLVERS_UNDEF_NOMINMAX
+#endif
+#include <windows.h>
+#ifdef PDE_SOLVERS_UNDEF_WIN32_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef PDE_SOLVERS_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#ifdef PDE_SOLVERS_UNDEF_NOMINMAX
+#undef NOMINMAX
+#undef PDE_SOLVERS_UNDEF_NOMINMAX
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pde_solvers {
+;
+namespace detail {
+;
+
+/// @brief Отображение файла в память средствами ОС
+/// Дескрипторы хранятся в непрозрачном виде, чтобы типы ОС не попадали в интерфейс библиотеки
+struct native_mapping_t {
+    /// @brief Начало отображения (nullptr для пустого файла)
+    const char* data{ nullptr };
+    /// @brief Размер файла в байтах
+    size_t size{ 0 };
+    /// @brief Дескриптор файла (HANDLE в Windows)
+    void* file{ nullptr };
+    /// @brief Дескриптор отображения (HANDLE в Windows)
+    void* mapping{ nullptr };
+    /// @brief Дескриптор файла POSIX
+    int descriptor{ -1 };
+};
+
+/// @brief Освобождает отображение и закрывает файл
+inline void unmap_file(native_mapping_t* mapping)
+{
+#ifdef _WIN32
+    if (mapping->data != nullptr) {
+        UnmapViewOfFile(mapping->data);
+    }
+    if (mapping->mapping != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mapping->mapping));
+    }
+    if (mapping->file != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mapping->file));
+    }
+    mapping->file = nullptr;
+    mapping->mapping = nullptr;
+#else
+    if (mapping->data != nullptr) {
+        munmap(const_cast<char*>(mapping->data), mapping->size);
+    }
+    if (mapping->descriptor >= 0) {
+        ::close(mapping->descriptor);
+    }
+    mapping->descriptor = -1;
+#endif
+    mapping->data = nullptr;
+    mapping->size = 0;
+}
+
+/// @brief Отображает файл в память только для чтения
+/// При ошибке освобождает ресурсы и выбрасывает исключение
+inline void map_file(const std::string& filename, native_mapping_t* mapping)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("mapped_file_t: cannot open file " + filename);
+    }
+    mapping->file = file;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        unmap_file(mapping);
+        throw std::runtime_error("mapped_file_t: cannot get size of file " + filename);
+    }
+    size_t size = static_cast<size_t>(file_size.QuadPart);
+    if (size == 0) {
+        return;
+    }
+    HANDLE file_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (file_mapping == nullptr) {
+        unmap_file(mapping);
+        throw std::runtime_error("mapped_file_t: cannot map file " + filename);
+    }
+    mapping->mapping = file_mapping;
+    mapping->data = static_cast<const char*>(MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (mapping->data == nullptr) {
+        unmap_file(mapping);
+        throw std::runtime_error("mapped_file_t: cannot map file " + filename);
+    }
+    mapping->size = size;
+#else
+    mapping->descriptor = ::open(filename.c_str(), O_RDONLY);
+    if (mapping->descriptor < 0) {
+        throw std::runtime_error("mapped_file_t: cannot open file " + filename);
+    }
+    struct stat file_status;
+    if (fstat(mapping->descriptor, &file_status) != 0) {
+        unmap_file(mapping);
+        throw std::runtime_error("mapped_file_t: cannot get size of file " + filename);
+    }
+    size_t size = static_cast<size_t>(file_status.st_size);
+    if (size == 0) {
+        return;
+    }
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, mapping->descriptor, 0);
+    if (data == MAP_FAILED) {
+        unmap_file(mapping);
+        throw std::runtime_error("mapped_file_t: cannot map file " + filename);
+    }
+    mapping->data = static_cast<const char*>(data);
+    mapping->size = size;
+#endif
+}
+
+/// @brief Сбрасывает данные файла на диск (fsync, FlushFileBuffers)
+inline void sync_file(const std::string& filename)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("sync_file: cannot open file " + filename);
+    }
+    BOOL flushed = FlushFileBuffers(file);
+    CloseHandle(file);
+    if (!flushed) {
+        throw std::runtime_error("sync_file: cannot flush file " + filename);
+    }
+#else
+    int descriptor = ::open(filename.c_str(), O_RDWR);
+    if (descriptor < 0) {
+        throw std::runtime_error("sync_file: cannot open file " + filename);
+    }
+    int result = ::fsync(descriptor);
+    ::close(descriptor);
+    if (result != 0) {
+        throw std::runtime_error("sync_file: cannot flush file " + filename);
+    }
+#endif
+}
+
+/// @brief Сбрасывает на диск запись каталога (созданные, переименованные файлы)
+/// В Windows метаданные каталога сбрасываются файловой системой, функция ничего не делает
+inline void sync_directory(const std::string& path)
+{
+#ifndef _WIN32
+    int descriptor = ::open(path.empty() ? "." : path.c_str(), O_RDONLY | O_DIRECTORY);
+    if (descriptor < 0) {
+        throw std::runtime_error("sync_directory: cannot open directory " + path);
+    }
+    int result = ::fsync(descriptor);
+    ::close(descriptor);
+    if (result != 0) {
+        throw std::runtime_error("sync_directory: cannot flush directory " + path);
+    }
+#endif
+}
+
+}
+}
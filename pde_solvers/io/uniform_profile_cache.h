@@ -0,0 +1,117 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include "checkpoint.h"
+#include "mapped_file.h"
+#include "../core/thread_pool.h"
+
+namespace pde_solvers {
+;
+
+/// @brief Настройки пакетной подготовки профилей с постоянным шагом
+struct uniform_profile_batch_settings_t {
+    /// @brief Желаемый постоянный шаг по координате
+    double desired_segment{ 100 };
+    /// @brief Несущая способность (в файлах профилей ее нет)
+    double capacity_value{ 10e6 };
+    /// @brief Папка кэша готовых профилей. Пустая строка - без кэша
+    string cache_folder;
+    /// @brief Количество потоков, если пул не передан (по умолчанию - количество аппаратных потоков)
+    size_t thread_count{ std::thread::hardware_concurrency() };
+};
+
+/// @brief Пакетная подготовка профилей с постоянным шагом по файлам высоток (формат km;m)
+/// Файлы разбираются и профили строятся параллельно на пуле потоков.
+/// Готовые профили сохраняются в кэш (файлы контрольных точек) с ключом из хеша содержимого
+/// исходного файла, шага и несущей способности. При повторном запуске с неизмененными файлами
+/// профиль читается из кэша без разбора и построения; измененный файл дает другой ключ
+/// @param filenames Пути к файлам профилей
+/// @param settings Настройки подготовки
+/// @param pool Пул потоков. Если не задан, создается временный пул на settings.thread_count потоков
+/// @param _cache_hits Количество профилей, взятых из кэша (необязательно)
+/// @return Профили в порядке файлов
+inline vector<PipeProfile> prepare_uniform_profiles(const vector<string>& filenames,
+    const uniform_profile_batch_settings_t& settings, thread_pool_t* pool = nullptr,
+    size_t* _cache_hits = nullptr)
+{
+    std::unique_ptr<thread_pool_t> own_pool;
+    if (pool == nullptr) {
+        own_pool = std::make_unique<thread_pool_t>(settings.thread_count);
+        pool = own_pool.get();
+    }
+    if (!settings.cache_folder.empty()) {
+        std::filesystem::create_directories(settings.cache_folder);
+    }
+
+    // Повторяющиеся файлы обрабатываются один раз (в том числе чтобы не писать один файл кэша дважды)
+    vector<string> unique_filenames;
+    vector<size_t> file_index(filenames.size());
+    std::map<string, size_t> known_files;
+    for (size_t index = 0; index < filenames.size(); ++index) {
+        auto [known, inserted] = known_files.emplace(filenames[index], unique_filenames.size());
+        if (inserted) {
+            unique_filenames.push_back(filenames[index]);
+        }
+        file_index[index] = known->second;
+    }
+
+    vector<PipeProfile> unique_profiles(unique_filenames.size());
+    std::atomic<size_t> cache_hits{ 0 };
+
+    pool->parallel_for(unique_filenames.size(), [&](size_t index) {
+        mapped_file_t file(unique_filenames[index]);
+        if (settings.cache_folder.empty()) {
+            vector<vector<double>> coord_heights =
+                parse_coordinates_and_heights(file.get_data(), file.get_size());
+            unique_profiles[index] = pipe_profile_uniform::get_uniform_profile(
+                coord_heights, settings.desired_segment, settings.capacity_value);
+            return;
+        }
+
+        uint64_t source_hash = fnv1a_hash(file.get_data(), file.get_size());
+        char kind[128];
+        std::snprintf(kind, sizeof(kind), "uniform_profile %016llx %.17g %.17g",
+            static_cast<unsigned long long>(source_hash), settings.desired_segment, settings.capacity_value);
+        char cache_name[32];
+        std::snprintf(cache_name, sizeof(cache_name), "%016llx.profile",
+            static_cast<unsigned long long>(fnv1a_hash(kind, std::strlen(kind))));
+        string cache_filename = (std::filesystem::path(settings.cache_folder) / cache_name).string();
+
+        if (std::filesystem::exists(cache_filename)) {
+            try {
+                load_checkpoint(cache_filename, kind, &unique_profiles[index]);
+                cache_hits++;
+                return;
+            }
+            catch (const std::runtime_error&) {
+                // Поврежденный файл или совпадение хеша имени - профиль строится заново
+            }
+        }
+
+        vector<vector<double>> coord_heights =
+            parse_coordinates_and_heights(file.get_data(), file.get_size());
+        unique_profiles[index] = pipe_profile_uniform::get_uniform_profile(
+            coord_heights, settings.desired_segment, settings.capacity_value);
+
+        checkpoint_image_t image;
+        write_state(&image, unique_profiles[index]);
+        write_checkpoint_file(cache_filename, kind, 0, image);
+    });
+
+    if (_cache_hits != nullptr) {
+        *_cache_hits = cache_hits;
+    }
+
+    vector<PipeProfile> profiles(filenames.size());
+    for (size_t index = 0; index < filenames.size(); ++index) {
+        profiles[index] = unique_profiles[file_index[index]];
+    }
+    return profiles;
+}
+
+}
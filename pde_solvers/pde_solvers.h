@@ -13,9 +13,13 @@
 #include "core/ring_buffer.h"
 #include "core/differential_equation.h"
 #include "core/profile_structures.h"
+#include "core/thread_pool.h"
+#include "core/domain_decomposition.h"
+#include "core/instrumentation.h"
 
 #include "solvers/moc_solver.h"
 #include "solvers/ode_solver.h"
+#include "solvers/incremental_ode_solver.h"
 #include "solvers/godunov_solver.h"
 #include "solvers/quick_solver.h"
 
@@ -24,10 +28,18 @@
 #include "pipe/pipe_hydraulic_computations.h"
 #include "pipe/pipe_hydraulic_struct.h"
 #include "pipe/pipe_hydraulic_pde.h"
+#include "pipe/pipe_batch_hydraulics.h"
 #include "pipe/pipe_profile_utils.h"
 #include "pipe/pipe_advection_pde.h"
 #include "pipe/pipe_advection_solver.h"
 
 #include "solvers/diffusion_solver.h" // нужно инклудить после объявления трубы и проч.
 
+#include "io/async_layer_writer.h"
+#include "io/binary_profile_format.h"
+#include "io/checkpoint.h"
+#include "io/uniform_profile_cache.h"
+
 #include "tasks/isothermal_quasistatic_task.h"
+#include "tasks/isothermal_quasistatic_network_task.h"
+#include "tasks/quasistatic_simulation.h"
@@ -10,5 +10,6 @@
 #include <pipe/pipe_hydraulic_computations.h>
 #include <pipe/pipe_hydraulic_struct.h>
 #include <pipe/pipe_hydraulic_pde.h>
+#include <pipe/pipe_batch_hydraulics.h>
 #include <pipe/pipe_profile_utils.h>
 
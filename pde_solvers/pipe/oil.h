@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+#include <cstdint>
+#include <cstring>
+
 /// @brief Точка вискограммы
 struct viscosity_data_point {
     double temperature;
@@ -181,7 +184,7 @@ struct viscosity_table_model_t {
         double nu2div3 = v[1] / v[2];
         double nu3div1 = v[2] / v[0];
 
-        if (abs(nu3div1 - 1) < eps1 && abs(nu2div3 - 1) < eps1) {
+        if (std::abs(nu3div1 - 1) < eps1 && std::abs(nu2div3 - 1) < eps1) {
             // Вязкость = const
             coeffs[0] = v[0];
             return coeffs;
@@ -189,7 +192,7 @@ struct viscosity_table_model_t {
 
         double a = a1 * lognu1div2 / log(nu2div3); // похоже, a > 1
 
-        if (abs(a - 1) < eps2) {
+        if (std::abs(a - 1) < eps2) {
             // Филонов-Рейнольс
             coeffs[0] = v[1]; // при двадцати градусах
 
@@ -235,6 +238,197 @@ struct viscosity_table_model_t {
 
 
 
+/// @brief Аппроксимации вязкости для профиля (партии в каждой точке/ячейке) в виде структуры массивов
+/// Все три модели viscosity_table_model_t приводятся к общему виду
+///     nu = scale * exp(b / (T - theta) - k * (T - T_20)),
+/// где для Фогеля-Фульчера-Таммана k = 0, для Филонова-Рейнольдса b = 0, для константы b = k = 0.
+/// Поэтому расчет профиля вязкости не ветвится по моделям и векторизуется
+struct viscosity_table_profile_t {
+    /// @brief Вид модели в точке профиля
+    static constexpr unsigned char model_constant = 0;
+    static constexpr unsigned char model_filonov_reynolds = 1;
+    static constexpr unsigned char model_vft = 2;
+
+    /// @brief Вид модели (model_constant, model_filonov_reynolds, model_vft)
+    vector<unsigned char> model;
+    /// @brief Множитель (nu_inf для ФФТ, вязкость при 20 градусах для Филонова-Рейнольдса, константа)
+    vector<double> scale;
+    /// @brief Параметр b модели ФФТ
+    vector<double> b;
+    /// @brief Параметр theta модели ФФТ, K
+    vector<double> theta;
+    /// @brief Температурный коэффициент модели Филонова-Рейнольдса, 1/K
+    vector<double> k;
+
+    viscosity_table_profile_t() = default;
+    /// @brief Профиль из point_count точек (коэффициенты не заданы)
+    viscosity_table_profile_t(size_t point_count)
+        : model(point_count)
+        , scale(point_count)
+        , b(point_count)
+        , theta(point_count)
+        , k(point_count)
+    {
+    }
+
+    /// @brief Количество точек профиля
+    size_t size() const {
+        return scale.size();
+    }
+
+    /// @brief Записывает в точку index аппроксимацию, полученную viscosity_table_model_t::reconstruct
+    void set_approximation(size_t index, const array<double, 3>& coeffs)
+    {
+        if (!std::isnan(coeffs[2])) {
+            model[index] = model_vft;
+            scale[index] = coeffs[0];
+            theta[index] = coeffs[1];
+            b[index] = coeffs[2];
+            k[index] = 0;
+        }
+        else if (!std::isnan(coeffs[1])) {
+            model[index] = model_filonov_reynolds;
+            scale[index] = coeffs[0];
+            theta[index] = 0;
+            b[index] = 0;
+            k[index] = coeffs[1];
+        }
+        else {
+            model[index] = model_constant;
+            scale[index] = coeffs[0];
+            theta[index] = 0;
+            b[index] = 0;
+            k[index] = 0;
+        }
+    }
+
+    /// @brief Профиль по уже восстановленным аппроксимациям (см. fluid_properties_profile_t)
+    static viscosity_table_profile_t from_approximations(const vector<array<double, 3>>& approximations)
+    {
+        viscosity_table_profile_t result(approximations.size());
+        for (size_t index = 0; index < approximations.size(); ++index) {
+            result.set_approximation(index, approximations[index]);
+        }
+        return result;
+    }
+
+    /// @brief Восстанавливает аппроксимации по таблицам вязкости точек профиля
+    /// Партия занимает непрерывный участок профиля с одинаковой таблицей, поэтому
+    /// viscosity_table_model_t::reconstruct вызывается один раз на участок, а не в каждой точке
+    static viscosity_table_profile_t reconstruct(const vector<array<double, 3>>& viscosity_tables)
+    {
+        viscosity_table_profile_t result(viscosity_tables.size());
+        for (size_t index = 0; index < viscosity_tables.size(); ++index) {
+            if (index > 0 && viscosity_tables[index] == viscosity_tables[index - 1]) {
+                result.model[index] = result.model[index - 1];
+                result.scale[index] = result.scale[index - 1];
+                result.b[index] = result.b[index - 1];
+                result.theta[index] = result.theta[index - 1];
+                result.k[index] = result.k[index - 1];
+            }
+            else {
+                result.set_approximation(index, viscosity_table_model_t::reconstruct(viscosity_tables[index]));
+            }
+        }
+        return result;
+    }
+
+#if (defined(__SSE4_2__) || defined(__AVX2__) || defined(__aarch64__)) && !defined(_MSC_VER)
+    /// @brief Признак расчета профиля через exp без ветвлений: для его векторизации нужны
+    /// сравнения 64-битных целых в векторных регистрах (SSE4.2, AVX2, NEON). Без них скалярный
+    /// полином медленнее std::exp, а MSVC векторизует цикл с std::exp сам
+    static constexpr bool use_branchless_exp = true;
+#else
+    static constexpr bool use_branchless_exp = false;
+#endif
+
+    /// @brief Экспонента без ветвлений (векторизуется компилятором), относительная погрешность ~1e-15
+    /// Вне диапазона [-708, 709], где результат - нормализованное число, возвращает 0 и бесконечность
+    static inline double exp(double x)
+    {
+        constexpr double log2e = 1.4426950408889634;
+        constexpr double ln2_hi = 6.93147180369123816490e-01;
+        constexpr double ln2_lo = 1.90821492927058770002e-10;
+        constexpr double shifter = 6755399441055744.0; // 1.5 * 2^52: младшие биты мантиссы = целое число
+
+        double shifted = x * log2e + shifter;
+        double n = shifted - shifter; // round(x / ln2)
+        double r = (x - n * ln2_hi) - n * ln2_lo; // |r| <= ln2 / 2
+
+        // Ряд Тейлора до r^13 (остаток < 2e-16 при |r| <= ln2 / 2)
+        double p = 1.0 / 6227020800.0;
+        p = p * r + 1.0 / 479001600.0;
+        p = p * r + 1.0 / 39916800.0;
+        p = p * r + 1.0 / 3628800.0;
+        p = p * r + 1.0 / 362880.0;
+        p = p * r + 1.0 / 40320.0;
+        p = p * r + 1.0 / 5040.0;
+        p = p * r + 1.0 / 720.0;
+        p = p * r + 1.0 / 120.0;
+        p = p * r + 1.0 / 24.0;
+        p = p * r + 1.0 / 6.0;
+        p = p * r + 0.5;
+        p = p * r + 1.0;
+        p = p * r + 1.0;
+
+        // 2^n собирается непосредственно в битах порядка
+        uint64_t shifted_bits;
+        uint64_t shifter_bits;
+        std::memcpy(&shifted_bits, &shifted, sizeof(double));
+        std::memcpy(&shifter_bits, &shifter, sizeof(double));
+        uint64_t scale_bits = (shifted_bits - shifter_bits + 1023) << 52;
+        double scale;
+        std::memcpy(&scale, &scale_bits, sizeof(double));
+
+        // Результат вне диапазона заменяется битовыми масками, а не условными операторами:
+        // условия компилятор превращает в ветвления, и цикл не векторизуется
+        double result = p * scale;
+        constexpr double infinity = std::numeric_limits<double>::infinity();
+        uint64_t result_bits;
+        uint64_t infinity_bits;
+        std::memcpy(&result_bits, &result, sizeof(double));
+        std::memcpy(&infinity_bits, &infinity, sizeof(double));
+        uint64_t underflow_mask = x < -708.0 ? ~uint64_t(0) : uint64_t(0);
+        uint64_t overflow_mask = x > 709.0 ? ~uint64_t(0) : uint64_t(0);
+        result_bits &= ~underflow_mask;
+        result_bits = (result_bits & ~overflow_mask) | (infinity_bits & overflow_mask);
+        std::memcpy(&result, &result_bits, sizeof(double));
+        return result;
+    }
+
+    /// @brief Вязкость в точке профиля
+    /// @param index Индекс точки
+    /// @param temperature Температура, K
+    double calc(size_t index, double temperature) const
+    {
+        return scale[index] * std::exp(b[index] / (temperature - theta[index])
+            - k[index] * (temperature - viscosity_table_model_t::viscosity_temperatures[1]));
+    }
+
+    /// @brief Профиль вязкости по профилю температуры (один цикл без ветвлений по моделям,
+    /// векторизуется при use_branchless_exp)
+    /// @param temperature Профиль температуры, K
+    /// @param viscosity Профиль вязкости (размер как у temperature)
+    void calc(const vector<double>& temperature, vector<double>* viscosity) const
+    {
+        if (temperature.size() != size() || viscosity->size() != size()) {
+            throw std::runtime_error("Viscosity table profile, temperature and viscosity sizes must be equal");
+        }
+        constexpr double T_20 = viscosity_table_model_t::viscosity_temperatures[1];
+        const double* T = temperature.data();
+        const double* scale_data = scale.data();
+        const double* b_data = b.data();
+        const double* theta_data = theta.data();
+        const double* k_data = k.data();
+        double* result = viscosity->data();
+        for (size_t index = 0; index < size(); ++index) {
+            double x = b_data[index] / (T[index] - theta_data[index]) - k_data[index] * (T[index] - T_20);
+            result[index] = scale_data[index] * (use_branchless_exp ? exp(x) : std::exp(x));
+        }
+    }
+};
+
+
 /// @brief Динамические (пересчитываемые в процессе расчета) параметры нефти
 /// @tparam DataBuffer Задается vector<double> для профилей, double для точечного случая
 template <typename BufferDensity, typename BufferViscosity>
@@ -5,16 +5,22 @@ namespace pde_solvers {
 /// @brief Решатель транспортного уравнения методом характеристик, 
 /// при этом считается, что скорость по длине трубопровода постоянна,
 /// а число Куранта всегда равно единице
-class advection_moc_solver
+/// @tparam Scalar Тип значений профиля (float для расчета партий - вдвое меньше памяти,
+/// интерполяция между соседними точками выполняется в этом же типе)
+template <typename Scalar>
+class advection_moc_solver_t
 {
 public:
+    /// @brief Тип значений профиля
+    typedef Scalar scalar_type;
+
     /// @brief Конструктор транспортного солвера
     /// @param pipe Параметры трубопровода 
     /// @param vol_flow Объёмный расход
     /// @param prev Предыдущий слой
     /// @param next Новый слой
-    advection_moc_solver(const pipe_properties_t& pipe, double vol_flow,
-        vector<double>& prev, vector<double>& next)
+    advection_moc_solver_t(const pipe_properties_t& pipe, double vol_flow,
+        const vector<Scalar>& prev, vector<Scalar>& next)
         : pipe{ pipe }
         , volumetric_flow{ vol_flow }
         , prev{ prev }
@@ -25,18 +31,24 @@ public:
     /// @param dt Шаг моделирования
     /// @param par_in Значение параметра среды, втекающей в начало трубопровода
     /// @param par_out Значение параметра среды, втекающей в конец трубопровода при обратном течении
-    void step(const double dt,const double par_in, const double par_out)
+    /// @param decomposition Разбиение сетки для параллельного расчета (nullptr - последовательный расчет)
+    void step(const double dt,const double par_in, const double par_out,
+        const domain_decomposition_t* decomposition = nullptr)
     {
-        double p = interpolation_offset(dt);
+        Scalar p = static_cast<Scalar>(interpolation_offset(dt));
 
         int direction = get_eigen_value() > 0 ? 1 : -1;
         size_t start_index = direction > 0 ? 1 : (next.size()) - 2;
-        size_t end_index = direction < 0 ? -1 : next.size();
-        next[start_index - direction] = direction > 0 ? par_in : par_out;
-        for (size_t index = start_index; index != end_index; index += direction)
-        {
-            next[index] = prev[index - direction] * p + prev[index] * (1 - p);
-        }
+        next[start_index - direction] = static_cast<Scalar>(direction > 0 ? par_in : par_out);
+        // Точки рассчитываются независимо по предыдущему слою, порядок обхода не важен
+        size_t index_begin = direction > 0 ? 1 : 0;
+        size_t index_end = direction > 0 ? next.size() : next.size() - 1;
+        for_each_subdomain(decomposition, index_begin, index_end, [&](size_t subdomain_begin, size_t subdomain_end) {
+            for (size_t index = subdomain_begin; index < subdomain_end; ++index)
+            {
+                next[index] = prev[index - direction] * p + prev[index] * (1 - p);
+            }
+        });
     }
 
     /// @brief Расчёт шага по времени, при котором Курант равен единице (Cr = 1)
@@ -48,7 +60,7 @@ public:
         double dx = grid[1] - grid[0];
         double courant_step = dx / max_eigen;
 
-        return abs(courant_step);
+        return std::abs(courant_step);
     }
 
 protected:
@@ -58,9 +70,9 @@ protected:
     /// @brief Объемный расход
     const double volumetric_flow;
     /// @brief Предыдущий слой
-    vector<double>& prev;
+    const vector<Scalar>& prev;
     /// @brief Новый слой
-    vector<double>& next;
+    vector<Scalar>& next;
 
 
     /// @brief Расчёт собственного значения
@@ -78,5 +90,15 @@ protected:
     }
 };
 
+/// @brief Солвер advection_moc_solver_t для профилей в double
+typedef advection_moc_solver_t<double> advection_moc_solver;
+
+/// @brief Признак солвера партий методом характеристик (партии в точках, а не в ячейках)
+template <typename Solver>
+struct is_advection_moc_solver : std::false_type {};
+
+template <typename Scalar>
+struct is_advection_moc_solver<advection_moc_solver_t<Scalar>> : std::true_type {};
+
 
 }
\ No newline at end of file
@@ -0,0 +1,211 @@
+﻿#pragma once
+
+namespace pde_solvers {
+;
+
+/// @brief Однородный участок трубы, занятый одной партией
+struct batch_segment_t {
+    /// @brief Координата начала участка, м (конец - начало следующего участка или конец трубы)
+    double begin;
+    /// @brief Плотность, кг/м3
+    double density;
+    /// @brief Кинематическая вязкость, м2/с
+    double viscosity;
+};
+
+/// @brief Кусочно-аналитический стационарный гидравлический расчет трубы по однородным участкам партий
+/// В пределах партии плотность и вязкость постоянны, поэтому при заданном расходе градиент давления
+/// от трения на участке постоянен, а перепад давления от подъема зависит только от высот на концах участка.
+/// Поэтому давление на выходе (solve_PQ, solve_QP) и расход по давлениям (solve_PP) рассчитываются
+/// за O(количество партий) независимо от шага сетки, а гидравлическое сопротивление
+/// (pipe.resistance_function) вычисляется один раз на партию.
+/// Профиль давления в точках сетки (calc_pressure_profile) - за O(партии + точки профиля высот).
+/// При границах партий в точках сетки совпадает с методом Эйлера для isothermal_pipe_PQ_parties_t
+/// с партиями в ячейках до ошибок округления
+class batch_hydraulic_solver_t {
+    /// @brief Параметры трубы
+    const pipe_properties_t& pipe;
+    /// @brief Участки партий по ходу трубы
+    vector<batch_segment_t> batches;
+    /// @brief Длины участков, м
+    vector<double> lengths;
+    /// @brief Высоты в начале участков, м
+    vector<double> begin_heights;
+    /// @brief Перепад давления на всей трубе от подъема жидкости, Па: g * sum(rho_k * dz_k)
+    double elevation_drop{ 0 };
+
+private:
+    /// @brief Высота в произвольной координате трубы (линейная интерполяция профиля), O(log n)
+    double get_height(double coordinate) const
+    {
+        const vector<double>& coordinates = pipe.profile.coordinates;
+        const vector<double>& heights = pipe.profile.heights;
+        if (coordinate <= coordinates.front()) {
+            return heights.front();
+        }
+        if (coordinate >= coordinates.back()) {
+            return heights.back();
+        }
+        size_t index = std::upper_bound(coordinates.begin(), coordinates.end(), coordinate)
+            - coordinates.begin() - 1;
+        double alpha = (coordinate - coordinates[index]) / (coordinates[index + 1] - coordinates[index]);
+        return linear_interpolation(heights[index], heights[index + 1], alpha);
+    }
+    /// @brief Перепад давления от трения на всей трубе, Па
+    double get_friction_drop(double flow) const
+    {
+        double result = 0;
+        for (size_t batch = 0; batch < batches.size(); ++batch) {
+            result += get_friction_gradient(batch, flow) * lengths[batch];
+        }
+        return result;
+    }
+
+public:
+    /// @brief Расчет по участкам партий
+    /// @param pipe Параметры трубы (должны жить дольше солвера)
+    /// @param batches Участки партий по возрастанию координат; первый участок начинается в начале трубы
+    batch_hydraulic_solver_t(const pipe_properties_t& pipe, vector<batch_segment_t> batches)
+        : pipe(pipe)
+        , batches(std::move(batches))
+    {
+        const vector<batch_segment_t>& segments = this->batches;
+        if (segments.empty()) {
+            throw std::runtime_error("batch_hydraulic_solver_t: no batches");
+        }
+        if (segments.front().begin != pipe.profile.coordinates.front()) {
+            throw std::runtime_error("batch_hydraulic_solver_t: first batch does not begin at pipe start");
+        }
+        double pipe_end = pipe.profile.coordinates.back();
+        lengths.resize(segments.size());
+        begin_heights.resize(segments.size());
+        double end_height = pipe.profile.heights.back();
+        for (size_t batch = 0; batch < segments.size(); ++batch) {
+            double end = batch + 1 < segments.size() ? segments[batch + 1].begin : pipe_end;
+            if (end < segments[batch].begin) {
+                throw std::runtime_error("batch_hydraulic_solver_t: batches are not sorted");
+            }
+            lengths[batch] = end - segments[batch].begin;
+            begin_heights[batch] = get_height(segments[batch].begin);
+        }
+        for (size_t batch = 0; batch < segments.size(); ++batch) {
+            double height_difference = (batch + 1 < segments.size() ? begin_heights[batch + 1] : end_height)
+                - begin_heights[batch];
+            elevation_drop += segments[batch].density * M_G * height_difference;
+        }
+    }
+
+    /// @brief Участки партий по профилям плотности и вязкости
+    /// Соседние точки (ячейки) с одинаковыми плотностью и вязкостью объединяются в один участок.
+    /// Для партий в ячейках границы участков - точки сетки, для партий в точках - середины между точками
+    template <typename Scalar>
+    static vector<batch_segment_t> get_batches(const pipe_properties_t& pipe,
+        const vector<Scalar>& density, const vector<Scalar>& viscosity)
+    {
+        const vector<double>& coordinates = pipe.profile.coordinates;
+        bool in_points = density.size() == coordinates.size();
+        if ((!in_points && density.size() + 1 != coordinates.size()) || viscosity.size() != density.size()) {
+            throw std::runtime_error("batch_hydraulic_solver_t: rheology profile size mismatch");
+        }
+        vector<batch_segment_t> result;
+        for (size_t index = 0; index < density.size(); ++index) {
+            if (index > 0 && density[index] == density[index - 1] && viscosity[index] == viscosity[index - 1]) {
+                continue;
+            }
+            double begin = index == 0
+                ? coordinates.front()
+                : in_points ? 0.5 * (coordinates[index - 1] + coordinates[index]) : coordinates[index];
+            result.push_back({ begin, static_cast<double>(density[index]), static_cast<double>(viscosity[index]) });
+        }
+        return result;
+    }
+
+    /// @brief Участки партий
+    const vector<batch_segment_t>& get_batches() const {
+        return batches;
+    }
+
+    /// @brief Градиент давления от трения на участке партии, Па/м (положителен при положительном расходе)
+    /// @param batch Индекс участка
+    /// @param flow Объемный расход, м3/с
+    double get_friction_gradient(size_t batch, double flow) const
+    {
+        double rho = batches[batch].density;
+        double v = flow / pipe.wall.getArea();
+        double Re = v * pipe.wall.diameter / batches[batch].viscosity;
+        double lambda = pipe.resistance_function(Re, pipe.wall.relativeRoughness());
+        double tau_w = lambda / 8 * rho * v * std::abs(v);
+        return 4 * tau_w / pipe.wall.diameter;
+    }
+
+    /// @brief Давление на выходе по давлению на входе и расходу, O(партии)
+    double solve_PQ(double pressure_in, double flow) const
+    {
+        return pressure_in - get_friction_drop(flow) - elevation_drop;
+    }
+
+    /// @brief Давление на входе по давлению на выходе и расходу, O(партии)
+    double solve_QP(double pressure_out, double flow) const
+    {
+        return pressure_out + get_friction_drop(flow) + elevation_drop;
+    }
+
+    /// @brief Расход по давлениям на входе и выходе методом Ньютона; невязка - O(партии)
+    /// @return Объемный расход, м3/с
+    double solve_PP(double pressure_in, double pressure_out) const
+    {
+        double friction_drop = pressure_in - pressure_out - elevation_drop;
+
+        // Начальное приближение - квадратичное трение с lambda = 0.02 по всем участкам
+        double S_0 = pipe.wall.getArea();
+        double quadratic_drop = 0; // перепад давления от трения при v = 1 м/с
+        for (size_t batch = 0; batch < batches.size(); ++batch) {
+            quadratic_drop += 0.02 / pipe.wall.diameter * batches[batch].density / 2 * lengths[batch];
+        }
+        double initial_flow = S_0 * sgn(friction_drop) * sqrt(std::abs(friction_drop) / quadratic_drop);
+
+        auto g = [&](double Q)
+        {
+            PDE_SOLVERS_COUNT(newton_iterations, 1);
+            return friction_drop - get_friction_drop(Q);
+        };
+        fixed_scalar_wrapper_t f(g, 1e-3 * S_0);
+
+        fixed_solver_parameters_t<1, 0> parameters;
+        parameters.constraints.relative_boundary = 50; // ограничение на шаг по расходу
+        fixed_solver_result_t<1> result;
+        fixed_newton_raphson<1>::solve_dense(f, { initial_flow }, parameters, &result);
+
+        return result.argument;
+    }
+
+    /// @brief Профиль давления в точках сетки трубы, O(партии + точки)
+    /// Внутри партии давление меняется линейно по координате от трения и по высотам профиля от подъема
+    /// @param pressure_in Давление на входе, Па
+    /// @param flow Объемный расход, м3/с
+    /// @param pressure Профиль давления (размер - количество точек сетки)
+    void calc_pressure_profile(double pressure_in, double flow, vector<double>* pressure) const
+    {
+        const vector<double>& coordinates = pipe.profile.coordinates;
+        const vector<double>& heights = pipe.profile.heights;
+        pressure->resize(coordinates.size());
+
+        size_t batch = 0;
+        double batch_pressure = pressure_in; // давление в начале участка batch
+        double friction_gradient = get_friction_gradient(batch, flow);
+        for (size_t index = 0; index < coordinates.size(); ++index) {
+            double x = coordinates[index];
+            while (batch + 1 < batches.size() && batches[batch + 1].begin <= x) {
+                batch_pressure -= friction_gradient * lengths[batch]
+                    + batches[batch].density * M_G * (begin_heights[batch + 1] - begin_heights[batch]);
+                batch++;
+                friction_gradient = get_friction_gradient(batch, flow);
+            }
+            (*pressure)[index] = batch_pressure
+                - friction_gradient * (x - batches[batch].begin)
+                - batches[batch].density * M_G * (heights[index] - begin_heights[batch]);
+        }
+    }
+};
+
+}
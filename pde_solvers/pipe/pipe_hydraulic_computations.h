@@ -78,8 +78,10 @@ template <typename PipeModel>
 inline double solve_pipe_PP(PipeModel& model, double Pin, double Pout,
     profile_wrapper<double, 2>* layer)
 {
+    PDE_SOLVERS_TIME_PHASE(solve_pipe_PP);
     auto g = [&](double G)
     {
+        PDE_SOLVERS_COUNT(newton_iterations, 1);
         solve_euler_corrector<2>(model, -1, { Pout, G }, layer);
         double Pin_calc = layer->profile(0).front();
         return Pin - Pin_calc;
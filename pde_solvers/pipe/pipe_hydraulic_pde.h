@@ -72,7 +72,7 @@ public:
         double v = G / (rho * S_0);
         double Re = v * pipe.wall.diameter / oil.viscosity();
         double lambda = pipe.resistance_function(Re, pipe.wall.relativeRoughness());
-        double tau_w = lambda / 8 * rho * v * abs(v);
+        double tau_w = lambda / 8 * rho * v * std::abs(v);
         double s1 = -M_PI * pipe.wall.diameter * tau_w;
 
         var_type s = { 0, s1 };
@@ -324,7 +324,7 @@ public:
 
         double lambda = pipe.resistance_function(Re, pipe.wall.relativeRoughness());
         //double lambda = hydraulic_resistance_shifrinson(Re, pipe.wall.relativeRoughness());
-        double tau_w = lambda / 8 * rho * v * abs(v);
+        double tau_w = lambda / 8 * rho * v * std::abs(v);
         double s1 = -M_PI * pipe.wall.diameter * tau_w;
 
         var_type s = { 0, s1 };
@@ -425,7 +425,7 @@ public:
         double Re = v * d / oil.get_viscosity(grid_index, T);
         double lambda = pipe.resistance_function(Re, pipe.wall.relativeRoughness());
         lambda *= pipe.adaptation.friction;
-        double tau_w = lambda / 8 * rho * v * abs(v);
+        double tau_w = lambda / 8 * rho * v * std::abs(v);
 
         double height_gradient; // dz/dx
         double density_gradient; // d(\rho)/dx
@@ -446,7 +446,7 @@ public:
         }
 
         double s1 =
-            2 * S_0 * v * abs(v) / rho * density_gradient
+            2 * S_0 * v * std::abs(v) / rho * density_gradient
             - M_PI * d * tau_w / rho
             - M_G * S_0 * height_gradient;
 
@@ -477,6 +477,8 @@ public:
 
 /// @brief Уравнение трубы для задачи PQ с учетом движения партий
 /// Учитывается, что параметры партий могут задавать в точках, и в ячейках
+/// Профили партий могут храниться в типе Scalar (например, float), интегрирование давления - в double
+template <typename Scalar = double>
 class isothermal_pipe_PQ_parties_t : public ode_t<1>
 {
 public:
@@ -484,8 +486,8 @@ public:
     using ode_t<1>::right_party_type;
     using ode_t<1>::var_type;
 protected:
-    const vector<double>& rho_profile;
-    const vector<double>& nu_profile;
+    const vector<Scalar>& rho_profile;
+    const vector<Scalar>& nu_profile;
     const pipe_properties_t& pipe;
     const double flow;
     const int solver_direction;
@@ -496,7 +498,7 @@ public:
     /// @param oil Ссылка на сущность нефти
     /// @param flow Объемный расход
     /// @param solver_direction Направление расчета по Эйлеру, должно обязательно совпадать с параметром солвера Эйлера
-    isothermal_pipe_PQ_parties_t(const pipe_properties_t& pipe, const vector<double>& rho_profile, const vector<double>& nu_profile, double flow,
+    isothermal_pipe_PQ_parties_t(const pipe_properties_t& pipe, const vector<Scalar>& rho_profile, const vector<Scalar>& nu_profile, double flow,
         int solver_direction, size_t flag_for_points = 0)
         : pipe(pipe)
         , rho_profile(rho_profile)
@@ -513,10 +515,52 @@ public:
 
     /// @brief Возвращает значение правой части ДУ
     /// @param grid_index Обсчитываемый индекс расчетной сетки
-    /// @param point_vector Начальные условия
+    /// @param point_vector Начальные условия (правая часть от них не зависит)
     /// @return Значение правой части ДУ в точке point_vector
     virtual right_party_type ode_right_party(
         size_t grid_index, const var_type& point_vector) const override
+    {
+        return calc_right_party(grid_index);
+    }
+
+    /// @brief Правая часть (градиент давления) не зависит от давления
+    virtual bool is_state_independent() const override {
+        return true;
+    }
+
+    /// @brief Правые части в точках [begin, end) одним циклом без виртуальных вызовов
+    virtual void ode_right_party_range(size_t begin, size_t end, right_party_type* result) const override
+    {
+        for (size_t grid_index = begin; grid_index < end; ++grid_index) {
+            result[grid_index - begin] = calc_right_party(grid_index);
+        }
+    }
+
+    /// @brief Диапазон точек сетки, правая часть в которых использует реологию
+    /// (плотность и вязкость) с индексами [rheology_begin, rheology_end)
+    /// Нужен для пересчета только тех приращений давления, где реология изменилась
+    std::pair<size_t, size_t> get_grid_range_by_rheology_range(size_t rheology_begin, size_t rheology_end) const
+    {
+        // Обратное к выбору reo_index в calc_right_party смещение индекса
+        ptrdiff_t shift;
+        if (pipe.profile.getPointCount() == rho_profile.size()) {
+            shift = solver_direction == +1 ? -1 : +1;
+        }
+        else {
+            shift = solver_direction == +1 ? 0 : +1;
+        }
+        ptrdiff_t point_count = static_cast<ptrdiff_t>(pipe.profile.getPointCount());
+        ptrdiff_t grid_begin = (std::max<ptrdiff_t>)(static_cast<ptrdiff_t>(rheology_begin) + shift, 0);
+        ptrdiff_t grid_end = (std::min<ptrdiff_t>)(static_cast<ptrdiff_t>(rheology_end) + shift, point_count);
+        if (grid_begin >= grid_end) {
+            return { 0, 0 };
+        }
+        return { static_cast<size_t>(grid_begin), static_cast<size_t>(grid_end) };
+    }
+
+protected:
+    /// @brief Градиент давления в точке сетки
+    double calc_right_party(size_t grid_index) const
     {
 
         /// Обработка индекса в случае расчетов на границах трубы
@@ -543,7 +587,7 @@ public:
         double v = flow / (S_0);
         double Re = v * pipe.wall.diameter / nu_profile[reo_index];
         double lambda = pipe.resistance_function(Re, pipe.wall.relativeRoughness());
-        double tau_w = lambda / 8 * rho * v * abs(v);
+        double tau_w = lambda / 8 * rho * v * std::abs(v);
         double height_derivative = pipe.profile.get_height_derivative(grid_index, solver_direction);
         double result = -4 * tau_w / pipe.wall.diameter - rho * M_G * height_derivative;
         return result;
@@ -1,5 +1,8 @@
 ﻿
+#include <algorithm>
+#include <charconv>
 #include <fstream>
+#include "../io/mapped_file.h"
 
 namespace pde_solvers {
 ;
@@ -8,34 +11,67 @@ using std::max;
 using std::string;
 
 
+/// @brief Разбор содержимого файла координат и высоток (см. read_coordinates_and_heights_file)
+/// Числа разбираются на месте, без построчного копирования и строковых потоков
+/// @param data Начало содержимого файла
+/// @param size Размер содержимого
+/// @return Вектор векторов - координаты [м] и высотки
+inline vector<vector<double>> parse_coordinates_and_heights(const char* data, size_t size)
+{
+    const char* position = data;
+    const char* end = data + size;
+
+    auto skip_spaces = [&]() {
+        while (position < end && (*position == ' ' || *position == '\t'))
+            position++;
+    };
+    auto parse_number = [&]() {
+        skip_spaces();
+        double value;
+        auto [number_end, error] = std::from_chars(position, end, value);
+        if (error != std::errc()) {
+            throw std::runtime_error("parse_coordinates_and_heights: wrong number format");
+        }
+        position = number_end;
+        skip_spaces();
+        return value;
+    };
+
+    vector<double> coords;
+    vector<double> heights;
+
+    // Первую строку c названиями колонок пропускаем
+    position = std::find(position, end, '\n');
+    while (position < end) {
+        position++; // перевод строки
+        skip_spaces();
+        if (position == end || *position == '\n' || *position == '\r') {
+            position = std::find(position, end, '\n');
+            continue; // пустая строка
+        }
+        double coord = parse_number();
+        if (position == end || *position != ';') {
+            throw std::runtime_error("parse_coordinates_and_heights: delimiter is expected");
+        }
+        position++;
+        double height = parse_number();
+        coords.push_back(coord * 1000);
+        heights.push_back(height);
+        // Остаток строки (прочие колонки, '\r') не используется
+        position = std::find(position, end, '\n');
+    }
+
+    return { std::move(coords), std::move(heights) };
+}
+
 /// @brief Чтение координат и соответствующих высоток из файла csv
 /// первая строка с названием колонок, следующие строки в формате km;m
 /// @param filename Путь к файлу
 /// @return Вектор векторов - координаты и высотки
 inline vector<vector<double>> read_coordinates_and_heights_file(const std::string filename)
 {
-	std::ifstream file(filename);
-	std::string line;
-	char delimiter = ';';
-	vector<double> coords;
-	vector<double> heights;
-
-	// Первую строку c названиями колонок пропускаем
-	std::getline(file, line);
-	while (std::getline(file, line))
-	{
-		std::stringstream stream(line);
-		std::string coord;
-		std::string height;
-
-		std::getline(stream, coord, delimiter);
-		std::getline(stream, height, delimiter);
-		coords.push_back(stod(coord) * 1000);
-		heights.push_back(stod(height));
-	}
-
-	file.close();
-	return { coords, heights };
+    mapped_file_t file(filename);
+    return parse_coordinates_and_heights(file.get_data(), file.get_size());
 }
 
 
@@ -72,87 +108,7 @@ protected: // обработка координаток
         return generate_uniform_grid(desired_uniform_segment, segment_count + 1, initial_coordinate);
     }
 
-protected:  // обработка коротких труб
-	/// @brief Обработка случая короткой трубы исходного профиля по отношению к желаемому шагу по координате
-	/// @param new_coordinates Координатная сетка нового профиля
-	/// @param exact_coordinates Координатная сетка исходного профиля
-	/// @param _exact_parameters Профиль из исходных данных
-	static void extend_values(const vector<double>& new_coordinates,
-		const vector<double>& exact_coordinates, vector<double>* _exact_parameters)
-	{
-		vector<double>& exact_parameters = *_exact_parameters;
-
-		// если НАЧАЛЬНАЯ точка new_coordinates меньше НАЧАЛЬНОЙ точки exact_coordinates, 
-		// экстраполировать exact_coordinates ВЛЕВО
-		if (exact_coordinates.front() - new_coordinates.front() > 1e-8) {
-			//exact_coordinates.insert(exact_coordinates.begin(), new_coordinates.front() + offset);
-			exact_parameters.insert(exact_parameters.begin(), exact_parameters.front());
-		}
-
-		// если КОНЕЧНАЯ точка new_coordinates меньше конечной. точки exact_coordinates, 
-		// экстраполировать exact_coordinates ВПРАВО
-		if (new_coordinates.back() - exact_coordinates.back() > 1e-8) {
-			//exact_coordinates.push_back(new_coordinates.back() + offset);
-			exact_parameters.push_back(exact_parameters.back());
-		}
-	}
-
-	/// @brief Обработка случая короткой трубы исходного профиля по отношению к желаемому шагу по координате
-	/// @param new_coordinates Координатная сетка нового профиля
-	/// @param exact_coordinates Координатная сетка исходного профиля
-	static void extend_arguments(const vector<double>& new_coordinates,
-		vector<double>* _exact_coordinates)
-	{
-		vector<double>& exact_coordinates = *_exact_coordinates;
-
-		// если НАЧАЛЬНАЯ точка new_coordinates меньше НАЧАЛЬНОЙ точки exact_coordinates, 
-		// экстраполировать exact_coordinates ВЛЕВО
-		if (exact_coordinates.front() - new_coordinates.front() > 1e-8) {
-			exact_coordinates.insert(exact_coordinates.begin(), new_coordinates.front());
-		}
-
-		// если КОНЕЧНАЯ точка new_coordinates больше КОНЕЧНОЙ точки exact_coordinates, 
-		// экстраполировать exact_coordinates ВПРАВО
-		if (new_coordinates.back() - exact_coordinates.back() > 1e-8) {
-			exact_coordinates.push_back(new_coordinates.back());
-		}
-	}
 private: // обработка высоток и несущей
-	/// @brief Увеличение количества точек в случае разреженного исходного профиля
-	/// @param source_prof Исходный профиль
-	/// @param max_segment Длина желаемого сегмента
-	/// @return Более плотный профиль в случае разреженного исходного профиля
-	/// Исходный профиль в обратном случае
-	static PipeProfile subdivide_irregular_profile(PipeProfile source_prof, const double max_segment)
-	{
-		// Если все dl меньше чем max_segment, то профиль останется неизменным
-		// Там, где dl больше чем max_segment, профиль будет дополнен 
-		// с шагом не меньшим чем max_segment
-		PipeProfile new_prof;
-		for (size_t segment = 0; segment < source_prof.getPointCount() - 1; segment++)
-		{
-			double dl = source_prof.coordinates[segment + 1] - source_prof.coordinates[segment];
-			double dh = source_prof.heights[segment + 1] - source_prof.heights[segment];
-			double dcapacity = source_prof.capacity[segment + 1] - source_prof.capacity[segment];
-
-			size_t divide_cnt = static_cast<size_t>(ceil(dl / max_segment) + 1e-8);
-
-			// Заполнение промежутков новыми точками
-			for (size_t offset = 0; offset < divide_cnt; offset++)
-			{
-				new_prof.coordinates.push_back(source_prof.coordinates[segment] + dl * offset / divide_cnt);
-				new_prof.heights.push_back(source_prof.heights[segment] + dh * offset / divide_cnt);
-				new_prof.capacity.push_back(source_prof.capacity[segment] + dcapacity * offset / divide_cnt);
-			}
-		}
-
-		new_prof.coordinates.push_back(source_prof.coordinates.back());
-		new_prof.heights.push_back(source_prof.heights.back());
-		new_prof.capacity.push_back(source_prof.capacity.back());
-
-		return new_prof;
-	}
-
 	/// @brief Определение границ областей притяжения точек нового профиля
 	/// @param uniform_coordinates Координатная сетка нового профиля
 	/// @return Координаты границ областей притяжения точек нового профиля
@@ -172,6 +128,7 @@ private: // обработка высоток и несущей
 		// Все остальные имеют область притяжения по полсегмента в каждую сторону, т.е. 1.0 сегмент
 
 		vector<double> result;
+		result.reserve(uniform_coordinates.size() - 1);
 		result.push_back(uniform_coordinates.front());
 		for (size_t index = 1; index < uniform_coordinates.size() - 2; ++index) {
 			result.push_back(uniform_coordinates[index] + 0.5 * segment_length);
@@ -180,99 +137,85 @@ private: // обработка высоток и несущей
 		return result;
 	}
 
-	/// @brief Определние индексов границ областей притяжения на исходном профиле
-	/// @param exact_coordinates Исходный профиль
-	/// @param sample_coordinates Границы областей притяжения 
-	/// @return Индексы границ областей притяжения на исходном профиле
-	static vector<size_t> get_decimated_coordinates(const vector<double>& exact_coordinates,
-		const vector<double>& sample_coordinates)
-	{
-		if (exact_coordinates.size() == 0)
-			throw std::logic_error("get_decimated_coordinates(): empty coordinates");
-
-		size_t sample_index = 0;
-
-		vector<size_t> indices;
-		indices.reserve(sample_coordinates.size());
-		for (size_t index = 0; index < exact_coordinates.size(); ++index) {
-			while (exact_coordinates[index] > sample_coordinates[sample_index] - 1e-8)
-			{
-				indices.push_back(index);
-				sample_index++;
-				if (sample_index >= sample_coordinates.size())
-					return indices;
-			}
-		}
-
-		return indices;
-	}
-
-	/// @brief Определение высотных отметок соответствующим координатам нового профиля
-	/// @tparam Function Принцип выбора соответствующей высотной отметни на области притяжения
-	/// @param indices Индексы границ областей притяжения на исходном профиле
-	/// @param values Высотные отметки исходного профиля
-	/// @param function Принцип выбора соответствующей высотной отметни на области притяжения
-	/// @return Вектор соответствующих высоток для сетки нового профиля
-	template <typename Function>
-	static vector<double> execute_function_on_profile_segment(const vector<size_t>& indices,
-		const vector<double>& values, Function& function)
-	{
-		if (indices.empty()) {
-			throw std::logic_error("execute_function_on_profile_segment() empty indices");
-		}
-		if (indices.size() == 1) {
-			return vector < double > {values.front(), values.back()};
-		}
-
-		vector<double> result(indices.size() + 1);
-		result.front() = values.front();
-		result.back() = values.back();
-
-		// первая и последняя точка из values всегда попадают в результат
-		// их надо исключить из подмножеств
-		// последняя точка исключена из диапазона ввиду соглашений на вызов функтора (STL-like)
-		// первую точку надо исключить специальной проверкой
-
-		for (size_t segment = 0; segment < indices.size() - 1; ++segment) {
-			size_t index_from = indices[segment];
-			if (index_from == 0)
-				index_from = 1; // исключаем нулевую точку из нулевого сегмента
+    /// @brief Последовательное чтение кусочно-линейного исходного профиля
+    /// Координаты запросов не убывают, поэтому поиск сегмента - сдвиг индекса вперед
+    /// За пределами исходного профиля значения продолжаются константой (случай короткой трубы)
+    class profile_scanner_t {
+        const PipeProfile& profile;
+        /// @brief Сегмент [index, index + 1], в котором находится последняя запрошенная координата
+        size_t index{ 0 };
+    public:
+        profile_scanner_t(const PipeProfile& profile)
+            : profile(profile)
+        {
+        }
 
-			size_t index_to = indices[segment + 1];
-			// функция вызывается в стандарте STL, второй итератор указывает на элемент, следующий за последним
-			result[segment + 1] = *function(values.begin() + index_from, values.begin() + index_to);
-		}
+        /// @brief Сдвигает сегмент к координате x и возвращает высотку и несущую в ней
+        pair<double, double> advance_to(double x)
+        {
+            const vector<double>& coordinates = profile.coordinates;
+            size_t n = coordinates.size();
+            while (index + 2 < n && coordinates[index + 1] <= x) {
+                index++;
+            }
+            if (n == 1 || x <= coordinates.front()) {
+                return { profile.heights.front(), profile.capacity.front() };
+            }
+            if (x >= coordinates.back()) {
+                return { profile.heights.back(), profile.capacity.back() };
+            }
+            double alpha = (x - coordinates[index]) / (coordinates[index + 1] - coordinates[index]);
+            return {
+                linear_interpolation(profile.heights[index], profile.heights[index + 1], alpha),
+                linear_interpolation(profile.capacity[index], profile.capacity[index + 1], alpha)
+            };
+        }
 
-		return result;
-	}
+        /// @brief Индекс первой точки исходного профиля правее последней запрошенной координаты
+        size_t get_next_point_index() const {
+            return index + 1;
+        }
+    };
     
     /// @brief Формирует профили высоток и несущей для заднного равномерного профиля координат
-    /// Подразумевает, что труба source_profile не короче трубы uniform_coordinates
+    /// На области притяжения каждой точки исходный профиль рассматривается как кусочно-линейная функция:
+    /// максимум высотки (минимум несущей) достигается либо на границе области, либо в точке 
+    /// исходного профиля внутри нее. Поэтому исходный профиль не уплотняется и не копируется, 
+    /// а просматривается один раз
     /// @return пара ["равномерные" высотки; "равномерная" несущая]
-    static pair<vector<double>, vector<double>> create_uniform_height_and_capacity(PipeProfile source_profile, 
+    static pair<vector<double>, vector<double>> create_uniform_height_and_capacity(const PipeProfile& source_profile, 
         const vector<double>& uniform_coordinates) 
     {
-        // Увеличение плотности в случае разреженного профиля
-        double segment_length = uniform_coordinates[1] - uniform_coordinates[0];
-        source_profile = subdivide_irregular_profile(source_profile, segment_length / 2);
-
         // Определение границ областей притяжения точек нового профиля
         vector<double> influence_segments = generate_influence_segments(uniform_coordinates);
 
-        // получения индексов начада областей притяжения на исходном профиле
-        vector<size_t> influence_segment_indices =
-            get_decimated_coordinates(source_profile.coordinates, influence_segments);
-
-        // Определение высотных отметок на новом профиле по максимальному значению в соответствующей области притяжения
-        vector<double> uniform_heights = execute_function_on_profile_segment(influence_segment_indices,
-            source_profile.heights, std::max_element<vector<double>::const_iterator>);
-
-        vector<double> uniform_capacity = execute_function_on_profile_segment(influence_segment_indices,
-            source_profile.capacity, std::min_element<vector<double>::const_iterator>);
-
-        // Проверка на соответствие количества точек координат количеству высотных отметок
-        if (uniform_coordinates.size() != uniform_heights.size()) {
-            throw std::logic_error("pipeline_profile_t::create_uniform_profile(): coordinates.size() != heights.size()");
+        // Крайние точки нового профиля берут значения крайних точек исходного
+        vector<double> uniform_heights(uniform_coordinates.size());
+        vector<double> uniform_capacity(uniform_coordinates.size());
+        uniform_heights.front() = source_profile.heights.front();
+        uniform_heights.back() = source_profile.heights.back();
+        uniform_capacity.front() = source_profile.capacity.front();
+        uniform_capacity.back() = source_profile.capacity.back();
+
+        profile_scanner_t scanner(source_profile);
+        auto [height, capacity] = scanner.advance_to(influence_segments.front());
+        for (size_t segment = 0; segment + 1 < influence_segments.size(); ++segment) {
+            double max_height = height;
+            double min_capacity = capacity;
+
+            // Точки исходного профиля внутри области притяжения
+            double segment_end = influence_segments[segment + 1];
+            for (size_t index = scanner.get_next_point_index();
+                index < source_profile.getPointCount() && source_profile.coordinates[index] < segment_end; ++index)
+            {
+                max_height = max(max_height, source_profile.heights[index]);
+                min_capacity = (std::min)(min_capacity, source_profile.capacity[index]);
+            }
+
+            // Правая граница области - она же левая граница следующей
+            std::tie(height, capacity) = scanner.advance_to(segment_end);
+            uniform_heights[segment + 1] = max(max_height, height);
+            uniform_capacity[segment + 1] = (std::min)(min_capacity, capacity);
         }
 
         return std::make_pair(std::move(uniform_heights), std::move(uniform_capacity));
@@ -293,21 +236,11 @@ public:
         uniform_profile.coordinates = generate_uniform_grid(source_profile.coordinates.front(),
             source_profile.getLength(), desired_uniform_segment);
 
-        // Обработка случая короткой трубы. 
-        // Может получиться, если source_profile короче, чем desired_uniform_segment
-        // В этом случае удлиняем исходную трубу
-        PipeProfile extended_source_profile = source_profile;
-        extend_values(uniform_profile.coordinates, extended_source_profile.coordinates, 
-            &extended_source_profile.heights); 
-        extend_values(uniform_profile.coordinates, extended_source_profile.coordinates,
-            &extended_source_profile.capacity);
-        extend_arguments(uniform_profile.coordinates,
-            &extended_source_profile.coordinates);
-
-        // Подготовка профиля трассы и несущей способности 
-        // на основе (возможно удлиненной) исходной трубы и подготовленного равномерного профиля
+        // Подготовка профиля трассы и несущей способности на основе исходной трубы и равномерного профиля
+        // Случай короткой трубы (source_profile короче, чем desired_uniform_segment) обрабатывается 
+        // продолжением исходного профиля константой
         std::tie(uniform_profile.heights, uniform_profile.capacity) =
-            create_uniform_height_and_capacity(extended_source_profile, uniform_profile.coordinates);
+            create_uniform_height_and_capacity(source_profile, uniform_profile.coordinates);
 
 		return uniform_profile;
 
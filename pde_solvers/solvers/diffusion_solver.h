@@ -98,7 +98,7 @@ public:
             result[index] = initial_value;
         }
 
-        end_change = std::max(start_change, end_change);
+        end_change = (std::max)(start_change, end_change);
 
         for (size_t index = start_change; index < end_change; ++index) {
             result[index] = initial_value + (final_value - initial_value) * (index - start_change) / (end_change - start_change);
@@ -0,0 +1,183 @@
+﻿#pragma once
+
+namespace pde_solvers {
+;
+
+/// @brief Дерево Фенвика: префиксные суммы массива с изменением элементов за O(log n)
+class fenwick_tree_t {
+    /// @brief Частичные суммы, tree[i] - сумма элементов (i - lowbit(i), i] (индексация с 1)
+    vector<double> tree;
+public:
+    fenwick_tree_t() = default;
+    /// @brief Дерево для массива values за O(n)
+    fenwick_tree_t(const vector<double>& values) {
+        build(values);
+    }
+    /// @brief Перестраивает дерево по массиву values за O(n)
+    void build(const vector<double>& values) {
+        tree.assign(values.size() + 1, 0.0);
+        for (size_t index = 1; index <= values.size(); ++index) {
+            tree[index] += values[index - 1];
+            size_t parent = index + (index & (0 - index));
+            if (parent < tree.size()) {
+                tree[parent] += tree[index];
+            }
+        }
+    }
+    /// @brief Количество элементов
+    size_t size() const {
+        return tree.empty() ? 0 : tree.size() - 1;
+    }
+    /// @brief Объем выделенной памяти, байт
+    size_t get_allocated_size() const {
+        return pde_solvers::get_allocated_size(tree);
+    }
+    /// @brief Прибавляет delta к элементу index
+    void add(size_t index, double delta) {
+        for (size_t position = index + 1; position < tree.size(); position += position & (0 - position)) {
+            tree[position] += delta;
+        }
+    }
+    /// @brief Сумма первых count элементов
+    double prefix_sum(size_t count) const {
+        double result = 0;
+        for (size_t position = count; position > 0; position -= position & (0 - position)) {
+            result += tree[position];
+        }
+        return result;
+    }
+};
+
+/// @brief Инкрементальное решение методом Эйлера первого порядка ОДУ, правая часть которой
+/// не зависит от решения (см. ode_t::is_state_independent, solve_euler_state_independent)
+/// Приращения dx * f(x_i) хранятся вместе с деревом Фенвика. Когда правая часть меняется
+/// только в части точек (например, на фронтах партий), пересчитываются только эти приращения:
+/// значение в точке - за O(log n), профиль целиком - за O(n) при первом запросе после изменений.
+/// Профиль суммируется по приращениям последовательно и побитово совпадает с solve_euler
+class incremental_euler_solver_t {
+    /// @brief Направление расчета: +1 по ходу индексов, -1 против хода индексов
+    int direction{ +1 };
+    /// @brief Начальное условие (в начале трубы при direction = +1, в конце при direction = -1)
+    double initial_condition{ 0 };
+    /// @brief Приращения по шагам в направлении расчета: шаг s - от точки start + s * direction
+    vector<double> increments;
+    /// @brief Префиксные суммы приращений для запроса значения в точке
+    fenwick_tree_t increment_sums;
+    /// @brief Количество приращений, измененных с последней перестройки дерева
+    /// (каждое изменение добавляет ошибку округления в частичные суммы дерева)
+    size_t updates_since_build{ 0 };
+    /// @brief Буфер правых частей
+    vector<double> right_parties;
+    /// @brief Профиль решения (действителен при profile_valid)
+    vector<double> profile;
+    bool profile_valid{ false };
+
+private:
+    /// @brief Номер шага, приращение которого рассчитывается по правой части в точке grid_index
+    /// (он же - количество шагов от начальной точки до grid_index)
+    size_t get_step(size_t grid_index) const {
+        return direction > 0
+            ? grid_index
+            : increments.size() - grid_index;
+    }
+    /// @brief Точка сетки, в которую приходит расчет за step шагов
+    size_t get_grid_index(size_t step) const {
+        return direction > 0
+            ? step
+            : increments.size() - step;
+    }
+    /// @brief Рассчитывает приращения по правым частям в точках [grid_begin, grid_end)
+    void calc_increments(const ode_t<1>& ode, size_t grid_begin, size_t grid_end, bool update_tree)
+    {
+        const vector<double>& grid = ode.get_grid();
+        right_parties.resize(grid_end - grid_begin);
+        ode.ode_right_party_range(grid_begin, grid_end, right_parties.data());
+        for (size_t grid_index = grid_begin; grid_index < grid_end; ++grid_index) {
+            double dx = grid[grid_index + direction] - grid[grid_index];
+            double increment = dx * right_parties[grid_index - grid_begin];
+            size_t step = get_step(grid_index);
+            if (update_tree) {
+                increment_sums.add(step, increment - increments[step]);
+            }
+            increments[step] = increment;
+        }
+    }
+
+public:
+    /// @brief Полный расчет приращений
+    /// @param ode Система ОДУ, не зависящая от решения
+    /// @param direction Направление расчета
+    /// @param initial_condition Начальное условие
+    void build(const ode_t<1>& ode, int direction, double initial_condition)
+    {
+        if (!ode.is_state_independent())
+            throw std::logic_error("incremental_euler_solver_t requires state independent ODE");
+        size_t n = ode.get_grid().size();
+        this->direction = direction;
+        this->initial_condition = initial_condition;
+        increments.assign(n - 1, 0.0);
+        calc_increments(ode, direction > 0 ? 0 : 1, direction > 0 ? n - 1 : n, false);
+        increment_sums.build(increments);
+        updates_since_build = 0;
+        profile_valid = false;
+    }
+    /// @brief Признак того, что приращения рассчитаны
+    bool is_built() const {
+        return !increments.empty();
+    }
+    /// @brief Объем выделенной памяти, байт
+    size_t get_allocated_size() const {
+        return pde_solvers::get_allocated_size(increments) + increment_sums.get_allocated_size()
+            + pde_solvers::get_allocated_size(right_parties) + pde_solvers::get_allocated_size(profile);
+    }
+    /// @brief Пересчитывает приращения по правым частям в точках [grid_begin, grid_end)
+    /// Точки, в которых правая часть не используется (последняя в направлении расчета), пропускаются
+    void update(const ode_t<1>& ode, size_t grid_begin, size_t grid_end)
+    {
+        if (direction > 0) {
+            grid_end = (std::min)(grid_end, increments.size());
+        }
+        else {
+            grid_begin = (std::max<size_t>)(grid_begin, 1);
+            grid_end = (std::min)(grid_end, increments.size() + 1);
+        }
+        if (grid_begin >= grid_end) {
+            return;
+        }
+        calc_increments(ode, grid_begin, grid_end, true);
+        updates_since_build += grid_end - grid_begin;
+        if (updates_since_build > increments.size()) {
+            // Перестройка за O(n) амортизируется изменениями и ограничивает накопление ошибок округления
+            increment_sums.build(increments);
+            updates_since_build = 0;
+        }
+        profile_valid = false;
+    }
+    /// @brief Меняет начальное условие (приращения не пересчитываются)
+    void set_initial_condition(double initial_condition) {
+        this->initial_condition = initial_condition;
+        profile_valid = false;
+    }
+    /// @brief Значение решения в точке сетки за O(log n)
+    /// Отличается от профиля (get_profile) порядком суммирования
+    double get_value(size_t grid_index) const {
+        return initial_condition + increment_sums.prefix_sum(get_step(grid_index));
+    }
+    /// @brief Профиль решения; пересчитывается за O(n), только если с прошлого запроса были изменения
+    const vector<double>& get_profile()
+    {
+        if (!profile_valid) {
+            profile.resize(increments.size() + 1);
+            double value = initial_condition;
+            profile[get_grid_index(0)] = value;
+            for (size_t step = 0; step < increments.size(); ++step) {
+                value = value + increments[step];
+                profile[get_grid_index(step + 1)] = value;
+            }
+            profile_valid = true;
+        }
+        return profile;
+    }
+};
+
+}
@@ -212,15 +212,24 @@ public:
     /// Если желаемый шаг превышает шаг по Куранту dtCr, либо не задан (time_step = nan),
     /// то возвращается шаг dtCr
     /// Иначе - возвращается time_step
-    double prepare_step(double time_step = std::numeric_limits<double>::quiet_NaN()) {
+    /// @param decomposition Разбиение сетки для параллельного расчета (nullptr - последовательный расчет)
+    double prepare_step(double time_step = std::numeric_limits<double>::quiet_NaN(),
+        const domain_decomposition_t* decomposition = nullptr) 
+    {
+        PDE_SOLVERS_TIME_PHASE(prepare_step);
+        PDE_SOLVERS_COUNT(pde_callbacks, grid.size());
         auto& values = prev;
 
-        double max_egenval = 0;
-        for (size_t grid_index = 0; grid_index < grid.size(); ++grid_index) {
-            double eigen_value = eigenvals[grid_index] = pde.getEquationsCoeffs(grid_index, values[grid_index]);
+        double max_egenval = max_over_subdomains(decomposition, 0, grid.size(),
+            [&](size_t index_begin, size_t index_end) {
+                double max_egenval = 0;
+                for (size_t grid_index = index_begin; grid_index < index_end; ++grid_index) {
+                    double eigen_value = eigenvals[grid_index] = pde.getEquationsCoeffs(grid_index, values[grid_index]);
 
-            max_egenval = std::max(max_egenval, std::abs(eigen_value));
-        }
+                    max_egenval = (std::max)(max_egenval, std::abs(eigen_value));
+                }
+                return max_egenval;
+            });
 
         double dx = grid[1] - grid[0];
         double courant_step = dx / max_egenval;
@@ -256,9 +265,12 @@ public:
     }
     /// @brief Расчет внутренних точек методом первого порядка
     /// (с учетом наклона характеристик)
-    double step_inner(double time_step = std::numeric_limits<double>::quiet_NaN())
+    /// @param decomposition Разбиение сетки для параллельного расчета (nullptr - последовательный расчет)
+    double step_inner(double time_step = std::numeric_limits<double>::quiet_NaN(),
+        const domain_decomposition_t* decomposition = nullptr)
     {
-        time_step = prepare_step(time_step);
+        PDE_SOLVERS_TIME_PHASE(step_inner);
+        time_step = prepare_step(time_step, decomposition);
 
         int index_from = eigenvals[0] > 0
             ? 1
@@ -272,26 +284,30 @@ public:
         auto& curr_values = curr;
 
         profile_wrapper<double, 1> prev_values(this->prev); // оборачиваем только для интерполяции 
-
-        for (int index = index_from; index <= index_to; ++index)
-        {
-            double p = characteristic_interpolation_offset(
-                time_step, &eigenvals[index], &grid[index]);
-            double u_old = prev_values.interpolate(index, p);
-            double b = pde.getSourceTerm(index, u_old);
-
-            double& u_new = curr_values[index];
-            u_new = u_old - time_step * b;
-        }
+        PDE_SOLVERS_COUNT(pde_callbacks, index_to + 1 - index_from);
+
+        for_each_subdomain(decomposition, index_from, index_to + 1, [&](size_t index_begin, size_t index_end) {
+            for (size_t index = index_begin; index < index_end; ++index)
+            {
+                double p = characteristic_interpolation_offset(
+                    time_step, &eigenvals[index], &grid[index]);
+                double u_old = prev_values.interpolate(index, p);
+                double b = pde.getSourceTerm(index, u_old);
+
+                double& u_new = curr_values[index];
+                u_new = u_old - time_step * b;
+            }
+        });
 
         return time_step;
     }
     /// @brief Опциональный расчет нового слоя, учитываюшего граничные условия, 
     /// в зависимости от наклона характеристик
     void step_optional_boundaries(
-        double time_step, double left_value, double right_value)
+        double time_step, double left_value, double right_value,
+        const domain_decomposition_t* decomposition = nullptr)
     {
-        step_inner(time_step);
+        step_inner(time_step, decomposition);
         if (eigenvals[0] > 0) {
             curr[0] = left_value;
         }
@@ -302,9 +318,11 @@ public:
     /// @brief Расчет внутренних точек нового слоя методом второго порядка
     /// Учитывает, что конфигураций характеристики могут позволить рассчитать граничные точки
     /// Также считает собственные числа, векторы для ВСЕХ точек
-    double step2_inner(double time_step = std::numeric_limits<double>::quiet_NaN())
+    /// @param decomposition Разбиение сетки для параллельного расчета (nullptr - последовательный расчет)
+    double step2_inner(double time_step = std::numeric_limits<double>::quiet_NaN(),
+        const domain_decomposition_t* decomposition = nullptr)
     {
-        time_step = prepare_step(time_step);
+        time_step = prepare_step(time_step, decomposition);
 
         auto prev_values = profile_wrapper<double, 1>(prev);
         //auto& curr_values = curr;
@@ -313,59 +331,62 @@ public:
 
         double dl = grid[1] - grid[0];
 
-        for (int grid_index = 0; grid_index < grid.size(); ++grid_index)
-        {
-            const double& eigenval = eigenvals[grid_index];
-            if (grid_index == 0 && eigenval > 0) {
-                // надо брать точку с координатой i = -1
-                continue;
-            }
-            if (grid_index == grid.size() - 1 && eigenval < 0) {
-                continue;
-            }
+        for_each_subdomain(decomposition, 0, grid.size(), [&](size_t index_begin, size_t index_end) {
+            for (int grid_index = static_cast<int>(index_begin); grid_index < static_cast<int>(index_end); ++grid_index)
+            {
+                const double& eigenval = eigenvals[grid_index];
+                if (grid_index == 0 && eigenval > 0) {
+                    // надо брать точку с координатой i = -1
+                    continue;
+                }
+                if (grid_index == grid.size() - 1 && eigenval < 0) {
+                    continue;
+                }
+
+                double p = characteristic_interpolation_offset(time_step, &eigenval, &grid[grid_index]);
+
+                // предиктор
+                double u_old;
+                double rp1;
+                double absp = std::abs(p);
+                if (absp < eps || std::abs(1.0 - absp) < eps) {
+                    // характеристика точно между двумя точками: либо косая, либо вертикальная
+                    size_t index = static_cast<size_t>(grid_index + p + 0.5);
+                    u_old = prev[index];
+                    rp1 = pde.getSourceTerm(index, u_old);
+                }
+                else {
+                    // интерполяция правой части
+                    size_t grida = static_cast<size_t>(grid_index + sgn(p));
+                    size_t gridb = grid_index;
+                    double rp1a = pde.getSourceTerm(grida, prev_values[grida]);
+                    double rp1b = pde.getSourceTerm(gridb, prev_values[gridb]);
+                    rp1 = rp1a * absp + rp1b * (1 - absp); // проверка: если p = 0, то берем b(grid_index)
+                    u_old = prev_values.interpolate(grid_index, p);
+                }
+
+                double u_estimate = u_old + time_step * rp1;
+
+                // корректор
+                double rp2 = pde.getSourceTerm(grid_index, u_estimate);
+                curr[grid_index] = u_old + time_step * 0.5 * (rp1 + rp2);
+
+                if (!isfinite(rp1) || !isfinite(rp2) || !isfinite(u_estimate) || !isfinite(u_old)) {
+                    throw std::logic_error("infinite value");
+                }
 
-            double p = characteristic_interpolation_offset(time_step, &eigenval, &grid[grid_index]);
-
-            // предиктор
-            double u_old;
-            double rp1;
-            double absp = abs(p);
-            if (absp < eps || abs(1.0 - absp) < eps) {
-                // характеристика точно между двумя точками: либо косая, либо вертикальная
-                size_t index = static_cast<size_t>(grid_index + p + 0.5);
-                u_old = prev[index];
-                rp1 = pde.getSourceTerm(index, u_old);
-            }
-            else {
-                // интерполяция правой части
-                size_t grida = static_cast<size_t>(grid_index + sgn(p));
-                size_t gridb = grid_index;
-                double rp1a = pde.getSourceTerm(grida, prev_values[grida]);
-                double rp1b = pde.getSourceTerm(gridb, prev_values[gridb]);
-                rp1 = rp1a * absp + rp1b * (1 - absp); // проверка: если p = 0, то берем b(grid_index)
-                u_old = prev_values.interpolate(grid_index, p);
             }
-
-            double u_estimate = u_old + time_step * rp1;
-
-            // корректор
-            double rp2 = pde.getSourceTerm(grid_index, u_estimate);
-            curr[grid_index] = u_old + time_step * 0.5 * (rp1 + rp2);
-
-            if (!isfinite(rp1) || !isfinite(rp2) || !isfinite(u_estimate) || !isfinite(u_old)) {
-                throw std::logic_error("infinite value");
-            }
-
-        }
+        });
 
         return time_step;
     }
     /// @brief Опциональный расчет граничных условий, в зависимости от наклона характеристик
     /// Метод второго порядка
     void step2_optional_boundaries(double time_step,
-        double left_value, double right_value)
+        double left_value, double right_value,
+        const domain_decomposition_t* decomposition = nullptr)
     {
-        step2_inner(time_step);
+        step2_inner(time_step, decomposition);
 
         if (eigenvals[0] > 0) {
             curr[0] = left_value;
@@ -521,11 +542,13 @@ public:
     /// \param time_step
     /// \param left_boundary
     /// \param right_boundary
+    /// \param decomposition Разбиение сетки для параллельного расчета (nullptr - последовательный расчет)
     double step(const pair<vector_type, double>& left_boundary,
         const pair<vector_type, double>& right_boundary,
-        double time_step = std::numeric_limits<double>::quiet_NaN())
+        double time_step = std::numeric_limits<double>::quiet_NaN(),
+        const domain_decomposition_t* decomposition = nullptr)
     {
-        time_step = step_inner(time_step); // если отдать в step_inner dt = nan, то он его пересчитает в шаг по Куранту!
+        time_step = step_inner(time_step, decomposition); // если отдать в step_inner dt = nan, то он его пересчитает в шаг по Куранту!
 
         pair<vector_type, double> eq_left =
             get_characteristic_equation(time_step, 0, 0);
@@ -553,14 +576,14 @@ public:
 
     static double get_max_abs(double v)
     {
-        return abs(v);
+        return std::abs(v);
     }
 
     static double get_max_abs(const std::array<double, Dimension>& v)
     {
         double max_egenval = -std::numeric_limits<double>::infinity();
         for (double eval : v) {
-            max_egenval = std::max(max_egenval, abs(eval));
+            max_egenval = (std::max)(max_egenval, std::abs(eval));
         }
         return max_egenval;
     }
@@ -573,24 +596,32 @@ public:
     {
         double max_egenval = -std::numeric_limits<double>::infinity();
         for (double eval : v) {
-            max_egenval = std::max(max_egenval, eval);
+            max_egenval = (std::max)(max_egenval, eval);
         }
         return max_egenval;
     }
 
-    double prepare_step(double time_step = std::numeric_limits<double>::quiet_NaN()) {
+    double prepare_step(double time_step = std::numeric_limits<double>::quiet_NaN(),
+        const domain_decomposition_t* decomposition = nullptr) 
+    {
+        PDE_SOLVERS_TIME_PHASE(prepare_step);
+        PDE_SOLVERS_COUNT(pde_callbacks, grid.size());
         auto& eigenval = prev.eigenval;
         auto& eigenvec = prev.eigenvec;
         auto& values = prev.values;
 
-        double max_egenval = 0;
-        for (size_t grid_index = 0; grid_index < grid.size(); ++grid_index) {
-            auto [val, vec] = pde.GetLeftEigens(grid_index, values(grid_index));
-            
-            max_egenval = std::max(max_egenval, get_max_abs(val));
-            eigenval(grid_index) = val;
-            eigenvec(grid_index) = vec;
-        }
+        double max_egenval = max_over_subdomains(decomposition, 0, grid.size(),
+            [&](size_t index_begin, size_t index_end) {
+                double max_egenval = 0;
+                for (size_t grid_index = index_begin; grid_index < index_end; ++grid_index) {
+                    auto [val, vec] = pde.GetLeftEigens(grid_index, values(grid_index));
+
+                    max_egenval = (std::max)(max_egenval, get_max_abs(val));
+                    eigenval(grid_index) = val;
+                    eigenvec(grid_index) = vec;
+                }
+                return max_egenval;
+            });
 
         double dx = grid[1] - grid[0];
         double courant_step = dx / max_egenval;
@@ -604,9 +635,12 @@ public:
     /// @brief Расчет внутренних точек нового слоя
     /// Также считает собственные числа, векторы для ВСЕХ точек
     /// \param time_step
-    double step_inner(double time_step = std::numeric_limits<double>::quiet_NaN())
+    /// \param decomposition Разбиение сетки для параллельного расчета (nullptr - последовательный расчет)
+    double step_inner(double time_step = std::numeric_limits<double>::quiet_NaN(),
+        const domain_decomposition_t* decomposition = nullptr)
     {
-        time_step = prepare_step(time_step);
+        PDE_SOLVERS_TIME_PHASE(step_inner);
+        time_step = prepare_step(time_step, decomposition);
 
         auto& eigenval = prev.eigenval;
         auto& eigenvec = prev.eigenvec;
@@ -617,16 +651,18 @@ public:
         int index_to = static_cast<int>(grid.size() - 2);
 
         auto& curr_values = curr.values;
+        PDE_SOLVERS_COUNT(pde_callbacks, Dimension * (index_to + 1 - index_from));
 
-        for (int index = index_from; index <= index_to; ++index)
-        {
-            // li * u_new = li * (u_old - dt*b) [обозначим si = li * (u_old - dt*b)]
-            // L * u_new = S
-            auto [L, S] = get_characteristic_equations(time_step, index);
-            
-            curr_values(index) = solve_linear_system(L, S);
-            
-        }
+        for_each_subdomain(decomposition, index_from, index_to + 1, [&](size_t index_begin, size_t index_end) {
+            for (size_t index = index_begin; index < index_end; ++index)
+            {
+                // li * u_new = li * (u_old - dt*b) [обозначим si = li * (u_old - dt*b)]
+                // L * u_new = S
+                auto [L, S] = get_characteristic_equations(time_step, index);
+
+                curr_values(index) = solve_linear_system(L, S);
+            }
+        });
 
         return time_step;
     }
@@ -30,6 +30,7 @@ inline void solve_euler(
     int end_index = direction < 0 ? 0 : static_cast<int>(grid.size()) - 1;
 
     result[start_index] = initial_condition;
+    PDE_SOLVERS_COUNT(pde_callbacks, grid.size() - 1);
 
     for (int index = start_index; index != end_index /*крайний индекс пропускается и это правильно*/; index += direction) {
         int next_index = index + direction;
@@ -46,6 +47,95 @@ inline void solve_euler(
 
 
 
+/// @brief Решение методом Эйлера первого порядка ОДУ, правая часть которой не зависит от решения
+/// (ode.is_state_independent()). Решение - накопленная сумма приращений dx * f(x_i):
+/// сначала все приращения рассчитываются по подобластям разбиения, затем параллельная префиксная сумма
+/// (суммы подобластей, их последовательное накопление, добавление смещений в подобластях).
+/// При последовательном расчете результат побитово совпадает с solve_euler, при параллельном
+/// отличается порядком суммирования (на уровне ошибок округления)
+/// @param ode Система ОДУ
+/// @param direction Направление расчета: +1 по ходу индексов, -1 против хода индексов
+/// @param initial_condition Начальное условие (левое при direction = +1, правое при direction = -1)
+/// @param _result Буфер для записи результата
+/// @param decomposition Разбиение сетки для параллельного расчета (nullptr - последовательный расчет)
+template <size_t Dimension>
+inline void solve_euler_state_independent(
+    const ode_t<Dimension>& ode,
+    int direction,
+    const typename ode_t<Dimension>::var_type& initial_condition,
+    vector<typename ode_t<Dimension>::var_type>* _result,
+    const domain_decomposition_t* decomposition = nullptr
+)
+{
+    typedef typename fixed_system_types<Dimension>::var_type vector_type;
+    vector<vector_type>& result = *_result;
+    const vector<double>& grid = ode.get_grid();
+
+    if (!ode.is_state_independent())
+        throw std::logic_error("solve_euler_state_independent() requires state independent ODE");
+    if (result.size() != grid.size())
+        throw std::runtime_error("Result buffer and grid size must be equal");
+
+    size_t n = grid.size();
+    size_t start_index = direction > 0 ? 0 : n - 1;
+    PDE_SOLVERS_COUNT(pde_callbacks, n - 1);
+
+    // Приращение на отрезке [i, i + direction] записывается в точку i + direction
+    size_t gradient_begin = direction > 0 ? 0 : 1;
+    for_each_subdomain(decomposition, gradient_begin, gradient_begin + n - 1, [&](size_t begin, size_t end) {
+        vector_type* increments = &result[begin + direction];
+        ode.ode_right_party_range(begin, end, increments);
+        for (size_t index = begin; index < end; ++index) {
+            double dx = grid[index + direction] - grid[index];
+            increments[index - begin] = dx * increments[index - begin];
+        }
+    });
+    result[start_index] = initial_condition;
+
+    // Префиксная сумма по шагам step = 0..n-1 в направлении расчета
+    auto at = [&](size_t step) -> vector_type& {
+        return direction > 0 ? result[step] : result[n - 1 - step];
+    };
+    if (decomposition == nullptr) {
+        for (size_t step = 1; step < n; ++step) {
+            at(step) = at(step - 1) + at(step);
+        }
+        return;
+    }
+
+    // Суммы подобластей (начало подобласти, сумма)
+    vector<std::pair<size_t, vector_type>> subdomain_sums;
+    std::mutex mutex;
+    for_each_subdomain(decomposition, 0, n, [&](size_t begin, size_t end) {
+        for (size_t step = begin + 1; step < end; ++step) {
+            at(step) = at(step - 1) + at(step);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        subdomain_sums.emplace_back(begin, at(end - 1));
+    });
+    std::sort(subdomain_sums.begin(), subdomain_sums.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+    // Смещение подобласти - накопленная сумма предыдущих подобластей
+    vector_type offset = subdomain_sums.front().second;
+    for (size_t subdomain = 1; subdomain < subdomain_sums.size(); ++subdomain) {
+        vector_type subdomain_sum = subdomain_sums[subdomain].second;
+        subdomain_sums[subdomain].second = offset;
+        offset = offset + subdomain_sum;
+    }
+    for_each_subdomain(decomposition, 0, n, [&](size_t begin, size_t end) {
+        if (begin == 0) {
+            return; // первая подобласть начинается с начального условия
+        }
+        auto subdomain = std::lower_bound(subdomain_sums.begin(), subdomain_sums.end(), begin,
+            [](const auto& item, size_t value) { return item.first < value; });
+        for (size_t step = begin; step < end; ++step) {
+            at(step) = subdomain->second + at(step);
+        }
+    });
+}
+
+
+
 /// @brief Решение ОДУ методом Эйлера со схемой предиктор-корректор
 /// @param ode Система ОДУ
 /// @param direction Направление расчета: +1 по ходу индексов, -1 против хода индексов
@@ -73,6 +163,7 @@ inline void solve_euler_corrector(
     int end_index = direction < 0 ? 0 : static_cast<int>(grid.size()) - 1;
 
     result[start_index] = initial_condition;
+    PDE_SOLVERS_COUNT(pde_callbacks, 2 * (grid.size() - 1));
 
     //after_calc_event(start_index, result[start_index]);
 
@@ -42,14 +42,39 @@ struct quickest_ultimate_fv_solver_traits
         0, 0> specific_layer;
 };
 
+/// @brief Описание типов данных для методов конечных объемов (upstream, QUICK, QUICKEST, QUICKEST-ULTIMATE)
+/// со значениями переменных в типе Scalar (например, float для расчета партий: вдвое меньше памяти)
+/// Потоки на границах ячеек и арифметика шага остаются в double
+template <typename Scalar>
+struct scalar_fv_solver_traits
+{
+    typedef profile_collection_t<0, 1/*переменные - ячейки*/, 0, 0, 0, 0, Scalar> var_layer_data;
+    typedef profile_collection_t<1 /*потоки F*/, 0,
+        0, 0,
+        0, 0> specific_layer;
+};
+
+/// @brief Описание типов данных для методов конечных объемов (upstream, QUICK, QUICKEST, QUICKEST-ULTIMATE)
+/// на сетке с количеством точек PointCount, заданным на этапе компиляции
+/// Слои без выделения динамической памяти - для коротких труб, которые рассчитываются многократно
+template <size_t PointCount, typename Scalar = double>
+struct fixed_fv_solver_traits
+{
+    typedef fixed_profile_collection_t<PointCount, 0, 1/*переменные - ячейки*/, Scalar> var_layer_data;
+    typedef fixed_profile_collection_t<PointCount, 1/*потоки F*/, 0> specific_layer;
+};
+
 /// @brief Солвер на основе upstream differencing, только для размерности 1!
 /// [Leonard 1979]
-class upstream_fv_solver {
+template <typename Traits>
+class upstream_fv_solver_t {
 public:
-    typedef typename upstream_fv_solver_traits<1>::var_layer_data var_layer_data;
-    typedef typename upstream_fv_solver_traits<1>::specific_layer specific_layer;
+    typedef typename Traits::var_layer_data var_layer_data;
+    typedef typename Traits::specific_layer specific_layer;
     typedef typename fixed_system_types<1>::matrix_type matrix_type;
     typedef typename fixed_system_types<1>::var_type vector_type;
+    /// @brief Тип значений переменных (потоки и арифметика шага - в double)
+    typedef typename var_layer_data::scalar_type scalar_type;
 protected:
     /// @brief ДУЧП
     pde_t<1>& pde;
@@ -71,9 +96,19 @@ public:
     /// Из буфера берется current() и previous()
     /// @param pde ДУЧП
     /// @param buffer Буфер слоев
-    upstream_fv_solver(pde_t<1>& pde,
+    upstream_fv_solver_t(pde_t<1>& pde,
         ring_buffer_t<composite_layer_t<var_layer_data, specific_layer>>& buffer)
-        : upstream_fv_solver(pde, buffer.previous(), buffer.current())
+        : upstream_fv_solver_t(pde, buffer.previous(), buffer.current())
+    {}
+
+    /// @brief Конструктор для буфера слоев фиксированного размера (см. fixed_ring_buffer_t)
+    /// Из буфера берется current() и previous()
+    /// @param pde ДУЧП
+    /// @param buffer Буфер слоев
+    template <size_t LayerCount>
+    upstream_fv_solver_t(pde_t<1>& pde,
+        fixed_ring_buffer_t<composite_layer_t<var_layer_data, specific_layer>, LayerCount>& buffer)
+        : upstream_fv_solver_t(pde, buffer.previous(), buffer.current())
     {}
 
     /// @brief Конструктор для простых слоев - 
@@ -81,7 +116,7 @@ public:
     /// @param pde ДУЧП
     /// @param prev Предыдущий слой (уже рассчитанный)
     /// @param curr Следующий (новый), для которого требуется сделать расчет
-    upstream_fv_solver(pde_t<1>& pde,
+    upstream_fv_solver_t(pde_t<1>& pde,
         const composite_layer_t<var_layer_data, specific_layer>& prev,
         composite_layer_t<var_layer_data, specific_layer>& curr)
         : pde(pde)
@@ -98,7 +133,8 @@ public:
     /// @param dt Заданный период времени
     /// @param u_in Левое граничное условие
     /// @param u_out Правое граничное условие
-    void step(double dt, double u_in, double u_out) {
+    /// @param decomposition Разбиение сетки для параллельного расчета (nullptr - последовательный расчет)
+    void step(double dt, double u_in, double u_out, const domain_decomposition_t* decomposition = nullptr) {
         auto& F = curr_spec.point_double[0]; // потоки на границах ячеек
         const auto& U = prev_vars.cell_double[0];
         auto& U_new = curr_vars.cell_double[0];
@@ -115,28 +151,46 @@ public:
 
 
         // Расчет потоков на границе по правилу донорской ячейки
-        for (size_t cell = 0; cell < U.size(); ++cell) {
-            double u = U[cell];
-            double v_cell = pde.getEquationsCoeffs(cell, u); // не совсем корректно, скорость в ячейке берется из скорости на ее левой границе
-            if (v_cell > 0) {
-                size_t right_point = cell + 1;
-                double v_right = pde.getEquationsCoeffs(right_point, u);
-                F[right_point] = u * v_right;
-            }
-            else {
-                size_t left_point = cell;
-                double v_left = pde.getEquationsCoeffs(left_point, u);
-                F[left_point] = u * v_left;
+        for_each_subdomain(decomposition, 0, U.size(), [&](size_t cell_begin, size_t cell_end) {
+            for (size_t cell = cell_begin; cell < cell_end; ++cell) {
+                double u = U[cell];
+                double v_cell = pde.getEquationsCoeffs(cell, u); // не совсем корректно, скорость в ячейке берется из скорости на ее левой границе
+                if (v_cell > 0) {
+                    size_t right_point = cell + 1;
+                    if (cell + 1 == cell_end && cell_end < U.size() &&
+                        pde.getEquationsCoeffs(cell_end, U[cell_end]) <= 0) 
+                    {
+                        // Поток на границе подобластей перезапишет следующая ячейка 
+                        // (как при последовательном расчете) - не пишем его одновременно с ней
+                        continue;
+                    }
+                    double v_right = pde.getEquationsCoeffs(right_point, u);
+                    F[right_point] = u * v_right;
+                }
+                else {
+                    size_t left_point = cell;
+                    double v_left = pde.getEquationsCoeffs(left_point, u);
+                    F[left_point] = u * v_left;
+                }
             }
-        }
+        });
 
-        for (size_t cell = 0; cell < U.size(); ++cell) {
-            double dx = grid[cell + 1] - grid[cell]; // ячейки обычно одинаковой длины, но мало ли..
-            U_new[cell] = U[cell] + dt / dx * ((F[cell] - F[cell + 1]));
-        }
+        for_each_subdomain(decomposition, 0, U.size(), [&](size_t cell_begin, size_t cell_end) {
+            for (size_t cell = cell_begin; cell < cell_end; ++cell) {
+                double dx = grid[cell + 1] - grid[cell]; // ячейки обычно одинаковой длины, но мало ли..
+                U_new[cell] = static_cast<scalar_type>(U[cell] + dt / dx * ((F[cell] - F[cell + 1])));
+            }
+        });
     }
 };
 
+/// @brief Солвер upstream_fv_solver_t для слоев на std::vector
+typedef upstream_fv_solver_t<upstream_fv_solver_traits<1>> upstream_fv_solver;
+
+/// @brief Солвер upstream_fv_solver_t для слоев фиксированного размера (см. fixed_fv_solver_traits)
+template <size_t PointCount>
+using fixed_upstream_fv_solver = upstream_fv_solver_t<fixed_fv_solver_traits<PointCount>>;
+
 inline double quick_border_approximation(double U_L, double U_C, double U_R)
 {
     double Ub_linear = (U_C + U_R) / 2;
@@ -146,7 +200,7 @@ inline double quick_border_approximation(double U_L, double U_C, double U_R)
 
 inline double quickest_border_approximation(double U_L, double U_C, double U_R, double hi, double dx, double dt, double v)
 {
-    double Cour = abs((v * dt) / dx);
+    double Cour = std::abs((v * dt) / dx);
     double Ub_linear = (U_C + U_R) / 2;
     double Grad = (U_R - U_C) / dx;
     double Curv = (U_L + U_R - 2 * U_C) / (dx * dx);
@@ -158,12 +212,12 @@ inline double quickest_border_approximation(double U_L, double U_C, double U_R,
 inline double quickest_ultimate_border_approximation(double U_L, double U_C, double U_R, double hi, double dx, double dt, double v)
 {
     double DEL = U_R - U_L;
-    double ADEL = abs(DEL);
-    double ACURV = abs(U_L + U_R - 2 * U_C);
+    double ADEL = std::abs(DEL);
+    double ACURV = std::abs(U_L + U_R - 2 * U_C);
     if (ACURV >= ADEL) {
         return U_C;
     }
-    double Cour = abs((v * dt) / dx);
+    double Cour = std::abs((v * dt) / dx);
     double REF = U_L + ((U_C - U_L) / Cour);
     double Ub_linear = (U_C + U_R) / 2;
     double Grad = (U_R - U_C) / dx;
@@ -175,16 +229,16 @@ inline double quickest_ultimate_border_approximation(double U_L, double U_C, dou
         if (Uf < U_C) {
             Uf = U_C;
         }
-        if (Uf > std::min(REF, U_R)) {
-            Uf = std::min(REF, U_R);
+        if (Uf > (std::min)(REF, U_R)) {
+            Uf = (std::min)(REF, U_R);
         }
     }
     else {
         if (Uf > U_C) {
             Uf = U_C;
         }
-        if (Uf < std::max(REF, U_R)) {
-            Uf = std::max(REF, U_R);
+        if (Uf < (std::max)(REF, U_R)) {
+            Uf = (std::max)(REF, U_R);
         }
     }
     return Uf;
@@ -192,12 +246,15 @@ inline double quickest_ultimate_border_approximation(double U_L, double U_C, dou
 
 /// @brief Солвер на основе QUICK, только для размерности 1!
 /// [Leonard 1979]
-class quick_fv_solver {
+template <typename Traits>
+class quick_fv_solver_t {
 public:
-    typedef typename quick_fv_solver_traits<1>::var_layer_data var_layer_data;
-    typedef typename quick_fv_solver_traits<1>::specific_layer specific_layer;
+    typedef typename Traits::var_layer_data var_layer_data;
+    typedef typename Traits::specific_layer specific_layer;
     typedef typename fixed_system_types<1>::matrix_type matrix_type;
     typedef typename fixed_system_types<1>::var_type vector_type;
+    /// @brief Тип значений переменных (потоки и арифметика шага - в double)
+    typedef typename var_layer_data::scalar_type scalar_type;
 protected:
     /// @brief ДУЧП
     pde_t<1>& pde;
@@ -219,9 +276,19 @@ public:
     /// Из буфера берется current() и previous()
     /// @param pde ДУЧП
     /// @param buffer Буфер слоев
-    quick_fv_solver(pde_t<1>& pde,
+    quick_fv_solver_t(pde_t<1>& pde,
         ring_buffer_t<composite_layer_t<var_layer_data, specific_layer>>& buffer)
-        : quick_fv_solver(pde, buffer.previous(), buffer.current())
+        : quick_fv_solver_t(pde, buffer.previous(), buffer.current())
+    {}
+
+    /// @brief Конструктор для буфера слоев фиксированного размера (см. fixed_ring_buffer_t)
+    /// Из буфера берется current() и previous()
+    /// @param pde ДУЧП
+    /// @param buffer Буфер слоев
+    template <size_t LayerCount>
+    quick_fv_solver_t(pde_t<1>& pde,
+        fixed_ring_buffer_t<composite_layer_t<var_layer_data, specific_layer>, LayerCount>& buffer)
+        : quick_fv_solver_t(pde, buffer.previous(), buffer.current())
     {}
 
     /// @brief Конструктор для простых слоев - 
@@ -229,7 +296,7 @@ public:
     /// @param pde ДУЧП
     /// @param prev Предыдущий слой (уже рассчитанный)
     /// @param curr Следующий (новый), для которого требуется сделать расчет
-    quick_fv_solver(pde_t<1>& pde,
+    quick_fv_solver_t(pde_t<1>& pde,
         const composite_layer_t<var_layer_data, specific_layer>& prev,
         composite_layer_t<var_layer_data, specific_layer>& curr)
         : pde(pde)
@@ -246,7 +313,8 @@ public:
     /// @param dt Заданный период времени
     /// @param u_in Левое граничное условие
     /// @param u_out Правое граничное условие
-    void step(double dt, double u_in, double u_out) {
+    /// @param decomposition Разбиение сетки для параллельного расчета (nullptr - последовательный расчет)
+    void step(double dt, double u_in, double u_out, const domain_decomposition_t* decomposition = nullptr) {
         auto& F = curr_spec.point_double[0]; // потоки на границах ячеек
         const auto& U = prev_vars.cell_double[0];
         auto& U_new = curr_vars.cell_double[0];
@@ -264,57 +332,73 @@ public:
         double v_pipe = pde.getEquationsCoeffs(0, U[0]);//не совсем корректно, скорость в ячейке берется из скорости на ее левой границе
         // Расчет потоков на границе по правилу QUICK
         if (v_pipe >= 0) {
-            for (size_t cell = 0; cell < U.size(); ++cell) {
-                size_t right_border = cell + 1;
-                double Vb = v_pipe; // предположили, что скорость на границе во всех точках трубы одна и та же
-                double Ub;
-                if (cell == 0) {
-                    Ub = quick_border_approximation(U[cell], U[cell], U[cell + 1]); // костыль U_L = U_C
+            for_each_subdomain(decomposition, 0, U.size(), [&](size_t cell_begin, size_t cell_end) {
+                for (size_t cell = cell_begin; cell < cell_end; ++cell) {
+                    size_t right_border = cell + 1;
+                    double Vb = v_pipe; // предположили, что скорость на границе во всех точках трубы одна и та же
+                    double Ub;
+                    if (cell == 0) {
+                        Ub = quick_border_approximation(U[cell], U[cell], U[cell + 1]); // костыль U_L = U_C
+                    }
+                    else if (cell == U.size() - 1) {
+                        Ub = quick_border_approximation(U[cell - 1], U[cell], U[cell]); // костыль U_R = U_C
+                    }
+                    else {
+                        Ub = quick_border_approximation(U[cell - 1], U[cell], U[cell + 1]); // честный расчет
+                    }
+                    F[right_border] = Ub * Vb;
                 }
-                else if (cell == U.size() - 1) {
-                    Ub = quick_border_approximation(U[cell - 1], U[cell], U[cell]); // костыль U_R = U_C
-                }
-                else {
-                    Ub = quick_border_approximation(U[cell - 1], U[cell], U[cell + 1]); // честный расчет
-                }
-                F[right_border] = Ub * Vb;
-            }
+            });
         }
         else {
-            for (size_t cell = 0; cell < U.size(); ++cell) {
-                size_t left_border = cell;
-                double Vb = v_pipe; // предположили, что скорость на границе во всех точках трубы одна и та же
-                double Ub;
-                if (cell == 0) {
-                    Ub = quick_border_approximation(U[cell + 1], U[cell], U[cell]); // костыль U_L = U_C
-                }
-                else if (cell == U.size() - 1) {
-                    Ub = quick_border_approximation(U[cell], U[cell], U[cell - 1]); // костыль U_R = U_C
-                }
-                else {
-                    Ub = quick_border_approximation(U[cell + 1], U[cell], U[cell - 1]); // честный расчет
+            for_each_subdomain(decomposition, 0, U.size(), [&](size_t cell_begin, size_t cell_end) {
+                for (size_t cell = cell_begin; cell < cell_end; ++cell) {
+                    size_t left_border = cell;
+                    double Vb = v_pipe; // предположили, что скорость на границе во всех точках трубы одна и та же
+                    double Ub;
+                    if (cell == 0) {
+                        Ub = quick_border_approximation(U[cell + 1], U[cell], U[cell]); // костыль U_L = U_C
+                    }
+                    else if (cell == U.size() - 1) {
+                        Ub = quick_border_approximation(U[cell], U[cell], U[cell - 1]); // костыль U_R = U_C
+                    }
+                    else {
+                        Ub = quick_border_approximation(U[cell + 1], U[cell], U[cell - 1]); // честный расчет
+                    }
+                    F[left_border] = Ub * Vb;
                 }
-                F[left_border] = Ub * Vb;
-            }
+            });
 
         }
 
-        for (size_t cell = 0; cell < U.size(); ++cell) {
-            double dx = grid[cell + 1] - grid[cell]; // ячейки обычно одинаковой длины, но мало ли..
-            U_new[cell] = U[cell] + dt / dx * ((F[cell] - F[cell + 1]));
-        }
+        for_each_subdomain(decomposition, 0, U.size(), [&](size_t cell_begin, size_t cell_end) {
+            for (size_t cell = cell_begin; cell < cell_end; ++cell) {
+                double dx = grid[cell + 1] - grid[cell]; // ячейки обычно одинаковой длины, но мало ли..
+                U_new[cell] = static_cast<scalar_type>(U[cell] + dt / dx * ((F[cell] - F[cell + 1])));
+            }
+        });
 
     }
 };
 
+/// @brief Солвер quick_fv_solver_t для слоев на std::vector
+typedef quick_fv_solver_t<quick_fv_solver_traits<1>> quick_fv_solver;
+
+/// @brief Солвер quick_fv_solver_t для слоев фиксированного размера (см. fixed_fv_solver_traits)
+template <size_t PointCount>
+using fixed_quick_fv_solver = quick_fv_solver_t<fixed_fv_solver_traits<PointCount>>;
+
 /// @brief Солвер на основе QUICKEST, только для размерности 1!
 /// [Neumann 2011]
-class quickest_fv_solver {
+template <typename Traits>
+class quickest_fv_solver_t {
 public:
-    typedef typename quickest_fv_solver_traits<1>::var_layer_data var_layer_data;
-    typedef typename quickest_fv_solver_traits<1>::specific_layer specific_layer;
+    typedef typename Traits::var_layer_data var_layer_data;
+    typedef typename Traits::specific_layer specific_layer;
     typedef typename fixed_system_types<1>::matrix_type matrix_type;
     typedef typename fixed_system_types<1>::var_type vector_type;
+    /// @brief Тип значений переменных (потоки и арифметика шага - в double)
+    typedef typename var_layer_data::scalar_type scalar_type;
 protected:
     /// @brief ДУЧП
     pde_t<1>& pde;
@@ -336,9 +420,19 @@ public:
     /// Из буфера берется current() и previous()
     /// @param pde ДУЧП
     /// @param buffer Буфер слоев
-    quickest_fv_solver(pde_t<1>& pde,
+    quickest_fv_solver_t(pde_t<1>& pde,
         ring_buffer_t<composite_layer_t<var_layer_data, specific_layer>>& buffer)
-        : quickest_fv_solver(pde, buffer.previous(), buffer.current())
+        : quickest_fv_solver_t(pde, buffer.previous(), buffer.current())
+    {}
+
+    /// @brief Конструктор для буфера слоев фиксированного размера (см. fixed_ring_buffer_t)
+    /// Из буфера берется current() и previous()
+    /// @param pde ДУЧП
+    /// @param buffer Буфер слоев
+    template <size_t LayerCount>
+    quickest_fv_solver_t(pde_t<1>& pde,
+        fixed_ring_buffer_t<composite_layer_t<var_layer_data, specific_layer>, LayerCount>& buffer)
+        : quickest_fv_solver_t(pde, buffer.previous(), buffer.current())
     {}
 
     /// @brief Конструктор для простых слоев - 
@@ -346,7 +440,7 @@ public:
     /// @param pde ДУЧП
     /// @param prev Предыдущий слой (уже рассчитанный)
     /// @param curr Следующий (новый), для которого требуется сделать расчет
-    quickest_fv_solver(pde_t<1>& pde,
+    quickest_fv_solver_t(pde_t<1>& pde,
         const composite_layer_t<var_layer_data, specific_layer>& prev,
         composite_layer_t<var_layer_data, specific_layer>& curr)
         : pde(pde)
@@ -363,7 +457,8 @@ public:
     /// @param dt Заданный период времени
     /// @param u_in Левое граничное условие
     /// @param u_out Правое граничное условие
-    void step(double dt, double u_in, double u_out) {
+    /// @param decomposition Разбиение сетки для параллельного расчета (nullptr - последовательный расчет)
+    void step(double dt, double u_in, double u_out, const domain_decomposition_t* decomposition = nullptr) {
         auto& F = curr_spec.point_double[0]; // потоки на границах ячеек
         const auto& U = prev_vars.cell_double[0];
         auto& U_new = curr_vars.cell_double[0];
@@ -381,64 +476,77 @@ public:
         double v_pipe = pde.getEquationsCoeffs(0, U[0]);//не совсем корректно, скорость в ячейке берется из скорости на ее левой границе
         // Расчет потоков на границе по правилу QUICK
         if (v_pipe >= 0) {
-            for (size_t cell = 0; cell < U.size(); ++cell) {
-                size_t right_border = cell + 1;
-                double Vb = v_pipe; // предположили, что скорость на границе во всех точках трубы одна и та же
-                double Ub;
-                if (cell == 0) {
-                    Ub = quickest_border_approximation(U[cell], U[cell], U[cell + 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_L = U_C
-                }
-                else if (cell == U.size() - 1) {
-                    Ub = quickest_border_approximation(U[cell - 1], U[cell], U[cell], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_R = U_C
+            for_each_subdomain(decomposition, 0, U.size(), [&](size_t cell_begin, size_t cell_end) {
+                for (size_t cell = cell_begin; cell < cell_end; ++cell) {
+                    size_t right_border = cell + 1;
+                    double Vb = v_pipe; // предположили, что скорость на границе во всех точках трубы одна и та же
+                    double Ub;
+                    if (cell == 0) {
+                        Ub = quickest_border_approximation(U[cell], U[cell], U[cell + 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_L = U_C
+                    }
+                    else if (cell == U.size() - 1) {
+                        Ub = quickest_border_approximation(U[cell - 1], U[cell], U[cell], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_R = U_C
+                    }
+                    else {
+                        Ub = quickest_border_approximation(U[cell - 1], U[cell], U[cell + 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // честный расчет
+                    }
+                    F[right_border] = Ub * Vb;
                 }
-                else {
-                    Ub = quickest_border_approximation(U[cell - 1], U[cell], U[cell + 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // честный расчет
-                }
-                F[right_border] = Ub * Vb;
-            }
+            });
         }
         else {
-            for (size_t cell = 0; cell < U.size(); ++cell) {
-                size_t left_border = cell;
-                double Vb = v_pipe; // предположили, что скорость на границе во всех точках трубы одна и та же
-                double Ub;
-                if (cell == 0) {
-                    Ub = quickest_border_approximation(U[cell + 1], U[cell], U[cell], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_L = U_C
+            for_each_subdomain(decomposition, 0, U.size(), [&](size_t cell_begin, size_t cell_end) {
+                for (size_t cell = cell_begin; cell < cell_end; ++cell) {
+                    size_t left_border = cell;
+                    double Vb = v_pipe; // предположили, что скорость на границе во всех точках трубы одна и та же
+                    double Ub;
+                    if (cell == 0) {
+                        Ub = quickest_border_approximation(U[cell + 1], U[cell], U[cell], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_L = U_C
+                    }
+                    else if (cell == U.size() - 1) {
+                        Ub = quickest_border_approximation(U[cell], U[cell], U[cell - 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_R = U_C
+                    }
+                    else {
+                        Ub = quickest_border_approximation(U[cell + 1], U[cell], U[cell - 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // честный расчет
+                    }
+                    F[left_border] = Ub * Vb;
                 }
-                else if (cell == U.size() - 1) {
-                    Ub = quickest_border_approximation(U[cell], U[cell], U[cell - 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_R = U_C
-                }
-                else {
-                    Ub = quickest_border_approximation(U[cell + 1], U[cell], U[cell - 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // честный расчет
-                }
-                F[left_border] = Ub * Vb;
-            }
+            });
 
         }
 
-        for (size_t cell = 0; cell < U.size(); ++cell) {
-            double dx = grid[cell + 1] - grid[cell]; // ячейки обычно одинаковой длины, но мало ли..
-            U_new[cell] = U[cell] + dt / dx * ((F[cell] - F[cell + 1]));
-        }
+        for_each_subdomain(decomposition, 0, U.size(), [&](size_t cell_begin, size_t cell_end) {
+            for (size_t cell = cell_begin; cell < cell_end; ++cell) {
+                double dx = grid[cell + 1] - grid[cell]; // ячейки обычно одинаковой длины, но мало ли..
+                U_new[cell] = static_cast<scalar_type>(U[cell] + dt / dx * ((F[cell] - F[cell + 1])));
+            }
+        });
 
     }
 };
 
-template <size_t Dimension>
+/// @brief Солвер quickest_fv_solver_t для слоев на std::vector
+typedef quickest_fv_solver_t<quickest_fv_solver_traits<1>> quickest_fv_solver;
+
+/// @brief Солвер quickest_fv_solver_t для слоев фиксированного размера (см. fixed_fv_solver_traits)
+template <size_t PointCount>
+using fixed_quickest_fv_solver = quickest_fv_solver_t<fixed_fv_solver_traits<PointCount>>;
+
+template <size_t Dimension, typename Scalar = double>
 struct quickest_ultimate_fv_wrapper;
 
 /// @brief Обертка над составным слоем
-template <>
-struct quickest_ultimate_fv_wrapper<1> {
+template <typename Scalar>
+struct quickest_ultimate_fv_wrapper<1, Scalar> {
     typedef typename quickest_ultimate_fv_solver_traits<1>::specific_layer specific_layer;
     
     /// @brief Значения рассчитываемых параметров
-    std::vector<double>& vars;
+    std::vector<Scalar>& vars;
     /// @brief Специфический слой
     specific_layer& specific;
 
     quickest_ultimate_fv_wrapper(
-        vector<double>& U,
+        vector<Scalar>& U,
         specific_layer& specific
     )
         : vars(U)
@@ -448,12 +556,15 @@ struct quickest_ultimate_fv_wrapper<1> {
 
 /// @brief Солвер на основе QUICKEST-ULTIMATE, только для размерности 1!
 /// [Leonard 1991]
-class quickest_ultimate_fv_solver {
+template <typename Traits>
+class quickest_ultimate_fv_solver_t {
 public:
-    typedef typename quickest_ultimate_fv_solver_traits<1>::var_layer_data var_layer_data;
-    typedef typename quickest_ultimate_fv_solver_traits<1>::specific_layer specific_layer;
+    typedef typename Traits::var_layer_data var_layer_data;
+    typedef typename Traits::specific_layer specific_layer;
     typedef typename fixed_system_types<1>::matrix_type matrix_type;
     typedef typename fixed_system_types<1>::var_type vector_type;
+    /// @brief Тип значений переменных (потоки и арифметика шага - в double)
+    typedef typename var_layer_data::scalar_type scalar_type;
 protected:
     /// @brief ДУЧП
     pde_t<1>& pde;
@@ -462,9 +573,9 @@ protected:
     /// @brief Количество точек сетки
     const size_t n;
     /// @brief Предыдущий слой переменных
-    const vector<double>& prev_vars;
+    const typename var_layer_data::cell_profile_type& prev_vars;
     /// @brief Новый (рассчитываемый) слой переменных
-    vector<double>& curr_vars;
+    typename var_layer_data::cell_profile_type& curr_vars;
     /// @brief Предыдущий специфический слой (сейчас не нужен! нужен ли в будущем?)
     const specific_layer& prev_spec;
     /// @brief Текущий специфический слой
@@ -475,9 +586,19 @@ public:
     /// Из буфера берется current() и previous()
     /// @param pde ДУЧП
     /// @param buffer Буфер слоев
-    quickest_ultimate_fv_solver(pde_t<1>& pde,
+    quickest_ultimate_fv_solver_t(pde_t<1>& pde,
         ring_buffer_t<composite_layer_t<var_layer_data, specific_layer>>& buffer)
-        : quickest_ultimate_fv_solver(pde, buffer.previous(), buffer.current())
+        : quickest_ultimate_fv_solver_t(pde, buffer.previous(), buffer.current())
+    {}
+
+    /// @brief Конструктор для буфера слоев фиксированного размера (см. fixed_ring_buffer_t)
+    /// Из буфера берется current() и previous()
+    /// @param pde ДУЧП
+    /// @param buffer Буфер слоев
+    template <size_t LayerCount>
+    quickest_ultimate_fv_solver_t(pde_t<1>& pde,
+        fixed_ring_buffer_t<composite_layer_t<var_layer_data, specific_layer>, LayerCount>& buffer)
+        : quickest_ultimate_fv_solver_t(pde, buffer.previous(), buffer.current())
     {}
 
     /// @brief Конструктор для простых слоев - 
@@ -485,7 +606,7 @@ public:
     /// @param pde ДУЧП
     /// @param prev Предыдущий слой (уже рассчитанный)
     /// @param curr Следующий (новый), для которого требуется сделать расчет
-    quickest_ultimate_fv_solver(pde_t<1>& pde,
+    quickest_ultimate_fv_solver_t(pde_t<1>& pde,
         const composite_layer_t<var_layer_data, specific_layer>& prev,
         composite_layer_t<var_layer_data, specific_layer>& curr)
         : pde(pde)
@@ -502,8 +623,8 @@ public:
     /// (созданного с помощью ring_buffer_t::get_custom_buffer)
     /// @param pde ДУЧП
     /// @param wrapper Буфер оберток
-    quickest_ultimate_fv_solver(pde_t<1>& pde,
-        ring_buffer_t<quickest_ultimate_fv_wrapper<1>>& wrapper)
+    quickest_ultimate_fv_solver_t(pde_t<1>& pde,
+        ring_buffer_t<quickest_ultimate_fv_wrapper<1, scalar_type>>& wrapper)
         : pde(pde)
         , grid(pde.get_grid())
         , n(pde.get_grid().size())
@@ -514,8 +635,9 @@ public:
     {}
     /// @brief Конструктор, заточенный для удобства выдергивания специфического слоя, если он один в буфере
     /// Очень специфический
-    quickest_ultimate_fv_solver(pde_t<1>& pde,
-        const vector<double>& prev_vars, vector<double>& curr_vars,
+    quickest_ultimate_fv_solver_t(pde_t<1>& pde,
+        const typename var_layer_data::cell_profile_type& prev_vars,
+        typename var_layer_data::cell_profile_type& curr_vars,
         const specific_layer& prev_spec, specific_layer& curr_spec)
         : pde(pde)
         , grid(pde.get_grid())
@@ -532,7 +654,8 @@ public:
     /// @param dt Заданный период времени
     /// @param u_in Левое граничное условие
     /// @param u_out Правое граничное условие
-    void step(double dt, double u_in, double u_out) {
+    /// @param decomposition Разбиение сетки для параллельного расчета (nullptr - последовательный расчет)
+    void step(double dt, double u_in, double u_out, const domain_decomposition_t* decomposition = nullptr) {
         auto& F = curr_spec.point_double[0]; // потоки на границах ячеек
         const auto& U = prev_vars;
         auto& U_new = curr_vars;
@@ -550,51 +673,64 @@ public:
         double v_pipe = pde.getEquationsCoeffs(0, U[0]);//не совсем корректно, скорость в ячейке берется из скорости на ее левой границе
         // Расчет потоков на границе по правилу QUICK
         if (v_pipe >= 0) {
-            for (size_t cell = 0; cell < U.size(); ++cell) {
-                size_t right_border = cell + 1;
-                double Vb = v_pipe; // предположили, что скорость на границе во всех точках трубы одна и та же
-                double Ub;
-                if (cell == 0) {
-                    Ub = quickest_ultimate_border_approximation(U[cell], U[cell], U[cell + 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_L = U_C
-                }
-                else if (cell == U.size() - 1) {
-                    Ub = quickest_ultimate_border_approximation(U[cell - 1], U[cell], U[cell], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_R = U_C
-                }
-                else {
-                    Ub = quickest_ultimate_border_approximation(U[cell - 1], U[cell], U[cell + 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // честный расчет
+            for_each_subdomain(decomposition, 0, U.size(), [&](size_t cell_begin, size_t cell_end) {
+                for (size_t cell = cell_begin; cell < cell_end; ++cell) {
+                    size_t right_border = cell + 1;
+                    double Vb = v_pipe; // предположили, что скорость на границе во всех точках трубы одна и та же
+                    double Ub;
+                    if (cell == 0) {
+                        Ub = quickest_ultimate_border_approximation(U[cell], U[cell], U[cell + 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_L = U_C
+                    }
+                    else if (cell == U.size() - 1) {
+                        Ub = quickest_ultimate_border_approximation(U[cell - 1], U[cell], U[cell], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_R = U_C
+                    }
+                    else {
+                        Ub = quickest_ultimate_border_approximation(U[cell - 1], U[cell], U[cell + 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // честный расчет
+                    }
+                    F[right_border] = Ub * Vb;
                 }
-                F[right_border] = Ub * Vb;
-            }
+            });
         }
         else {
-            for (size_t cell = 0; cell < U.size(); ++cell) {
-                size_t left_border = cell;
-                double Vb = v_pipe; // предположили, что скорость на границе во всех точках трубы одна и та же
-                double Ub;
-                if (cell == 0) {
-                    Ub = quickest_ultimate_border_approximation(U[cell + 1], U[cell], U[cell], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_L = U_C
-                }
-                else if (cell == U.size() - 1) {
-                    Ub = quickest_ultimate_border_approximation(U[cell], U[cell], U[cell - 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_R = U_C
+            for_each_subdomain(decomposition, 0, U.size(), [&](size_t cell_begin, size_t cell_end) {
+                for (size_t cell = cell_begin; cell < cell_end; ++cell) {
+                    size_t left_border = cell;
+                    double Vb = v_pipe; // предположили, что скорость на границе во всех точках трубы одна и та же
+                    double Ub;
+                    if (cell == 0) {
+                        Ub = quickest_ultimate_border_approximation(U[cell + 1], U[cell], U[cell], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_L = U_C
+                    }
+                    else if (cell == U.size() - 1) {
+                        Ub = quickest_ultimate_border_approximation(U[cell], U[cell], U[cell - 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // костыль U_R = U_C
+                    }
+                    else {
+                        Ub = quickest_ultimate_border_approximation(U[cell + 1], U[cell], U[cell - 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // честный расчет
+                    }
+                    F[left_border] = Ub * Vb;
                 }
-                else {
-                    Ub = quickest_ultimate_border_approximation(U[cell + 1], U[cell], U[cell - 1], 0, grid[cell + 1] - grid[cell], dt, v_pipe); // честный расчет
-                }
-                F[left_border] = Ub * Vb;
-            }
+            });
 
         }
 
-        for (size_t cell = 0; cell < U.size(); ++cell) {
-            double dx = grid[cell + 1] - grid[cell]; // ячейки обычно одинаковой длины, но мало ли..
-            double Cr = v_in * dt / dx;
-            if (Cr > 1) {
-                throw std::runtime_error("Quickest-ultimate is called with Cr > 1");
+        for_each_subdomain(decomposition, 0, U.size(), [&](size_t cell_begin, size_t cell_end) {
+            for (size_t cell = cell_begin; cell < cell_end; ++cell) {
+                double dx = grid[cell + 1] - grid[cell]; // ячейки обычно одинаковой длины, но мало ли..
+                double Cr = v_in * dt / dx;
+                if (Cr > 1) {
+                    throw std::runtime_error("Quickest-ultimate is called with Cr > 1");
+                }
+                U_new[cell] = static_cast<scalar_type>(U[cell] + dt / dx * ((F[cell] - F[cell + 1])));
             }
-            U_new[cell] = U[cell] + dt / dx * ((F[cell] - F[cell + 1]));
-        }
+        });
 
     }
 };
 
+/// @brief Солвер quickest_ultimate_fv_solver_t для слоев на std::vector
+typedef quickest_ultimate_fv_solver_t<quickest_ultimate_fv_solver_traits<1>> quickest_ultimate_fv_solver;
+
+/// @brief Солвер quickest_ultimate_fv_solver_t для слоев фиксированного размера (см. fixed_fv_solver_traits)
+template <size_t PointCount>
+using fixed_quickest_ultimate_fv_solver = quickest_ultimate_fv_solver_t<fixed_fv_solver_traits<PointCount>>;
+
 }
\ No newline at end of file
@@ -0,0 +1,457 @@
+﻿#pragma once
+
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "isothermal_quasistatic_task.h"
+#include "../core/thread_pool.h"
+
+namespace pde_solvers {
+;
+
+/// @brief Труба сети: модель трубопровода и узлы, которые она соединяет (течение от from_node к to_node)
+struct isothermal_network_pipe_t {
+    /// @brief Модель трубопровода
+    pipe_properties_t pipe;
+    /// @brief Узел начала трубы
+    size_t from_node{ 0 };
+    /// @brief Узел конца трубы
+    size_t to_node{ 0 };
+};
+
+/// @brief Краевые условия квазистационарного расчета сети
+/// Узлы-источники - узлы без входящих труб. Для них задаются давление, плотность и вязкость
+/// Значения источников в остальных узлах не используются
+struct isothermal_quasistatic_network_boundaries_t {
+    /// @brief Объемные расходы по трубам (в направлении от from_node к to_node, неотрицательные)
+    vector<double> volumetric_flows;
+    /// @brief Давления в узлах-источниках
+    vector<double> source_pressures;
+    /// @brief Плотности в узлах-источниках
+    vector<double> source_densities;
+    /// @brief Вязкости в узлах-источниках
+    vector<double> source_viscosities;
+    /// @brief Приращения давления в узлах (насос - положительное, дросселирование на задвижке -
+    /// отрицательное). Не задано - нулевые
+    vector<double> pressure_increments;
+};
+
+/// @brief Расчетная задача для гидравлического изотермического квазистационарного расчета
+/// сети труб, соединенных в узлах, в условиях движения партий
+/// Каждая труба рассчитывается своей задачей isothermal_quasistatic_task_t со своим буфером слоев
+/// Шаг по времени состоит из фаз:
+/// 1. Последовательно: смешение в узлах - плотность и вязкость на входе труб как средневзвешенные
+/// по расходу значения на выходе входящих труб (с предыдущего шага); если расход по всем
+/// входящим трубам нулевой - как среднее арифметическое значений на их выходе
+/// 2. Параллельно по всем трубам: шаг движения партий
+/// 3. Параллельно по всем трубам: профили давления от нулевого давления на входе (градиент давления
+/// не зависит от давления, поэтому перепад давления по трубе не зависит от давления в узле)
+/// 4. Последовательно по уровням сети от источников: давления в узлах, O(количество труб).
+/// Давление в узле берется на выходе первой входящей трубы плюс приращение узла
+/// 5. Параллельно по всем трубам: сдвиг профилей давления на давление в начальном узле трубы
+/// Ограничения: расходы по трубам задаются (баланс расходов в узлах не проверяется) и не могут
+/// быть отрицательными - направление трубы (from_node -> to_node) должно совпадать с течением,
+/// сеть не должна содержать циклов, при нескольких входящих трубах давления на их выходах
+/// не согласуются - используется давление первой входящей трубы, а расхождение давлений
+/// доступно через get_node_pressure_mismatches()
+/// @tparam Solver Тип солвера партий (advection_moc_solver или quickest_ultimate_fv_solver)
+template <typename Solver>
+class isothermal_quasistatic_network_task_t {
+public:
+    typedef isothermal_quasistatic_task_t<Solver> pipe_task_type;
+private:
+    /// @brief Узлы начала и конца труб
+    vector<std::pair<size_t, size_t>> pipe_nodes;
+    /// @brief Задачи расчета труб (в порядке труб)
+    vector<pipe_task_type> pipe_tasks;
+    /// @brief Входящие трубы узлов
+    vector<vector<size_t>> incoming_pipes;
+    /// @brief Конечные узлы (без исходящих труб)
+    vector<size_t> sink_nodes;
+    /// @brief Трубы по уровням: трубы уровня level выходят из узлов, давление в которых
+    /// известно после расчета труб предыдущих уровней
+    vector<vector<size_t>> pipe_levels;
+    /// @brief Давления в узлах
+    vector<double> node_pressures;
+    /// @brief Давления на входе труб, еще не добавленные к их профилям давления (фазы 3-5 шага)
+    vector<double> pipe_pressure_offsets;
+    /// @brief Наибольшее отклонение давления на выходе входящих труб от давления первой входящей трубы
+    vector<double> node_pressure_mismatches;
+    /// @brief Плотности в узлах после смешения
+    vector<double> node_densities;
+    /// @brief Вязкости в узлах после смешения
+    vector<double> node_viscosities;
+    /// @brief Пул потоков для расчета труб
+    std::unique_ptr<thread_pool_t> pool;
+
+private:
+    /// @brief Разбиение труб на уровни (топологическая сортировка узлов)
+    void build_pipe_levels()
+    {
+        size_t node_count = incoming_pipes.size();
+        vector<size_t> node_levels(node_count, 0);
+        vector<size_t> unresolved_inputs(node_count);
+        vector<vector<size_t>> outgoing_pipes(node_count);
+        for (size_t node = 0; node < node_count; ++node) {
+            unresolved_inputs[node] = incoming_pipes[node].size();
+        }
+        for (size_t pipe = 0; pipe < pipe_nodes.size(); ++pipe) {
+            outgoing_pipes[pipe_nodes[pipe].first].push_back(pipe);
+        }
+        for (size_t node = 0; node < node_count; ++node) {
+            if (outgoing_pipes[node].empty()) {
+                sink_nodes.push_back(node);
+            }
+        }
+
+        vector<size_t> ready_nodes;
+        for (size_t node = 0; node < node_count; ++node) {
+            if (unresolved_inputs[node] == 0) {
+                ready_nodes.push_back(node);
+            }
+        }
+
+        size_t resolved_pipes = 0;
+        while (!ready_nodes.empty()) {
+            size_t node = ready_nodes.back();
+            ready_nodes.pop_back();
+            size_t level = node_levels[node];
+            for (size_t pipe : outgoing_pipes[node]) {
+                if (pipe_levels.size() <= level) {
+                    pipe_levels.resize(level + 1);
+                }
+                pipe_levels[level].push_back(pipe);
+                resolved_pipes++;
+
+                size_t to_node = pipe_nodes[pipe].second;
+                node_levels[to_node] = (std::max)(node_levels[to_node], level + 1);
+                if (--unresolved_inputs[to_node] == 0) {
+                    ready_nodes.push_back(to_node);
+                }
+            }
+        }
+        if (resolved_pipes != pipe_nodes.size()) {
+            throw std::logic_error("isothermal_quasistatic_network_task_t: network contains a cycle");
+        }
+    }
+
+    /// @brief Текущий слой трубы только для чтения
+    /// Неконстантный доступ скопировал бы слой, разделяемый с ответвлением задачи трубы
+    const auto& get_current_layer(size_t pipe) const
+    {
+        return std::as_const(pipe_tasks[pipe]).get_buffer().current();
+    }
+
+    /// @brief Давление на выходе трубы с учетом еще не добавленного к профилю давления на входе
+    double get_outlet_pressure(size_t pipe) const
+    {
+        return pipe_pressure_offsets[pipe] + get_current_layer(pipe).pressure.back();
+    }
+
+    /// @brief Смешение в узле по значениям на выходе входящих труб
+    /// Для узлов-источников берутся значения из краевых условий
+    void mix_node(size_t node, const isothermal_quasistatic_network_boundaries_t& boundaries)
+    {
+        const vector<size_t>& incoming = incoming_pipes[node];
+        if (incoming.empty()) {
+            node_densities[node] = boundaries.source_densities[node];
+            node_viscosities[node] = boundaries.source_viscosities[node];
+            return;
+        }
+
+        double total_flow = 0;
+        double density = 0;
+        double viscosity = 0;
+        for (size_t pipe : incoming) {
+            const auto& current = get_current_layer(pipe);
+            double flow = boundaries.volumetric_flows[pipe];
+            total_flow += flow;
+            density += flow * current.density.back();
+            viscosity += flow * current.viscosity.back();
+        }
+        if (total_flow > 0) {
+            node_densities[node] = density / total_flow;
+            node_viscosities[node] = viscosity / total_flow;
+        }
+        else {
+            // Течения нет - веса не определены, берется среднее по входящим трубам
+            density = 0;
+            viscosity = 0;
+            for (size_t pipe : incoming) {
+                const auto& current = get_current_layer(pipe);
+                density += current.density.back();
+                viscosity += current.viscosity.back();
+            }
+            node_densities[node] = density / incoming.size();
+            node_viscosities[node] = viscosity / incoming.size();
+        }
+    }
+
+    /// @brief Давление в узле: источник или выход первой входящей трубы плюс приращение узла
+    /// Отклонение давлений на выходе остальных входящих труб запоминается в node_pressure_mismatches
+    void calc_node_pressure(size_t node, const isothermal_quasistatic_network_boundaries_t& boundaries)
+    {
+        const vector<size_t>& incoming = incoming_pipes[node];
+        double pressure = incoming.empty()
+            ? boundaries.source_pressures[node]
+            : get_outlet_pressure(incoming.front());
+        double mismatch = 0;
+        for (size_t pipe : incoming) {
+            double outlet_pressure = get_outlet_pressure(pipe);
+            mismatch = (std::max)(mismatch, std::abs(outlet_pressure - pressure));
+        }
+        node_pressure_mismatches[node] = mismatch;
+        if (!boundaries.pressure_increments.empty()) {
+            pressure += boundaries.pressure_increments[node];
+        }
+        node_pressures[node] = pressure;
+    }
+
+    /// @brief Краевые условия трубы по значениям в ее начальном узле
+    isothermal_quasistatic_task_boundaries_t get_pipe_boundaries(size_t pipe,
+        const isothermal_quasistatic_network_boundaries_t& boundaries) const
+    {
+        size_t node = pipe_nodes[pipe].first;
+        isothermal_quasistatic_task_boundaries_t result;
+        result.volumetric_flow = boundaries.volumetric_flows[pipe];
+        result.pressure_in = node_pressures[node];
+        result.density = node_densities[node];
+        result.viscosity = node_viscosities[node];
+        return result;
+    }
+
+    /// @brief Проверка размеров краевых условий
+    void check_boundaries(const isothermal_quasistatic_network_boundaries_t& boundaries) const
+    {
+        size_t node_count = incoming_pipes.size();
+        if (boundaries.volumetric_flows.size() != pipe_nodes.size() ||
+            boundaries.source_pressures.size() != node_count ||
+            boundaries.source_densities.size() != node_count ||
+            boundaries.source_viscosities.size() != node_count ||
+            (!boundaries.pressure_increments.empty() && boundaries.pressure_increments.size() != node_count))
+        {
+            throw std::logic_error("isothermal_quasistatic_network_task_t: wrong boundaries size");
+        }
+        // Уровни расчета и смешение в узлах построены для течения от from_node к to_node
+        for (double flow : boundaries.volumetric_flows) {
+            if (flow < 0) {
+                throw std::logic_error("isothermal_quasistatic_network_task_t: negative volumetric flow, "
+                    "pipe direction must follow the flow");
+            }
+        }
+    }
+
+public:
+    /// @brief Конструктор
+    /// @param pipes Трубы сети
+    /// @param node_count Количество узлов
+    /// @param thread_count Количество потоков для расчета труб
+    isothermal_quasistatic_network_task_t(const vector<isothermal_network_pipe_t>& pipes, size_t node_count,
+        size_t thread_count = std::thread::hardware_concurrency())
+        : incoming_pipes(node_count)
+        , node_pressures(node_count, 0.0)
+        , node_pressure_mismatches(node_count, 0.0)
+        , node_densities(node_count, 0.0)
+        , node_viscosities(node_count, 0.0)
+        , pool(std::make_unique<thread_pool_t>(thread_count))
+    {
+        pipe_pressure_offsets.resize(pipes.size(), 0.0);
+        pipe_tasks.reserve(pipes.size());
+        for (size_t pipe = 0; pipe < pipes.size(); ++pipe) {
+            if (pipes[pipe].from_node >= node_count || pipes[pipe].to_node >= node_count) {
+                throw std::logic_error("isothermal_quasistatic_network_task_t: wrong pipe node index");
+            }
+            pipe_nodes.emplace_back(pipes[pipe].from_node, pipes[pipe].to_node);
+            incoming_pipes[pipes[pipe].to_node].push_back(pipe);
+            pipe_tasks.emplace_back(pipes[pipe].pipe);
+        }
+        build_pipe_levels();
+    }
+
+    /// @brief Начальный стационарный расчёт
+    /// Трубы рассчитываются по уровням: плотность и вязкость в узле - смешение входящих труб
+    /// (в стационаре на их выходе значения из начального узла), давление - с выхода первой входящей трубы
+    /// @param initial_conditions Начальные условия
+    void solve(const isothermal_quasistatic_network_boundaries_t& initial_conditions)
+    {
+        check_boundaries(initial_conditions);
+        for (const vector<size_t>& level : pipe_levels) {
+            for (size_t pipe : level) {
+                size_t node = pipe_nodes[pipe].first;
+                mix_node(node, initial_conditions);
+                calc_node_pressure(node, initial_conditions);
+            }
+            pool->parallel_for(level.size(), [&](size_t index) {
+                size_t pipe = level[index];
+                pipe_tasks[pipe].solve(get_pipe_boundaries(pipe, initial_conditions));
+            });
+        }
+        finish_sink_nodes(initial_conditions);
+    }
+
+    /// @brief Расчёт шага моделирования сети с общим для всех труб шагом по времени
+    /// После вызова буферы всех труб содержат в current свежерассчитанный слой
+    /// @param dt Временной шаг моделирования
+    /// @param boundaries Краевые условия
+    void step(double dt, const isothermal_quasistatic_network_boundaries_t& boundaries)
+    {
+        step(dt, boundaries, vector<size_t>(pipe_tasks.size(), 1));
+    }
+
+    /// @brief Расчёт шага моделирования сети с локальным шагом по времени в трубах
+    /// Каждая труба проходит интервал dt за 2^k подшагов с числом Куранта не больше 1
+    /// (см. get_local_substep_counts). Трубы синхронизируются в узлах только в конце интервала:
+    /// на всех подшагах на входе трубы значения смешения в начале интервала
+    /// @param dt Интервал синхронизации труб (как правило, get_local_time_step)
+    /// @param boundaries Краевые условия
+    void step_local(double dt, const isothermal_quasistatic_network_boundaries_t& boundaries)
+    {
+        step(dt, boundaries, get_local_substep_counts(dt, boundaries.volumetric_flows));
+    }
+
+    /// @brief Рассчёт шага по времени, при котором число Куранта во всех трубах не больше 1
+    /// @param volumetric_flows Объемные расходы по трубам
+    double get_time_step_assuming_max_speed(const vector<double>& volumetric_flows) const
+    {
+        double result = std::numeric_limits<double>::infinity();
+        for (size_t pipe = 0; pipe < pipe_tasks.size(); ++pipe) {
+            result = (std::min)(result, get_pipe_time_step(pipe, volumetric_flows[pipe]));
+        }
+        return result;
+    }
+
+    /// @brief Интервал синхронизации для локального шага по времени: шаг при Cr = 1 
+    /// в самой медленной трубе (трубы без течения не учитываются)
+    /// @param volumetric_flows Объемные расходы по трубам
+    double get_local_time_step(const vector<double>& volumetric_flows) const
+    {
+        double result = 0;
+        for (size_t pipe = 0; pipe < pipe_tasks.size(); ++pipe) {
+            double pipe_step = get_pipe_time_step(pipe, volumetric_flows[pipe]);
+            if (std::isfinite(pipe_step)) {
+                result = (std::max)(result, pipe_step);
+            }
+        }
+        return result;
+    }
+
+    /// @brief Количество подшагов труб на интервале dt: наименьшая степень двойки,
+    /// при которой число Куранта в трубе не больше 1
+    /// @param dt Интервал синхронизации
+    /// @param volumetric_flows Объемные расходы по трубам
+    vector<size_t> get_local_substep_counts(double dt, const vector<double>& volumetric_flows) const
+    {
+        constexpr double eps = 1e-12;
+        vector<size_t> result(pipe_tasks.size(), 1);
+        for (size_t pipe = 0; pipe < pipe_tasks.size(); ++pipe) {
+            double pipe_step = get_pipe_time_step(pipe, volumetric_flows[pipe]);
+            while (dt / result[pipe] > pipe_step * (1 + eps)) {
+                result[pipe] *= 2;
+            }
+        }
+        return result;
+    }
+
+    /// @brief Задача расчета трубы
+    pipe_task_type& get_pipe_task(size_t pipe) {
+        return pipe_tasks[pipe];
+    }
+    /// @brief Количество труб
+    size_t get_pipe_count() const {
+        return pipe_tasks.size();
+    }
+    /// @brief Давления в узлах
+    const vector<double>& get_node_pressures() const {
+        return node_pressures;
+    }
+    /// @brief Расхождение давлений в узлах: наибольшее отклонение давления на выходе входящих труб
+    /// от давления первой из них (по нему рассчитывается узел). Нулевое для узлов с одной входящей трубой;
+    /// ненулевое значение означает, что заданные расходы не согласованы с гидравликой сети
+    const vector<double>& get_node_pressure_mismatches() const {
+        return node_pressure_mismatches;
+    }
+    /// @brief Плотности в узлах после смешения
+    const vector<double>& get_node_densities() const {
+        return node_densities;
+    }
+    /// @brief Вязкости в узлах после смешения
+    const vector<double>& get_node_viscosities() const {
+        return node_viscosities;
+    }
+    /// @brief Память, занимаемая задачами труб, суммарно по сети
+    /// (по отдельной трубе - get_pipe_task(pipe).get_memory_usage())
+    task_memory_usage_t get_memory_usage() const {
+        task_memory_usage_t result;
+        for (const pipe_task_type& pipe_task : pipe_tasks) {
+            result += pipe_task.get_memory_usage();
+        }
+        return result;
+    }
+
+private:
+    /// @brief Шаг по времени при Cr = 1 в трубе (бесконечность при отсутствии течения)
+    double get_pipe_time_step(size_t pipe, double volumetric_flow) const
+    {
+        double speed = volumetric_flow / pipe_tasks[pipe].get_pipe().wall.getArea();
+        return pipe_tasks[pipe].get_time_step_assuming_max_speed(speed);
+    }
+
+    /// @brief Расчёт шага моделирования сети
+    /// @param dt Временной шаг моделирования
+    /// @param boundaries Краевые условия
+    /// @param substep_counts Количество подшагов движения партий по трубам
+    void step(double dt, const isothermal_quasistatic_network_boundaries_t& boundaries,
+        const vector<size_t>& substep_counts)
+    {
+        check_boundaries(boundaries);
+
+        // Смешение в узлах по выходам труб с предыдущего шага
+        for (size_t node = 0; node < incoming_pipes.size(); ++node) {
+            mix_node(node, boundaries);
+        }
+
+        // Движение партий - трубы независимы
+        pool->parallel_for(pipe_nodes.size(), [&](size_t pipe) {
+            isothermal_quasistatic_task_boundaries_t pipe_boundaries = get_pipe_boundaries(pipe, boundaries);
+            double substep = dt / substep_counts[pipe];
+            for (size_t index = 0; index < substep_counts[pipe]; ++index) {
+                pipe_tasks[pipe].make_rheology_step(substep, pipe_boundaries);
+            }
+        });
+
+        // Профили давления - трубы независимы: расчет от нулевого давления на входе
+        pool->parallel_for(pipe_nodes.size(), [&](size_t pipe) {
+            isothermal_quasistatic_task_boundaries_t pipe_boundaries = get_pipe_boundaries(pipe, boundaries);
+            pipe_boundaries.pressure_in = 0;
+            pipe_tasks[pipe].calc_pressure_layer(pipe_boundaries);
+        });
+
+        // Давления в узлах по уровням - только по давлениям на концах труб
+        for (const vector<size_t>& level : pipe_levels) {
+            for (size_t pipe : level) {
+                size_t node = pipe_nodes[pipe].first;
+                calc_node_pressure(node, boundaries);
+                pipe_pressure_offsets[pipe] = node_pressures[node];
+            }
+        }
+        finish_sink_nodes(boundaries);
+
+        // Сдвиг профилей давления на давление в начальном узле
+        pool->parallel_for(pipe_nodes.size(), [&](size_t pipe) {
+            pipe_tasks[pipe].shift_pressure_layer(pipe_pressure_offsets[pipe]);
+            pipe_pressure_offsets[pipe] = 0;
+        });
+    }
+
+    /// @brief Давление и смешение в конечных узлах (без исходящих труб) - для вывода результатов
+    void finish_sink_nodes(const isothermal_quasistatic_network_boundaries_t& boundaries)
+    {
+        for (size_t node : sink_nodes) {
+            mix_node(node, boundaries);
+            calc_node_pressure(node, boundaries);
+        }
+    }
+};
+
+}
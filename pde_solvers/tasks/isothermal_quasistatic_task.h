@@ -1,5 +1,11 @@
 ﻿#pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 #include "../timeseries/timeseries_helpers.h"
 namespace pde_solvers {
@@ -9,45 +15,92 @@ using std::string;
 
 
 /// @brief Проблемно-ориентированный слой для гидравлического квазистационарного расчета
+/// Содержит только профили, меняющиеся по времени. Неизменные в ходе расчета данные
+/// (начальный профиль давления) и рабочие буферы солверов хранятся в задаче в одном экземпляре
 /// @tparam CellFlag Флаг расчёта реологии 
 /// true - в ячейках для метода конечных объёмов (Quickest-Ultimate)
 /// false - в точках для метода характеристик (advection_moc_solver)
-template <bool CellFlag>
+/// @tparam Scalar Тип значений профилей плотности и вязкости (давление всегда в double)
+template <bool CellFlag, typename Scalar = double>
 struct density_viscosity_quasi_layer {
     /// @brief Профиль плотности
-    std::vector<double> density;
+    std::vector<Scalar> density;
     /// @brief Профиль вязкости
-    std::vector<double> viscosity;
+    std::vector<Scalar> viscosity;
     /// @brief Профиль давления
     std::vector<double> pressure;
     /// @brief Дифференциальный профиль давления
     std::vector<double> pressure_delta;
-    /// @brief Изначальный профиль давления
-    std::vector<double> pressure_initial;
-    /// @brief Профиль вспомогательных расчетов для метода конечных объемов (и для вязкости, и для плотности)
-    quickest_ultimate_fv_solver_traits<1>::specific_layer specific;
     /// @brief Инициализация профилей
     /// @param point_count Количество точек
     density_viscosity_quasi_layer(size_t point_count)
         : density(point_count - static_cast<int>(CellFlag))
         , viscosity(point_count - static_cast<int>(CellFlag))
-        , specific(point_count)
         , pressure(point_count)
         , pressure_delta(point_count)
     {}
+};
 
-    // @brief Подготовка плотности для расчета методом конечных объемов 
-    static quickest_ultimate_fv_wrapper<1> get_density_wrapper(density_viscosity_quasi_layer& layer)
-    {
-        return quickest_ultimate_fv_wrapper<1>(layer.density, layer.specific);
+/// @brief Объем памяти, выделенной под профили слоя, байт
+template <bool CellFlag, typename Scalar>
+inline size_t get_allocated_size(const density_viscosity_quasi_layer<CellFlag, Scalar>& layer)
+{
+    return get_allocated_size(layer.density) + get_allocated_size(layer.viscosity)
+        + get_allocated_size(layer.pressure) + get_allocated_size(layer.pressure_delta);
+}
+
+/// @brief Сохранение слоя квазистационарного расчета в контрольную точку
+template <bool CellFlag, typename Scalar>
+inline void write_state(checkpoint_image_t* image, const density_viscosity_quasi_layer<CellFlag, Scalar>& layer)
+{
+    write_state(image, layer.density);
+    write_state(image, layer.viscosity);
+    write_state(image, layer.pressure);
+    write_state(image, layer.pressure_delta);
+}
+/// @brief Восстановление слоя квазистационарного расчета из контрольной точки
+template <bool CellFlag, typename Scalar>
+inline void read_state(checkpoint_reader_t* reader, density_viscosity_quasi_layer<CellFlag, Scalar>* layer)
+{
+    read_state(reader, &layer->density);
+    read_state(reader, &layer->viscosity);
+    read_state(reader, &layer->pressure);
+    read_state(reader, &layer->pressure_delta);
+}
+
+/// @brief Память, занимаемая расчетной задачей, байт
+struct task_memory_usage_t {
+    /// @brief Слои буфера по времени
+    size_t layers{ 0 };
+    /// @brief Неизменные в ходе расчета данные (профиль трубы, начальный профиль давления)
+    size_t invariant{ 0 };
+    /// @brief Рабочие буферы солверов, не входящие в состояние задачи
+    size_t scratch{ 0 };
+    /// @brief Часть слоев и неизменных данных, разделяемая с другими задачами (ответвлениями)
+    size_t shared{ 0 };
+    /// @brief Суммарный объем
+    size_t total() const {
+        return layers + invariant + scratch;
     }
-    /// @brief Подготовка вязкости для расчета методом конечных объемов 
-    static quickest_ultimate_fv_wrapper<1> get_viscosity_wrapper(density_viscosity_quasi_layer& layer)
-    {
-        return quickest_ultimate_fv_wrapper<1>(layer.viscosity, layer.specific);
+    task_memory_usage_t& operator+=(const task_memory_usage_t& other) {
+        layers += other.layers;
+        invariant += other.invariant;
+        scratch += other.scratch;
+        shared += other.shared;
+        return *this;
     }
 };
 
+/// @brief Статистика шагов квазистационарной задачи
+struct quasistatic_step_stats_t {
+    /// @brief Рассчитанные шаги
+    size_t computed_steps{ 0 };
+    /// @brief Шаги, пропущенные в установившемся режиме (см. set_steady_state_skipping)
+    size_t skipped_steps{ 0 };
+    /// @brief Суммарный шаг по времени пропущенных шагов, с
+    double skipped_time{ 0 };
+};
+
 /// @brief Структура, содержащая в себе краевые условия задачи PQ
 struct isothermal_quasistatic_task_boundaries_t {
     /// @brief Изначальный объемный расход
@@ -61,7 +114,13 @@ struct isothermal_quasistatic_task_boundaries_t {
 
     isothermal_quasistatic_task_boundaries_t() = default;
 
-    isothermal_quasistatic_task_boundaries_t(const vector<double>& values) {
+    isothermal_quasistatic_task_boundaries_t(const vector<double>& values)
+        : isothermal_quasistatic_task_boundaries_t(values.data())
+    {
+    }
+    /// @brief Краевые условия из массива значений в порядке полей структуры
+    /// (например, строки timeseries_matrix_t)
+    explicit isothermal_quasistatic_task_boundaries_t(const double* values) {
         volumetric_flow = values[0];
         pressure_in = values[1];
         density = values[2];
@@ -83,115 +142,429 @@ struct isothermal_quasistatic_task_boundaries_t {
 /// квазистационарного расчета в условиях движения партий с разной плотностью и вязкостью
 /// Расчет партий делается методом характеристик или Quickest-Ultimate
 /// @tparam Solver Тип солвера партий (advection_moc_solver или quickest_ultimate_fv_solver)
+/// Профили партий хранятся в Solver::scalar_type: например, для advection_moc_solver_t<float>
+/// или quickest_ultimate_fv_solver_t<scalar_fv_solver_traits<float>> партии рассчитываются в float,
+/// а гидравлический расчет (solve_euler) остается в double
 template <typename Solver>
 class isothermal_quasistatic_task_t {
-    pipe_properties_t pipe;
-    ring_buffer_t<density_viscosity_quasi_layer<std::is_same<Solver, advection_moc_solver>::value ? false : true>> buffer;
+    /// @brief Версия состояния задачи в контрольной точке
+    static constexpr uint32_t checkpoint_version = 2;
+    /// @brief Партии в ячейках (метод конечных объемов) или в точках (метод характеристик)
+    static constexpr bool rheology_on_cells = !is_advection_moc_solver<Solver>::value;
+public:
+    /// @brief Тип значений профилей плотности и вязкости
+    typedef typename Solver::scalar_type scalar_type;
+    /// @brief Тип слоя
+    typedef density_viscosity_quasi_layer<rheology_on_cells, scalar_type> layer_type;
+private:
+    /// @brief Модель трубопровода (неизменна, разделяется с ответвлениями задачи, см. fork)
+    std::shared_ptr<const pipe_properties_t> pipe;
+    /// @brief Слои по времени (разделяются с ответвлениями задачи до первой записи)
+    cow_ring_buffer_t<layer_type> buffer;
+    /// @brief Начальный профиль давления (рассчитывается в solve, разделяется с ответвлениями)
+    std::shared_ptr<const vector<double>> pressure_initial;
+    /// @brief Потоки на границах ячеек для шага партий методом конечных объемов
+    /// Рабочий буфер: полностью перезаписывается на каждом шаге, общий для плотности и вязкости
+    /// Размер - по количеству точек при первом шаге партий в ячейках
+    quickest_ultimate_fv_solver_traits<1>::specific_layer fluxes{ 1 };
+    /// @brief Профиль расхода для шага партий (рабочий буфер)
+    vector<double> flow_profile;
+    /// @brief Разбиение сетки для параллельного расчета шага (nullptr - последовательный расчет)
+    const domain_decomposition_t* decomposition{ nullptr };
+    /// @brief Признак инкрементального расчета давления (см. set_incremental_pressure)
+    bool incremental_pressure{ false };
+    /// @brief Приращения давления для инкрементального расчета
+    incremental_euler_solver_t pressure_solver;
+    /// @brief Плотность, вязкость и расход, по которым рассчитаны приращения pressure_solver
+    vector<scalar_type> pressure_solver_density;
+    vector<scalar_type> pressure_solver_viscosity;
+    double pressure_solver_flow{ 0 };
+    /// @brief Признак конвейерного расчета шагов (см. set_pipelined)
+    bool pipelined{ false };
+    /// @brief Признак того, что давление текущего слоя еще не рассчитано (конвейерный расчет)
+    bool pressure_pending{ false };
+    /// @brief Краевые условия шага, давление которого еще не рассчитано
+    isothermal_quasistatic_task_boundaries_t pending_boundaries{};
+    /// @brief Пул из двух потоков для конвейерного расчета (создается при первом конвейерном шаге)
+    std::shared_ptr<thread_pool_t> pipeline_pool;
+    /// @brief Признак пропуска шагов в установившемся режиме (см. set_steady_state_skipping)
+    bool skip_steady_steps{ false };
+    /// @brief Относительный допуск установившегося режима
+    double steady_state_tolerance{ 1e-9 };
+    /// @brief Краевые условия, по которым рассчитан (или в конвейерном режиме рассчитывается) текущий слой
+    /// (действительны при current_boundaries_valid)
+    isothermal_quasistatic_task_boundaries_t current_boundaries{};
+    bool current_boundaries_valid{ false };
+    /// @brief Признак однородности текущего слоя (плотность и вязкость равны краевым условиям current_boundaries),
+    /// проверяется при первом запросе после расчета слоя
+    std::optional<bool> current_layer_uniform;
+    /// @brief Статистика шагов
+    quasistatic_step_stats_t step_stats;
 
 public:
     /// @brief Конструктор
     /// @param pipe Модель трубопровода
     isothermal_quasistatic_task_t(const pipe_properties_t& pipe)
-        : pipe(pipe)
+        : pipe(std::make_shared<const pipe_properties_t>(pipe))
         , buffer(2, pipe.profile.getPointCount())
+        , pressure_initial(std::make_shared<const vector<double>>())
     {
     }
 
+    /// @brief Ответвление сценария расчета от текущего состояния задачи
+    /// Ответвление разделяет с задачей трубу, начальный профиль давления и слои; слой копируется
+    /// только при первой записи в него (в ответвлении или в исходной задаче). Рабочие буферы
+    /// не копируются, режим инкрементального расчета давления и разбиение сетки сохраняются
+    isothermal_quasistatic_task_t fork() const
+    {
+        return isothermal_quasistatic_task_t(*this, fork_tag_t());
+    }
+private:
+    /// @brief Признак конструктора ответвления
+    struct fork_tag_t {};
+    /// @brief Конструктор ответвления (см. fork)
+    isothermal_quasistatic_task_t(const isothermal_quasistatic_task_t& parent, fork_tag_t)
+        : pipe(parent.pipe)
+        , buffer(parent.buffer)
+        , pressure_initial(parent.pressure_initial)
+        , decomposition(parent.decomposition)
+        , incremental_pressure(parent.incremental_pressure)
+        , pipelined(parent.pipelined)
+        , pressure_pending(parent.pressure_pending)
+        , pending_boundaries(parent.pending_boundaries)
+        , skip_steady_steps(parent.skip_steady_steps)
+        , steady_state_tolerance(parent.steady_state_tolerance)
+        , current_boundaries(parent.current_boundaries)
+        , current_boundaries_valid(parent.current_boundaries_valid)
+        , current_layer_uniform(parent.current_layer_uniform)
+    {
+    }
+public:
+
     /// @brief Начальный стационарный расчёт
     /// @param initial_conditions Начальные условия
     void solve(const isothermal_quasistatic_task_boundaries_t& initial_conditions)
     {
         // Количество точек
-        size_t n = pipe.profile.getPointCount();
+        size_t n = pipe->profile.getPointCount();
 
-        // Инициализация реологии
-        auto& current = buffer.current();
+        // Инициализация реологии (слой перезаписывается целиком, разделяемый с ответвлением слой не копируется)
+        auto& current = buffer.overwrite_current(n);
 
         // Инициализация начального профиля плотности (не важно, ячейки или точки)
-        for (double& density : current.density) {
-            density = initial_conditions.density;
+        for (scalar_type& density : current.density) {
+            density = static_cast<scalar_type>(initial_conditions.density);
         }
         // Инициализация начального профиля вязкости (не важно, ячейки или точки)
-        for (double& viscosity : current.viscosity) {
-            viscosity = initial_conditions.viscosity;
+        for (scalar_type& viscosity : current.viscosity) {
+            viscosity = static_cast<scalar_type>(initial_conditions.viscosity);
         }
 
         //// Начальный гидравлический расчет
+        pressure_pending = false;
         calc_pressure_layer(initial_conditions);
-        buffer.previous().pressure_initial = current.pressure_initial = current.pressure; // Получаем изначальный профиль давлений
+        pressure_initial = std::make_shared<const vector<double>>(current.pressure); // Получаем изначальный профиль давлений
+        set_current_boundaries(initial_conditions);
     }
 public:
+    /// @brief Задает разбиение сетки для параллельного расчета партий и давления одной длинной трубы
+    /// Разбиение должно жить дольше задачи или до следующего вызова set_decomposition
+    /// @param decomposition Разбиение по точкам трубы (nullptr - последовательный расчет)
+    void set_decomposition(const domain_decomposition_t* decomposition) {
+        this->decomposition = decomposition;
+    }
+    /// @brief Включает инкрементальный расчет давления: приращения давления хранятся между шагами
+    /// и пересчитываются только в ячейках, где изменились плотность или вязкость (фронты партий).
+    /// При смене расхода приращения пересчитываются полностью. Профиль давления побитово совпадает
+    /// с последовательным расчетом без инкрементального режима
+    void set_incremental_pressure(bool incremental_pressure) {
+        this->incremental_pressure = incremental_pressure;
+        pressure_solver = incremental_euler_solver_t();
+    }
+    /// @brief Включает конвейерный расчет шагов: давление шага n рассчитывается в одном потоке
+    /// одновременно с движением партий шага n + 1 в другом. Движению партий нужна только реология
+    /// шага n, поэтому результаты совпадают с последовательным расчетом побитово, но появляются
+    /// с задержкой на шаг: после step() полностью рассчитан слой get_completed_layer() (предыдущий),
+    /// а у текущего слоя рассчитана только реология. flush_pipeline() досчитывает давление текущего слоя.
+    /// При выключении конвейера давление текущего слоя досчитывается.
+    /// Вместе с разбиением сетки (set_decomposition) половины шага не перекрываются: обе используют
+    /// пул разбиения, вызовы которого выполняются по очереди. Поэтому при заданном разбиении
+    /// половины шага рассчитываются одна за другой (каждая - параллельно по подобластям),
+    /// а конвейер сохраняет только задержку давления на шаг
+    void set_pipelined(bool pipelined) {
+        if (!pipelined) {
+            flush_pipeline();
+        }
+        this->pipelined = pipelined;
+    }
+    /// @brief Досчитывает давление текущего слоя, отложенное конвейерным расчетом
+    void flush_pipeline() {
+        if (pressure_pending) {
+            pressure_pending = false;
+            calc_pressure_profile(buffer.current(), pending_boundaries);
+        }
+    }
+    /// @brief Признак того, что давление текущего слоя отложено конвейерным расчетом
+    bool is_pressure_pending() const {
+        return pressure_pending;
+    }
+    /// @brief Включает пропуск шагов в установившемся режиме: если краевые условия шага совпадают
+    /// в пределах допуска с краевыми условиями, по которым рассчитан текущий слой, а плотность
+    /// и вязкость по всей трубе равны входным (труба заполнена одной партией), шаг step()
+    /// не рассчитывается - слой не изменился бы. Буфер при пропуске не сдвигается.
+    /// Однородность слоя проверяется один раз после каждого рассчитанного шага.
+    /// В конвейерном режиме при пропуске досчитывается отложенное давление текущего слоя
+    /// @param relative_tolerance Относительный допуск совпадения краевых условий и однородности слоя
+    /// (для слоев во float допуск не меньше нескольких эпсилон float)
+    void set_steady_state_skipping(bool skip_steady_steps, double relative_tolerance = 1e-9) {
+        this->skip_steady_steps = skip_steady_steps;
+        steady_state_tolerance = relative_tolerance;
+        current_layer_uniform.reset();
+    }
+    /// @brief Статистика рассчитанных и пропущенных шагов
+    const quasistatic_step_stats_t& get_step_stats() const {
+        return step_stats;
+    }
+    /// @brief Обнуление статистики шагов
+    void reset_step_stats() {
+        step_stats = quasistatic_step_stats_t();
+    }
     /// @brief Рассчёт шага по времени для Cr = 1
     /// @param v_max Максимальная скорость течение потока в трубопроводе
     double get_time_step_assuming_max_speed(double v_max) const {
-        const auto& x = pipe.profile.coordinates;
+        const auto& x = pipe->profile.coordinates;
         double dx = x[1] - x[0]; // Шаг сетки
-        double dt = abs(dx / v_max); // Постоянный шаг по времени для Куранта = 1
+        double dt = std::abs(dx / v_max); // Постоянный шаг по времени для Куранта = 1
         return dt;
     }
-private:
+public:
     /// @brief Проводится рассчёт шага движения партии
+    /// Используются расход, плотность и вязкость из краевых условий (давление не используется)
     /// @param dt Временной шаг моделирования
     /// @param boundaries Краевые условия
     void make_rheology_step(double dt, const isothermal_quasistatic_task_boundaries_t& boundaries) {
-        size_t n = pipe.profile.getPointCount();
-        vector<double>Q_profile(n, boundaries.volumetric_flow); // задаем по трубе новый расход из временного ряда
-
+        current_boundaries_valid = false;
         advance();
+        // предыдущий слой только читается, текущий перезаписывается целиком
+        calc_rheology_layer(std::as_const(buffer).previous(),
+            buffer.overwrite_current(pipe->profile.getPointCount()), dt, boundaries);
+    }
+private:
+    /// @brief Шаг движения партий от слоя previous к слою current
+    void calc_rheology_layer(const layer_type& previous, layer_type& current,
+        double dt, const isothermal_quasistatic_task_boundaries_t& boundaries)
+    {
+        PDE_SOLVERS_TIME_PHASE(make_rheology_step);
+        size_t n = pipe->profile.getPointCount();
 
-        if constexpr (std::is_same<Solver, advection_moc_solver>::value) {
+        if constexpr (!rheology_on_cells) {
 
             // Шаг по плотности
-            advection_moc_solver solver_rho(pipe, Q_profile[0], buffer.previous().density, buffer.current().density);
-            solver_rho.step(dt, boundaries.density, boundaries.density);
+            Solver solver_rho(*pipe, boundaries.volumetric_flow, previous.density, current.density);
+            solver_rho.step(dt, boundaries.density, boundaries.density, decomposition);
             // Шаг по вязкости
-            advection_moc_solver solver_nu(pipe, Q_profile[0], buffer.previous().viscosity, buffer.current().viscosity);
-            solver_nu.step(dt, boundaries.viscosity, boundaries.viscosity);
+            Solver solver_nu(*pipe, boundaries.volumetric_flow, previous.viscosity, current.viscosity);
+            solver_nu.step(dt, boundaries.viscosity, boundaries.viscosity, decomposition);
 
         }
         else {
-            PipeQAdvection advection_model(pipe, Q_profile);
-
-            auto density_wrapper = buffer.get_buffer_wrapper(
-                &density_viscosity_quasi_layer<1>::get_density_wrapper);
-
-            auto viscosity_wrapper = buffer.get_buffer_wrapper(
-                &density_viscosity_quasi_layer<1>::get_viscosity_wrapper);
+            if (fluxes.point_double[0].size() != n) {
+                fluxes = quickest_ultimate_fv_solver_traits<1>::specific_layer(n);
+            }
+            flow_profile.assign(n, boundaries.volumetric_flow); // задаем по трубе новый расход из временного ряда
+            PipeQAdvection advection_model(*pipe, flow_profile);
 
+            // Потоки предыдущего шага не используются, поэтому буфер потоков один на оба слоя
             // Шаг по плотности
-            quickest_ultimate_fv_solver solver_rho(advection_model, density_wrapper);
-            solver_rho.step(dt, boundaries.density, boundaries.density);
+            Solver solver_rho(advection_model, previous.density, current.density, fluxes, fluxes);
+            solver_rho.step(dt, boundaries.density, boundaries.density, decomposition);
             // Шаг по вязкости
-            quickest_ultimate_fv_solver solver_nu(advection_model, viscosity_wrapper);
-            solver_nu.step(dt, boundaries.viscosity, boundaries.viscosity);
+            Solver solver_nu(advection_model, previous.viscosity, current.viscosity, fluxes, fluxes);
+            solver_nu.step(dt, boundaries.viscosity, boundaries.viscosity, decomposition);
         }
     }
+public:
 
     /// @brief Рассчёт профиля давления методом Эйлера (задача PQ)
+    /// Градиент давления не зависит от давления, поэтому профиль рассчитывается как
+    /// накопленная сумма (solve_euler_state_independent), параллельно при заданном разбиении
+    /// Используются расход и давление на входе из краевых условий
     /// @param boundaries Краевые условия
     void calc_pressure_layer(const isothermal_quasistatic_task_boundaries_t& boundaries) {
-
+        current_boundaries_valid = false;
+        calc_pressure_profile(buffer.current(), boundaries);
+    }
+    /// @brief Сдвиг профиля давления текущего слоя на offset (дифференциальный профиль - на -offset)
+    /// Градиент давления не зависит от давления, поэтому профиль, рассчитанный calc_pressure_layer
+    /// от нулевого давления на входе и сдвинутый на давление на входе, совпадает с рассчитанным
+    /// от этого давления (до ошибок округления)
+    void shift_pressure_layer(double offset) {
+        current_boundaries_valid = false;
         auto& current = buffer.current();
+        for (double& pressure : current.pressure) {
+            pressure += offset;
+        }
+        for (double& pressure_delta : current.pressure_delta) {
+            pressure_delta -= offset;
+        }
+    }
+private:
+    /// @brief Рассчёт профиля давления слоя по его реологии
+    void calc_pressure_profile(layer_type& current, const isothermal_quasistatic_task_boundaries_t& boundaries)
+    {
+        PDE_SOLVERS_TIME_PHASE(calc_pressure_layer);
 
         vector<double>& p_profile = current.pressure;
         int euler_direction = +1; // Задаем направление для Эйлера
 
-        isothermal_pipe_PQ_parties_t pipeModel(pipe, current.density, current.viscosity, boundaries.volumetric_flow, euler_direction);
-        solve_euler<1>(pipeModel, euler_direction, boundaries.pressure_in, &p_profile);
+        isothermal_pipe_PQ_parties_t<scalar_type> pipeModel(*pipe, current.density, current.viscosity, boundaries.volumetric_flow, euler_direction);
+        if (incremental_pressure) {
+            update_pressure_solver(current, pipeModel, euler_direction, boundaries);
+            const vector<double>& profile = pressure_solver.get_profile();
+            std::copy(profile.begin(), profile.end(), p_profile.begin());
+        }
+        else {
+            solve_euler_state_independent<1>(pipeModel, euler_direction, boundaries.pressure_in, &p_profile,
+                decomposition);
+        }
         // Получаем дифференциальный профиль давлений
-        std::transform(current.pressure_initial.begin(), current.pressure_initial.end(), p_profile.begin(),
+        std::transform(pressure_initial->begin(), pressure_initial->end(), p_profile.begin(),
             current.pressure_delta.begin(),
             [](double initial, double current) {return initial - current;  });
 
     }
+    /// @brief Пересчитывает приращения давления в точках, где реология изменилась с прошлого расчета
+    void update_pressure_solver(const layer_type& current,
+        const isothermal_pipe_PQ_parties_t<scalar_type>& pipe_model, int euler_direction,
+        const isothermal_quasistatic_task_boundaries_t& boundaries)
+    {
+        if (!pressure_solver.is_built() || pressure_solver_flow != boundaries.volumetric_flow) {
+            pressure_solver.build(pipe_model, euler_direction, boundaries.pressure_in);
+            pressure_solver_density = current.density;
+            pressure_solver_viscosity = current.viscosity;
+            pressure_solver_flow = boundaries.volumetric_flow;
+            return;
+        }
+        pressure_solver.set_initial_condition(boundaries.pressure_in);
+
+        // Непрерывные участки изменившейся реологии
+        auto changed = [&](size_t index) {
+            return current.density[index] != pressure_solver_density[index] ||
+                current.viscosity[index] != pressure_solver_viscosity[index];
+        };
+        size_t count = current.density.size();
+        for (size_t index = 0; index < count; ++index) {
+            if (!changed(index)) {
+                continue;
+            }
+            size_t changed_end = index + 1;
+            while (changed_end < count && changed(changed_end)) {
+                ++changed_end;
+            }
+            std::copy(current.density.begin() + index, current.density.begin() + changed_end,
+                pressure_solver_density.begin() + index);
+            std::copy(current.viscosity.begin() + index, current.viscosity.begin() + changed_end,
+                pressure_solver_viscosity.begin() + index);
+            auto [grid_begin, grid_end] = pipe_model.get_grid_range_by_rheology_range(index, changed_end);
+            pressure_solver.update(pipe_model, grid_begin, grid_end);
+            index = changed_end;
+        }
+    }
 public:
     /// @brief Рассчёт шага моделирования, включающий в себя расчёт шага движения партии и гидравлический расчёт
     /// Функция делат сдвиг буфера (advance) так, что buffer.current после вызова содержит свежерасчитанный слой
     /// @param dt временной шаг моделирования
     /// @param boundaries Краевые условие
     void step(double dt, const isothermal_quasistatic_task_boundaries_t& boundaries) {
-        make_rheology_step(dt, boundaries);
-        calc_pressure_layer(boundaries);
+        if (skip_steady_steps && is_steady_step(boundaries)) {
+            flush_pipeline();
+            step_stats.skipped_steps++;
+            step_stats.skipped_time += dt;
+            return;
+        }
+        step_stats.computed_steps++;
+        if (!pipelined) {
+            make_rheology_step(dt, boundaries);
+            calc_pressure_layer(boundaries);
+            set_current_boundaries(boundaries);
+            return;
+        }
+        // Конвейерный расчет (см. set_pipelined)
+        if (!pressure_pending) {
+            make_rheology_step(dt, boundaries);
+        }
+        else {
+            advance();
+            layer_type& layer = buffer.previous(); // реология рассчитана, давление отложено
+            layer_type& next_layer = buffer.overwrite_current(pipe->profile.getPointCount());
+            if (decomposition != nullptr) {
+                // Пул разбиения выполняет вызовы по очереди - перекрытия половин шага не будет
+                calc_rheology_layer(layer, next_layer, dt, boundaries);
+                calc_pressure_profile(layer, pending_boundaries);
+            }
+            else {
+                if (!pipeline_pool) {
+                    pipeline_pool = std::make_shared<thread_pool_t>(2);
+                }
+                pipeline_pool->parallel_for(2, [&](size_t part) {
+                    if (part == 0) {
+                        calc_rheology_layer(layer, next_layer, dt, boundaries);
+                    }
+                    else {
+                        calc_pressure_profile(layer, pending_boundaries);
+                    }
+                });
+            }
+        }
+        pressure_pending = true;
+        pending_boundaries = boundaries;
+        set_current_boundaries(boundaries);
+    }
+
+private:
+    /// @brief Запоминает краевые условия, по которым рассчитан текущий слой
+    void set_current_boundaries(const isothermal_quasistatic_task_boundaries_t& boundaries) {
+        current_boundaries = boundaries;
+        current_boundaries_valid = true;
+        current_layer_uniform.reset();
+    }
+    /// @brief Признак того, что шаг с краевыми условиями boundaries не изменит текущий слой
+    bool is_steady_step(const isothermal_quasistatic_task_boundaries_t& boundaries)
+    {
+        if (!current_boundaries_valid) {
+            return false;
+        }
+        auto is_close = [&](double value, double reference, double tolerance) {
+            return std::abs(value - reference) <= tolerance * (std::max)(std::abs(value), std::abs(reference));
+        };
+        double tolerance = steady_state_tolerance;
+        if (!is_close(boundaries.volumetric_flow, current_boundaries.volumetric_flow, tolerance) ||
+            !is_close(boundaries.pressure_in, current_boundaries.pressure_in, tolerance) ||
+            !is_close(boundaries.density, current_boundaries.density, tolerance) ||
+            !is_close(boundaries.viscosity, current_boundaries.viscosity, tolerance))
+        {
+            return false;
+        }
+        if (!current_layer_uniform.has_value()) {
+            // Профили во float не могут совпасть с краевыми условиями точнее своей разрядности
+            double layer_tolerance = (std::max)(tolerance,
+                4.0 * static_cast<double>(std::numeric_limits<scalar_type>::epsilon()));
+            const auto& current = std::as_const(buffer).current();
+            auto is_uniform = [&](const vector<scalar_type>& profile, double value) {
+                return std::all_of(profile.begin(), profile.end(), [&](scalar_type item) {
+                    return is_close(static_cast<double>(item), value, layer_tolerance);
+                });
+            };
+            current_layer_uniform = is_uniform(current.density, current_boundaries.density) &&
+                is_uniform(current.viscosity, current_boundaries.viscosity);
+        }
+        return *current_layer_uniform;
+    }
+public:
+    /// @brief Последний полностью рассчитанный слой: текущий или, если давление текущего слоя
+    /// отложено конвейерным расчетом, предыдущий
+    const layer_type& get_completed_layer() const {
+        return pressure_pending ? buffer.previous() : buffer.current();
     }
 
     /// @brief Сдвиг текущего слоя в буфере
@@ -200,10 +573,94 @@ public:
         buffer.advance(+1);
     }
 
+    /// @brief Вид состояния задачи для контрольных точек (load_checkpoint проверяет совпадение)
+    static string get_checkpoint_kind() {
+        string kind = rheology_on_cells
+            ? "isothermal_quasistatic_task_t<quickest_ultimate_fv_solver>"
+            : "isothermal_quasistatic_task_t<advection_moc_solver>";
+        if (!std::is_same<scalar_type, double>::value) {
+            // Профили партий другого типа несовместимы с сохраненными в double
+            kind += " scalar" + std::to_string(8 * sizeof(scalar_type));
+        }
+        return kind;
+    }
+
+    /// @brief Сохранение состояния задачи (труба и буфер слоев) в образ контрольной точки
+    void write_state(checkpoint_image_t* image) const {
+        if (pressure_pending) {
+            throw std::logic_error("isothermal_quasistatic_task_t: call flush_pipeline() before saving state");
+        }
+        image->write(checkpoint_version);
+        pde_solvers::write_state(image, *pipe);
+        pde_solvers::write_state(image, *pressure_initial);
+        pde_solvers::write_state(image, buffer);
+    }
+
+    /// @brief Восстановление состояния задачи из образа контрольной точки
+    /// Функция гидравлического сопротивления трубы остается заданной при создании задачи
+    void read_state(checkpoint_reader_t* reader) {
+        if (reader->read<uint32_t>() != checkpoint_version) {
+            throw std::runtime_error("isothermal_quasistatic_task_t: unsupported checkpoint version");
+        }
+        pipe_properties_t restored_pipe = *pipe; // функция сопротивления остается от текущей трубы
+        pde_solvers::read_state(reader, &restored_pipe);
+        pipe = std::make_shared<const pipe_properties_t>(std::move(restored_pipe));
+        vector<double> restored_pressure_initial;
+        pde_solvers::read_state(reader, &restored_pressure_initial);
+        pressure_initial = std::make_shared<const vector<double>>(std::move(restored_pressure_initial));
+        pde_solvers::read_state(reader, &buffer);
+        pressure_solver = incremental_euler_solver_t(); // приращения давления рассчитываются заново
+        pressure_pending = false;
+        current_boundaries_valid = false;
+    }
+
+    /// @brief Модель трубопровода
+    const pipe_properties_t& get_pipe() const {
+        return *pipe;
+    }
+
     /// @brief Возвращает ссылку на буфер
+    /// Неконстантный доступ к слоям копирует слои, разделяемые с ответвлениями задачи
     auto& get_buffer()
     {
-        return buffer.buffer;
+        return buffer;
+    }
+    /// @brief Возвращает константную ссылку на буфер (слои не копируются)
+    const auto& get_buffer() const
+    {
+        return buffer;
+    }
+
+    /// @brief Начальный профиль давления (по начальному стационарному расчету solve)
+    const vector<double>& get_pressure_initial() const {
+        return *pressure_initial;
+    }
+
+    /// @brief Память, занимаемая задачей: слои по времени, неизменные данные и рабочие буферы
+    /// Разделяемые с ответвлениями задачи слои и данные учитываются полностью и дополнительно в shared
+    task_memory_usage_t get_memory_usage() const
+    {
+        task_memory_usage_t result;
+        for (size_t offset = 0; offset < buffer.get_layer_count(); ++offset) {
+            size_t layer_size = get_allocated_size(buffer[static_cast<int>(offset)]);
+            result.layers += layer_size;
+            if (buffer.is_shared(static_cast<int>(offset))) {
+                result.shared += layer_size;
+            }
+        }
+        size_t pipe_size = get_allocated_size(pipe->profile.coordinates)
+            + get_allocated_size(pipe->profile.heights)
+            + get_allocated_size(pipe->profile.capacity);
+        size_t pressure_initial_size = get_allocated_size(*pressure_initial);
+        result.invariant = pipe_size + pressure_initial_size;
+        result.shared += (pipe.use_count() > 1 ? pipe_size : 0)
+            + (pressure_initial.use_count() > 1 ? pressure_initial_size : 0);
+        result.scratch = get_allocated_size(fluxes)
+            + get_allocated_size(flow_profile)
+            + pressure_solver.get_allocated_size()
+            + get_allocated_size(pressure_solver_density)
+            + get_allocated_size(pressure_solver_viscosity);
+        return result;
     }
 
 protected:
@@ -223,7 +680,8 @@ public:
     /// @param dt Временной шаг моделирования
     /// @param path Путь к файлу
     /// @param layer_name Тип профиля
-    void print(const std::vector<double>& layer, const std::time_t dt, const std::string& path, const std::string& layer_name)
+    template <typename Scalar>
+    void print(const std::vector<Scalar>& layer, const std::time_t dt, const std::string& path, const std::string& layer_name)
     {
         std::string filename = get_courant_research_filename_for_qsm(path, layer_name);
 
@@ -241,25 +699,85 @@ public:
             file.close();
         }
     }
+private:
+    /// @brief Проверяет, что давление текущего слоя рассчитано (выводить можно только полный слой)
+    void check_pressure_completed() const {
+        if (pressure_pending) {
+            throw std::logic_error("isothermal_quasistatic_task_t: call flush_pipeline() before printing results");
+        }
+    }
 public:
     /// @brief Запись промежуточных результатов в файл
     /// @param dt временной шаг моделирования
     /// @param path Путь к файлу
+    /// В конвейерном режиме (set_pipelined) давление текущего слоя должно быть досчитано flush_pipeline()
     void print_all(const time_t& dt, const string& path) {
-        auto& current = buffer.current();
+        check_pressure_completed();
+        const auto& current = std::as_const(buffer).current();
         print(current.density, dt, path, "density");
         print(current.viscosity, dt, path, "viscosity");
         print(current.pressure, dt, path, "pressure");
         print(current.pressure_delta, dt, path, "pressure_delta");
     }
 
+    /// @brief Имена профилей, выводимых print_all, в порядке их передачи писателю
+    static vector<string> get_output_profile_names() {
+        return { "density", "viscosity", "pressure", "pressure_delta" };
+    }
+
+    /// @brief Описания профилей print_all для бинарного вывода (binary_layer_sink_t)
+    /// Количество значений не задается - берется из первого слоя
+    static vector<binary_profile_info_t> get_output_profiles_info() {
+        vector<string> names = get_output_profile_names();
+        vector<string> units{ "kg/m3", "m2/s", "Pa", "Pa" };
+        vector<bool> on_cells{ rheology_on_cells, rheology_on_cells, false, false };
+
+        vector<binary_profile_info_t> result(names.size());
+        for (size_t index = 0; index < names.size(); ++index) {
+            result[index].name = names[index];
+            result[index].units = units[index];
+            result[index].on_cells = on_cells[index];
+        }
+        return result;
+    }
+
+    /// @brief Координаты сетки трубопровода (для бинарного вывода)
+    const vector<double>& get_coordinates() const {
+        return pipe->profile.coordinates;
+    }
+
+    /// @brief Передача промежуточных результатов фоновому писателю
+    /// В отличие от print_all(dt, path) поток расчета не обращается к диску, а только копирует профили
+    /// @param dt Момент времени
+    /// В конвейерном режиме (set_pipelined) давление текущего слоя должно быть досчитано flush_pipeline()
+    /// @param writer Писатель, созданный для профилей get_output_profile_names()
+    /// @return true, если слой поставлен в очередь на запись
+    bool print_all(const time_t& dt, async_layer_writer_t& writer) {
+        check_pressure_completed();
+        const auto& current = std::as_const(buffer).current();
+        return writer.push(static_cast<double>(dt), current.density, current.viscosity,
+            current.pressure, current.pressure_delta);
+    }
+
     /// @brief Запись профиля в файл
     void print_profile(const string& path) {
-        print(pipe.profile.coordinates, 0, path, "profile");
-        print(pipe.profile.heights, 0, path, "profile");
+        print(pipe->profile.coordinates, 0, path, "profile");
+        print(pipe->profile.heights, 0, path, "profile");
     }
 
 };
 
+/// @brief Сохранение состояния задачи в контрольную точку (для checkpoint_writer_t)
+template <typename Solver>
+inline void write_state(checkpoint_image_t* image, const isothermal_quasistatic_task_t<Solver>& task)
+{
+    task.write_state(image);
+}
+/// @brief Восстановление состояния задачи из контрольной точки (для load_checkpoint)
+template <typename Solver>
+inline void read_state(checkpoint_reader_t* reader, isothermal_quasistatic_task_t<Solver>* task)
+{
+    task->read_state(reader);
+}
 
 }
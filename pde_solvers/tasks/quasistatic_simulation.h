@@ -0,0 +1,181 @@
+﻿#pragma once
+
+#include <cmath>
+#include <ctime>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "../timeseries/vector_timeseries.h"
+#include "isothermal_quasistatic_task.h"
+
+namespace pde_solvers {
+;
+
+/// @brief Шаг моделирования: момент времени и рассчитанный к нему слой
+/// Слой принадлежит задаче и действителен до следующего шага моделирования
+template <typename Layer>
+struct quasistatic_simulation_step_t {
+    /// @brief Момент времени слоя
+    time_t time;
+    /// @brief Слой задачи (плотность, вязкость, давление)
+    const Layer& layer;
+};
+
+/// @brief Ленивое квазистационарное моделирование по временным рядам краевых условий
+/// Шаг задачи рассчитывается только при запросе следующего слоя (next() или инкремент итератора),
+/// поэтому потребитель может остановиться на любом шаге, а несколько моделирований
+/// можно продвигать совместно без хранения промежуточных слоев и без обратных вызовов:
+///     for (const auto& [t, layer] : quasistatic_simulation_t(task, timeseries)) { ... }
+/// Первым выдается текущий слой задачи в момент начала рядов (задача должна быть рассчитана solve),
+/// далее - слои после каждого шага, пока момент времени меньше конца рядов
+/// (последний слой - первый, достигший конца рядов). Моделирование однопроходное
+/// Задача не копируется и должна существовать до конца моделирования; для независимых
+/// сценариев от одного состояния используется task.fork()
+/// @tparam Solver Численный метод расчета движения партий
+template <typename Solver>
+class quasistatic_simulation_t {
+public:
+    /// @brief Тип задачи
+    typedef isothermal_quasistatic_task_t<Solver> task_type;
+    /// @brief Тип слоя задачи
+    typedef typename task_type::layer_type layer_type;
+    /// @brief Тип выдаваемого шага моделирования
+    typedef quasistatic_simulation_step_t<layer_type> step_type;
+
+private:
+    /// @brief Задача
+    task_type& task;
+    /// @brief Временные ряды краевых условий
+    const vector_timeseries_t& boundary_timeseries;
+    /// @brief Курсор интерполяции краевых условий
+    vector_timeseries_cursor_t boundary_cursor;
+    /// @brief Выбор шага с учетом событий краевых условий (см. align_steps_to_boundaries)
+    std::optional<timeseries_time_step_controller_t> step_controller;
+    /// @brief Буфер интерполированных значений краевых условий
+    vector<double> boundary_values;
+    /// @brief Конец периода моделирования
+    time_t end_time;
+    /// @brief Постоянный шаг по времени, NaN - шаг для Cr = 1 по текущему расходу
+    double dt;
+    /// @brief Момент времени текущего слоя задачи
+    time_t time;
+
+public:
+    /// @param task Рассчитанная (solve) задача
+    /// @param boundary_timeseries Временные ряды краевых условий в порядке полей
+    /// isothermal_quasistatic_task_boundaries_t; должны существовать до конца моделирования
+    /// @param dt Постоянный шаг по времени либо NaN - шаг для Cr = 1 на каждом шаге
+    quasistatic_simulation_t(isothermal_quasistatic_task_t<Solver>& task,
+        const vector_timeseries_t& boundary_timeseries,
+        double dt = std::numeric_limits<double>::quiet_NaN())
+        : task(task)
+        , boundary_timeseries(boundary_timeseries)
+        , boundary_cursor(boundary_timeseries)
+        , end_time(boundary_timeseries.get_end_date())
+        , dt(dt)
+        , time(boundary_timeseries.get_start_date())
+    {
+    }
+    /// @brief Включает выбор шага с учетом событий краевых условий (timeseries_time_step_controller_t):
+    /// шаг - наибольшее целое число секунд не больше dt (или шага для Cr = 1), не переходящее
+    /// через изломы рядов краевых условий и конец периода. Скачки краевых условий попадают
+    /// точно на начало шага, последний слой - точно в конце периода.
+    /// Если dt (шаг для Cr = 1) меньше секунды, next() выбрасывает исключение
+    /// @param relative_tolerance Порог излома ряда (см. timeseries_time_step_controller_t)
+    void align_steps_to_boundaries(double relative_tolerance = 0) {
+        step_controller.emplace(boundary_timeseries, relative_tolerance);
+    }
+    /// @brief Момент времени текущего слоя
+    time_t get_time() const {
+        return time;
+    }
+    /// @brief Текущий слой задачи
+    const layer_type& get_layer() const {
+        return std::as_const(task).get_buffer().current();
+    }
+    /// @brief Текущий шаг моделирования
+    step_type get_step() const {
+        return step_type{ time, get_layer() };
+    }
+    /// @brief Признак того, что следующих шагов нет
+    bool is_finished() const {
+        return time >= end_time;
+    }
+    /// @brief Рассчитывает следующий шаг задачи
+    /// @return false, если моделирование уже завершено (шаг не выполняется)
+    bool next() {
+        if (is_finished()) {
+            return false;
+        }
+        // Интерполируем значения параметров в заданный момент времени
+        boundary_cursor.interpolate(time, &boundary_values);
+        isothermal_quasistatic_task_boundaries_t boundaries(boundary_values);
+
+        double time_step = dt;
+        if (std::isnan(time_step)) {
+            double v = boundaries.volumetric_flow / task.get_pipe().wall.getArea();
+            time_step = task.get_time_step_assuming_max_speed(v);
+        }
+        if (step_controller) {
+            time_t aligned_step = step_controller->get_time_step(time, time_step);
+            time_step = static_cast<double>(aligned_step);
+            time += aligned_step;
+        }
+        else {
+            time += static_cast<time_t>(time_step);
+        }
+
+        task.step(time_step, boundaries);
+        // Выдаваемому слою нужно давление, поэтому отложенный конвейерным расчетом шаг досчитывается
+        task.flush_pipeline();
+        return true;
+    }
+
+    /// @brief Однопроходный итератор по шагам моделирования
+    /// Инкремент рассчитывает следующий шаг задачи; итератор конца - с нулевым моделированием
+    class iterator {
+        quasistatic_simulation_t* simulation{ nullptr };
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef step_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const step_type* pointer;
+        typedef step_type reference;
+
+        iterator() = default;
+        explicit iterator(quasistatic_simulation_t* simulation)
+            : simulation(simulation)
+        {
+        }
+        step_type operator*() const {
+            return simulation->get_step();
+        }
+        iterator& operator++() {
+            if (!simulation->next()) {
+                simulation = nullptr;
+            }
+            return *this;
+        }
+        void operator++(int) {
+            ++*this;
+        }
+        bool operator==(const iterator& other) const {
+            return simulation == other.simulation;
+        }
+        bool operator!=(const iterator& other) const {
+            return simulation != other.simulation;
+        }
+    };
+    /// @brief Итератор на текущий шаг моделирования
+    iterator begin() {
+        return iterator(this);
+    }
+    /// @brief Итератор конца моделирования
+    iterator end() {
+        return iterator();
+    }
+};
+
+}
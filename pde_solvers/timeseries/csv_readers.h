@@ -1,7 +1,13 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <charconv>
+#include <exception>
 #include <fstream>
+#include <iterator>
 #include "timeseries_helpers.h" 
+#include "../core/thread_pool.h"
+#include "../io/mapped_file.h"
 
 
 using std::pair;
@@ -9,64 +15,262 @@ using std::string;
 using std::vector;
 
 
+/// @brief Быстрый перевод даты формата dd.mm.YYYY HH:MM:SS в UNIX-время
+/// Результат совпадает с StringToUnix. mktime вызывается один раз на сутки:
+/// в исторических данных строки идут по возрастанию времени, поэтому хватает кэша последних суток
+class csv_datetime_decoder_t {
+    /// @brief Последние декодированные сутки
+    int cached_day{ -1 };
+    int cached_month{ -1 };
+    int cached_year{ -1 };
+    /// @brief Начало последних декодированных суток
+    time_t cached_day_start{ 0 };
+
+private:
+    /// @brief Разбор целого числа из count цифр
+    static bool parse_digits(const char* text, size_t count, int* value)
+    {
+        int result = 0;
+        for (size_t index = 0; index < count; ++index) {
+            unsigned digit = static_cast<unsigned>(text[index] - '0');
+            if (digit > 9) {
+                return false;
+            }
+            result = 10 * result + static_cast<int>(digit);
+        }
+        *value = result;
+        return true;
+    }
+
+public:
+    /// @brief Декодирует дату
+    /// @param begin Начало строки с датой
+    /// @param end Конец строки с датой
+    /// @return UNIX-время
+    time_t decode(const char* begin, const char* end)
+    {
+        // dd.mm.YYYY HH:MM:SS
+        constexpr size_t length = 19;
+        int day, month, year, hours, minutes, seconds;
+        if (static_cast<size_t>(end - begin) != length ||
+            begin[2] != '.' || begin[5] != '.' || begin[10] != ' ' || begin[13] != ':' || begin[16] != ':' ||
+            !parse_digits(begin, 2, &day) || !parse_digits(begin + 3, 2, &month) ||
+            !parse_digits(begin + 6, 4, &year) || !parse_digits(begin + 11, 2, &hours) ||
+            !parse_digits(begin + 14, 2, &minutes) || !parse_digits(begin + 17, 2, &seconds))
+        {
+            // Нестандартная запись даты - общий медленный путь
+            return StringToUnix(string(begin, end));
+        }
+
+        if (day != cached_day || month != cached_month || year != cached_year) {
+            struct tm tm {};
+            tm.tm_mday = day;
+            tm.tm_mon = month - 1;
+            tm.tm_year = year - 1900;
+            tm.tm_isdst = 0;
+            cached_day_start = mktime(&tm);
+            cached_day = day;
+            cached_month = month;
+            cached_year = year;
+        }
+        return cached_day_start + 3600 * hours + 60 * minutes + seconds;
+    }
+};
+
 /// @brief Чтение исторических данных по одному тегу
 class csv_tag_reader
 {
-public:
-    /// @brief Чтение исторических данных
-    /// @param input_stream Входной поток
+    /// @brief Размер файла, начиная с которого он разбирается параллельно по частям
+    static constexpr size_t parallel_threshold = 4 << 20;
+    /// @brief Минимальный размер части файла при параллельном разборе
+    static constexpr size_t min_chunk_size = 1 << 20;
+
+    /// @brief Пул потоков для параллельного разбора (создается при первом разборе большого файла
+    /// и переиспользуется всеми читателями; вызовы из разных потоков выполняются по очереди)
+    static pde_solvers::thread_pool_t& get_parse_pool() {
+        static pde_solvers::thread_pool_t pool;
+        return pool;
+    }
+
+    /// @brief Результат разбора части данных
+    struct parsed_chunk_t {
+        vector<time_t> t;
+        vector<double> x;
+        /// @brief Разбор остановлен на метке времени позже конца периода
+        bool stopped{ false };
+    };
+
+    /// @brief Разбор значения с заданным разделителем целой и дробной частей
+    /// (совпадает с str2double для корректных чисел)
+    static double parse_value(const char* begin, const char* end, char delim)
+    {
+        while (begin != end && (*begin == ' ' || *begin == '\t')) {
+            ++begin;
+        }
+        if (begin != end && *begin == '+') {
+            ++begin;
+        }
+        char buffer[64];
+        size_t length = static_cast<size_t>(end - begin);
+        if (length >= sizeof(buffer)) {
+            return str2double(string(begin, end), delim);
+        }
+        std::copy(begin, end, buffer);
+        if (delim != '.') {
+            char* delimiter = std::find(buffer, buffer + length, delim);
+            if (delimiter != buffer + length) {
+                *delimiter = '.';
+            }
+        }
+        double value = 0;
+        std::from_chars(buffer, buffer + length, value);
+        return value;
+    }
+
+    /// @brief Последовательный разбор строк "дата;значение" из буфера без выделения памяти на строку
+    /// @param begin Начало данных (начало строки)
+    /// @param end Конец данных
     /// @param dimension Инструкция для перевода единиц измерения
     /// @param time_begin Начало периода
     /// @param time_end Конец периода
-    /// @return Временной ряд в формате пары векторов: [Метки времени; Значения параметра]
-    static pair<vector<time_t>, vector<double>> read_from_stream(std::istream& input_stream, const string& dimension, time_t time_begin = std::numeric_limits<time_t>::min(),
-        time_t time_end = std::numeric_limits<time_t>::max())
+    /// @param result Метки времени и значения, признак остановки на конце периода
+    static void parse_buffer(const char* begin, const char* end, const string& dimension,
+        time_t time_begin, time_t time_end, parsed_chunk_t* result)
     {
-        vector<time_t> t;
-        vector<double> x;
+        std::pair<double, double> coefficients;
+        bool convert = dimension_converter().get_coefficients(dimension, &coefficients);
+        csv_datetime_decoder_t decoder;
 
-        string line_from_file;
-        vector<string> split_line_to_file;
-        while (getline(input_stream, line_from_file))
-        {
-            split_line_to_file = split_str(line_from_file, ';');
-            const auto& date = split_line_to_file[0];
-            time_t ut = StringToUnix(date);
+        constexpr size_t approximate_line_length = 24;
+        result->t.reserve(result->t.size() + (end - begin) / approximate_line_length);
+        result->x.reserve(result->x.size() + (end - begin) / approximate_line_length);
 
-            if (ut < time_begin) {
-                continue;
+        const char* line = begin;
+        while (line < end) {
+            const char* line_end = std::find(line, end, '\n');
+            const char* content_end = line_end;
+            if (content_end != line && content_end[-1] == '\r') {
+                --content_end;
+            }
+            if (content_end != line) {
+                const char* separator = std::find(line, content_end, ';');
+                time_t ut = decoder.decode(line, separator);
+                if (ut > time_end) {
+                    result->stopped = true;
+                    return;
+                }
+                if (ut >= time_begin) {
+                    if (separator == content_end) {
+                        throw std::runtime_error("csv_tag_reader: value is missing in line " +
+                            string(line, content_end));
+                    }
+                    const char* value_end = std::find(separator + 1, content_end, ';');
+                    double value = parse_value(separator + 1, value_end, ',');
+                    if (convert) {
+                        value = dimension_converter::convert_dimension(value, coefficients);
+                    }
+                    result->t.push_back(ut);
+                    result->x.push_back(value);
+                }
             }
-            if (ut > time_end) {
+            if (line_end == end) {
                 break;
             }
+            line = line_end + 1;
+        }
+    }
+
+public:
+    /// @brief Чтение исторических данных из буфера в памяти
+    /// Большие буферы разбираются параллельно по частям, результат совпадает с последовательным разбором
+    /// @param begin Начало данных
+    /// @param end Конец данных
+    /// @param dimension Инструкция для перевода единиц измерения
+    /// @param time_begin Начало периода
+    /// @param time_end Конец периода
+    /// @return Временной ряд в формате пары векторов: [Метки времени; Значения параметра]
+    static pair<vector<time_t>, vector<double>> read_from_buffer(const char* begin, const char* end,
+        const string& dimension, time_t time_begin = (std::numeric_limits<time_t>::min)(),
+        time_t time_end = (std::numeric_limits<time_t>::max)())
+    {
+        size_t size = static_cast<size_t>(end - begin);
+        size_t chunk_count = size < parallel_threshold
+            ? 1
+            : (std::min<size_t>)(get_parse_pool().get_thread_count(), size / min_chunk_size);
+        if (chunk_count < 2) {
+            parsed_chunk_t result;
+            parse_buffer(begin, end, dimension, time_begin, time_end, &result);
+            return std::make_pair(std::move(result.t), std::move(result.x));
+        }
 
-            double value = str2double(split_line_to_file[1], ',');
+        // Границы частей сдвигаются на начало строки
+        vector<const char*> bounds{ begin };
+        for (size_t index = 1; index < chunk_count; ++index) {
+            const char* bound = (std::max)(bounds.back(), begin + index * size / chunk_count);
+            bound = std::find(bound, end, '\n');
+            bounds.push_back(bound == end ? end : bound + 1);
+        }
+        bounds.push_back(end);
 
-            dimension_converter converter;
-            value = converter.convert(value, dimension);
+        vector<parsed_chunk_t> chunks(chunk_count);
+        vector<std::exception_ptr> errors(chunk_count);
+        // Ошибки запоминаются по частям: ошибка после конца периода не должна прерывать разбор
+        get_parse_pool().parallel_for(chunk_count, [&](size_t index) {
+            try {
+                parse_buffer(bounds[index], bounds[index + 1], dimension, time_begin, time_end, &chunks[index]);
+            }
+            catch (...) {
+                errors[index] = std::current_exception();
+            }
+            });
 
-            t.emplace_back(std::move(ut));
-            x.emplace_back(std::move(value));
+        // Части склеиваются до первой остановки на конце периода, как при последовательном разборе
+        size_t used_count = 0;
+        size_t total_size = 0;
+        while (used_count < chunk_count) {
+            if (errors[used_count]) {
+                std::rethrow_exception(errors[used_count]);
+            }
+            total_size += chunks[used_count].t.size();
+            if (chunks[used_count++].stopped) {
+                break;
+            }
         }
+        pair<vector<time_t>, vector<double>> result;
+        result.first.reserve(total_size);
+        result.second.reserve(total_size);
+        for (size_t index = 0; index < used_count; ++index) {
+            result.first.insert(result.first.end(), chunks[index].t.begin(), chunks[index].t.end());
+            result.second.insert(result.second.end(), chunks[index].x.begin(), chunks[index].x.end());
+        }
+        return result;
+    }
 
-        return std::make_pair(t, x);
+    /// @brief Чтение исторических данных
+    /// @param input_stream Входной поток
+    /// @param dimension Инструкция для перевода единиц измерения
+    /// @param time_begin Начало периода
+    /// @param time_end Конец периода
+    /// @return Временной ряд в формате пары векторов: [Метки времени; Значения параметра]
+    static pair<vector<time_t>, vector<double>> read_from_stream(std::istream& input_stream, const string& dimension, time_t time_begin = (std::numeric_limits<time_t>::min)(),
+        time_t time_end = (std::numeric_limits<time_t>::max)())
+    {
+        string content{ std::istreambuf_iterator<char>(input_stream), std::istreambuf_iterator<char>() };
+        return read_from_buffer(content.data(), content.data() + content.size(), dimension, time_begin, time_end);
     }
 private:
-    /// @brief Чтение одного файла 
+    /// @brief Чтение одного файла (файл отображается в память)
     /// @param filename Название файла
     /// @param dimension Инструкция перевода 
     /// единиц измерения
     /// @param time_begin Начало периода
     /// @param time_end Конец периода
     /// @return Временной ряд в формате пары векторов: [Метки времени; Значения параметра]
-    static pair<vector<time_t>, vector<double>> read_from_file(const string& filename, const string& dimension, time_t time_begin = std::numeric_limits<time_t>::min(),
-        time_t time_end = std::numeric_limits<time_t>::max())
+    static pair<vector<time_t>, vector<double>> read_from_file(const string& filename, const string& dimension, time_t time_begin = (std::numeric_limits<time_t>::min)(),
+        time_t time_end = (std::numeric_limits<time_t>::max)())
     {
-        std::ifstream infile(filename);
-        if (!infile)
-            throw std::runtime_error("file is not exist");
-
-        return read_from_stream(infile, dimension, time_begin, time_end);
+        pde_solvers::mapped_file_t file(filename); // отсутствующий файл - исключение std::runtime_error
+        return read_from_buffer(file.get_data(), file.get_data() + file.get_size(), dimension, time_begin, time_end);
     }
 public:
     /// @brief Конструктор
@@ -105,8 +309,8 @@ public:
     /// @return возвращает временной ряд в формате 
     /// для хранения в vector_timeseries_t
     pair<vector<time_t>, vector<double>> read_csv(
-        time_t start_period = std::numeric_limits<time_t>::min(),
-        time_t end_period = std::numeric_limits<time_t>::max()) const
+        time_t start_period = (std::numeric_limits<time_t>::min)(),
+        time_t end_period = (std::numeric_limits<time_t>::max)()) const
     {
         pair<vector<time_t>, vector<double>> data;
 
@@ -156,8 +360,8 @@ public:
     /// @return возвращает временной ряд в формате 
     /// для хранения в vector_timeseries_t
     vector<pair<vector<time_t>, vector<double>>> read_csvs(
-        time_t start_period = std::numeric_limits<time_t>::min(),
-        time_t end_period = std::numeric_limits<time_t>::max()) const
+        time_t start_period = (std::numeric_limits<time_t>::min)(),
+        time_t end_period = (std::numeric_limits<time_t>::max)()) const
     {
         vector<pair<vector<time_t>, vector<double>>> data;
 
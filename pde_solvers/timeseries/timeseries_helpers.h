@@ -112,6 +112,21 @@ public:
         return value;
     }
 
+    /// @brief Коэффициенты перевода по инструкции. Позволяет искать инструкцию 
+    /// один раз на весь временной ряд, а не для каждого значения
+    /// @param dimension Инструкция перевода
+    /// @param coefficients Коэффициенты для convert_dimension
+    /// @return false, если инструкция неизвестна (значения не переводятся)
+    bool get_coefficients(const std::string& dimension, std::pair<double, double>* coefficients) const
+    {
+        auto it = units.find(dimension);
+        if (it == units.end()) {
+            return false;
+        }
+        *coefficients = it->second;
+        return true;
+    }
+
 private:
     /// @brief Коэффициенты для перевода единиц
     const std::map<std::string, std::pair<double, double>> units{
@@ -11,9 +11,9 @@ private:
     /// @brief Исходные временные ряды
     vector<pair<vector<time_t>, vector<double>>> data;
     /// @brief Самое позднее начальное время среди временных рядов
-    time_t start_date{ std::numeric_limits<time_t>::min() };
+    time_t start_date{ (std::numeric_limits<time_t>::min)() };
     /// @brief Самое ранее конечное время среди временных рядов
-    time_t end_date{ std::numeric_limits<time_t>::max() };
+    time_t end_date{ (std::numeric_limits<time_t>::max)() };
     /// @brief Начальные точки индексов временных рядов, создающие левую границу при поиске во времени
     mutable vector<size_t> left_bound;
 
@@ -55,6 +55,14 @@ public:
     time_t get_end_date() const {
         return end_date;
     }
+    /// @brief Количество временных рядов
+    size_t get_series_count() const {
+        return data.size();
+    }
+    /// @brief Исходные временные ряды (неизменяемые, могут разделяться курсорами)
+    const vector<pair<vector<time_t>, vector<double>>>& get_data() const {
+        return data;
+    }
 
     /// @brief Возвращает интерполированные значения 
     /// временных рядов в момент времени t
@@ -119,12 +127,12 @@ private:
     /// @return Начало и конец периода
     static pair<time_t, time_t> get_timeseries_period(const vector<pair<vector<time_t>, vector<double>>>& data)
     {
-        time_t start_date = std::numeric_limits<time_t>::min();
-        time_t end_date = std::numeric_limits<time_t>::max();;
+        time_t start_date = (std::numeric_limits<time_t>::min)();
+        time_t end_date = (std::numeric_limits<time_t>::max)();;
         for (size_t i = 0; i < data.size(); ++i) {
             if (!data[i].first.empty()) {
-                start_date = std::max(start_date, data[i].first.front());
-                end_date = std::min(end_date, data[i].first.back());
+                start_date = (std::max)(start_date, data[i].first.front());
+                end_date = (std::min)(end_date, data[i].first.back());
             }
         }
 
@@ -133,4 +141,282 @@ private:
         }
         return std::make_pair(start_date, end_date);
     }
-};
\ No newline at end of file
+};
+
+/// @brief Курсор интерполяции векторного временного ряда
+/// Хранит собственные позиции в рядах, поэтому несколько курсоров (члены ансамбля, потоки)
+/// могут независимо читать один неизменяемый vector_timeseries_t
+/// При монотонном движении во времени позиция сдвигается за амортизированное O(1),
+/// при движении назад выполняется двоичный поиск (без исключения, в отличие от operator())
+/// Результат совпадает с vector_timeseries_t::operator(), память не выделяется
+class vector_timeseries_cursor_t {
+    /// @brief Количество шагов линейного поиска вперед, после которого используется двоичный поиск
+    static constexpr size_t linear_search_limit = 8;
+    /// @brief Временные ряды
+    const vector_timeseries_t& timeseries;
+    /// @brief Индексы последних точек рядов с моментом времени не позже запрошенного
+    vector<size_t> positions;
+
+private:
+    /// @brief Сдвигает позицию так, чтобы times[position] <= t < times[position + 1]
+    /// (position = 0, если t раньше начала ряда)
+    static size_t find_position(const vector<time_t>& times, time_t t, size_t position)
+    {
+        if (t < times[position]) {
+            // Движение назад во времени
+            auto it = std::upper_bound(times.begin(), times.begin() + position, t);
+            return it == times.begin() ? 0 : static_cast<size_t>(it - times.begin()) - 1;
+        }
+        for (size_t step = 0; step < linear_search_limit; ++step) {
+            if (position + 1 >= times.size() || times[position + 1] > t) {
+                return position;
+            }
+            position++;
+        }
+        // Большой скачок вперед
+        auto it = std::upper_bound(times.begin() + position, times.end(), t);
+        return static_cast<size_t>(it - times.begin()) - 1;
+    }
+
+public:
+    /// @brief Создает курсор, установленный на начало рядов
+    /// @param timeseries Временные ряды. Должны существовать, пока используется курсор
+    explicit vector_timeseries_cursor_t(const vector_timeseries_t& timeseries)
+        : timeseries(timeseries)
+        , positions(timeseries.get_series_count(), 0)
+    {
+    }
+
+    /// @brief Количество интерполируемых значений
+    size_t size() const {
+        return positions.size();
+    }
+
+    /// @brief Интерполирует значения всех рядов в момент времени t
+    /// Вне периода ряда (до начала или после конца) возвращается NaN
+    /// @param t Момент времени
+    /// @param result Массив не менее чем из size() значений
+    void interpolate(time_t t, double* result)
+    {
+        const auto& data = timeseries.get_data();
+        for (size_t i = 0; i < data.size(); ++i) {
+            const vector<time_t>& times = data[i].first;
+            const vector<double>& values = data[i].second;
+            if (times.empty()) {
+                result[i] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+            size_t k = positions[i] = find_position(times, t, positions[i]);
+            if (times[k] == t) {
+                result[i] = values[k];
+            }
+            else if (times[k] > t || k + 1 == times.size()) {
+                // До начала или после конца ряда
+                result[i] = std::numeric_limits<double>::quiet_NaN();
+            }
+            else {
+                time_t t_prev = times[k];
+                time_t t_next = times[k + 1];
+
+                // Если t=t_prev, будет 0, если t=t_next, будет 1
+                double alpha = 1.0 * (t - t_prev) / (t_next - t_prev);
+
+                result[i] = (1 - alpha) * values[k] + alpha * values[k + 1];
+            }
+        }
+    }
+
+    /// @brief Интерполирует значения всех рядов в момент времени t
+    /// @param t Момент времени
+    /// @param result Вектор результата. Память выделяется только при первом вызове
+    void interpolate(time_t t, vector<double>* result)
+    {
+        result->resize(size());
+        interpolate(t, result->data());
+    }
+};
+
+/// @brief Значения временных рядов на равномерной сетке по времени, предрассчитанные одним проходом
+/// Строка row - значения всех рядов в момент start_time + row * time_step; строки хранятся
+/// непрерывно одна за другой (время - строки, ряды - столбцы), поэтому расчет по сетке читает
+/// краевые условия последовательно по указателю на строку (row) без поиска и интерполяции на шаге
+/// Каждый ряд проходится один раз слиянием с сеткой; значения совпадают с vector_timeseries_cursor_t
+/// (вне периода ряда - NaN)
+class timeseries_matrix_t {
+    /// @brief Момент времени первой строки
+    time_t start_time{ 0 };
+    /// @brief Шаг сетки по времени, с
+    time_t time_step{ 1 };
+    /// @brief Количество строк (моментов времени)
+    size_t row_count{ 0 };
+    /// @brief Количество столбцов (рядов)
+    size_t column_count{ 0 };
+    /// @brief Значения по строкам
+    vector<double> values;
+
+public:
+    timeseries_matrix_t() = default;
+    /// @brief Значения рядов в моменты start_time + row * time_step, row = 0..row_count - 1
+    /// @param timeseries Временные ряды
+    /// @param start_time Момент времени первой строки
+    /// @param time_step Шаг сетки по времени, с (больше нуля)
+    /// @param row_count Количество строк
+    timeseries_matrix_t(const vector_timeseries_t& timeseries, time_t start_time, time_t time_step,
+        size_t row_count)
+        : start_time(start_time)
+        , time_step(time_step)
+        , row_count(row_count)
+        , column_count(timeseries.get_series_count())
+        , values(row_count * column_count)
+    {
+        if (time_step <= 0) {
+            throw std::logic_error("timeseries_matrix_t: time step must be positive");
+        }
+        const auto& data = timeseries.get_data();
+        for (size_t column = 0; column < column_count; ++column) {
+            const vector<time_t>& times = data[column].first;
+            const vector<double>& series_values = data[column].second;
+            double* result = values.data() + column;
+            size_t k = 0; // последняя точка ряда не позже момента строки (или 0)
+            for (size_t row = 0; row < row_count; ++row, result += column_count) {
+                time_t t = get_time(row);
+                if (times.empty()) {
+                    *result = std::numeric_limits<double>::quiet_NaN();
+                    continue;
+                }
+                while (k + 1 < times.size() && times[k + 1] <= t) {
+                    ++k;
+                }
+                if (times[k] == t) {
+                    *result = series_values[k];
+                }
+                else if (times[k] > t || k + 1 == times.size()) {
+                    // До начала или после конца ряда
+                    *result = std::numeric_limits<double>::quiet_NaN();
+                }
+                else {
+                    time_t t_prev = times[k];
+                    time_t t_next = times[k + 1];
+                    double alpha = 1.0 * (t - t_prev) / (t_next - t_prev);
+                    *result = (1 - alpha) * series_values[k] + alpha * series_values[k + 1];
+                }
+            }
+        }
+    }
+    /// @brief Значения рядов на равномерной сетке с шагом time_step по всему периоду рядов
+    /// (последняя строка - не позже конца периода)
+    static timeseries_matrix_t resample(const vector_timeseries_t& timeseries, time_t time_step)
+    {
+        time_t duration = timeseries.get_duration();
+        size_t row_count = time_step > 0 && duration >= 0
+            ? static_cast<size_t>(duration / time_step) + 1
+            : 0;
+        return timeseries_matrix_t(timeseries, timeseries.get_start_date(), time_step, row_count);
+    }
+    /// @brief Количество строк (моментов времени)
+    size_t get_row_count() const {
+        return row_count;
+    }
+    /// @brief Количество столбцов (рядов)
+    size_t get_column_count() const {
+        return column_count;
+    }
+    /// @brief Шаг сетки по времени, с
+    time_t get_time_step() const {
+        return time_step;
+    }
+    /// @brief Момент времени строки
+    time_t get_time(size_t row) const {
+        return start_time + static_cast<time_t>(row) * time_step;
+    }
+    /// @brief Значения рядов в строке (get_column_count() значений)
+    const double* row(size_t index) const {
+        return values.data() + index * column_count;
+    }
+    /// @brief Все значения по строкам
+    const vector<double>& get_values() const {
+        return values;
+    }
+};
+
+/// @brief Выбор шага по времени с учетом отсчетов временных рядов краевых условий
+/// Моменты отсчетов всех рядов объединяются; событием считается отсчет, в котором
+/// кусочно-линейная интерполяция ряда меняет наклон (скачок, начало или конец изменения),
+/// а также конец периода рядов. Отсчеты на участках постоянного или линейно меняющегося
+/// значения событиями не являются, поэтому через такие участки шаг ограничивается только
+/// устойчивостью. Шаги - целые секунды, поэтому момент времени задачи не накапливает
+/// ошибку округления, а события попадают точно на начало шага
+class timeseries_time_step_controller_t {
+    /// @brief Моменты событий по возрастанию (без повторов)
+    vector<time_t> event_times;
+    /// @brief Индекс первого события позже последнего запрошенного момента
+    size_t position{ 0 };
+
+private:
+    /// @brief Признак излома кусочно-линейной интерполяции ряда в отсчете index
+    static bool is_knot(const vector<time_t>& times, const vector<double>& values, size_t index,
+        double relative_tolerance)
+    {
+        double t_prev = static_cast<double>(times[index - 1]);
+        double t_next = static_cast<double>(times[index + 1]);
+        double alpha = (static_cast<double>(times[index]) - t_prev) / (t_next - t_prev);
+        double interpolated = (1 - alpha) * values[index - 1] + alpha * values[index + 1];
+        double tolerance = relative_tolerance * (std::max)({ std::abs(values[index - 1]),
+            std::abs(values[index]), std::abs(values[index + 1]) });
+        return std::abs(values[index] - interpolated) > tolerance;
+    }
+
+public:
+    /// @param timeseries Временные ряды краевых условий
+    /// @param relative_tolerance Относительное отклонение значения в отсчете от интерполяции
+    /// по соседним отсчетам, начиная с которого отсчет считается событием (0 - любой излом)
+    timeseries_time_step_controller_t(const vector_timeseries_t& timeseries, double relative_tolerance = 0)
+    {
+        time_t start_date = timeseries.get_start_date();
+        time_t end_date = timeseries.get_end_date();
+        for (const auto& [times, values] : timeseries.get_data()) {
+            for (size_t index = 1; index + 1 < times.size(); ++index) {
+                if (times[index] > start_date && times[index] < end_date &&
+                    is_knot(times, values, index, relative_tolerance))
+                {
+                    event_times.push_back(times[index]);
+                }
+            }
+        }
+        event_times.push_back(end_date);
+        std::sort(event_times.begin(), event_times.end());
+        event_times.erase(std::unique(event_times.begin(), event_times.end()), event_times.end());
+    }
+    /// @brief Моменты событий по возрастанию
+    const vector<time_t>& get_event_times() const {
+        return event_times;
+    }
+    /// @brief Шаг по времени из момента t: наибольшее целое число секунд не больше max_dt,
+    /// не переходящее через ближайшее событие позже t
+    /// Шаги - целые секунды, поэтому при max_dt < 1 с (мелкая сетка, быстрое течение)
+    /// допустимого шага нет и выбрасывается исключение
+    /// При монотонном движении во времени поиск события - амортизированное O(1)
+    /// @param t Момент начала шага
+    /// @param max_dt Наибольший допустимый шаг, с (например, для Cr = 1); NaN - шаг до события
+    /// @return Шаг, с; 0, если t не раньше конца периода рядов
+    time_t get_time_step(time_t t, double max_dt)
+    {
+        if (position > 0 && event_times[position - 1] > t) {
+            position = std::upper_bound(event_times.begin(), event_times.end(), t) - event_times.begin();
+        }
+        while (position < event_times.size() && event_times[position] <= t) {
+            ++position;
+        }
+        if (position == event_times.size()) {
+            return 0;
+        }
+        if (max_dt < 1) {
+            throw std::logic_error("timeseries_time_step_controller_t: max time step is less than 1 s");
+        }
+        time_t event_step = event_times[position] - t;
+        if (!(max_dt < static_cast<double>(event_step))) {
+            return event_step;
+        }
+        return static_cast<time_t>(max_dt);
+    }
+};
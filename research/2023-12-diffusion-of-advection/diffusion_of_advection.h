@@ -101,7 +101,7 @@ protected:
 
         const auto& x = advection_model->get_grid();
         double dx = x[1] - x[0];
-        double dt_ideal = abs(dx / v); // Расчёт идеального шага по времени
+        double dt_ideal = std::abs(dx / v); // Расчёт идеального шага по времени
 
         double t = 0; // текущее время
 
@@ -140,7 +140,7 @@ protected:
         
         for (size_t index = 0; index < parameter.size() - 1; ++index)
         {
-            if ((abs(parameter[index] - density_initial) < eps) && (abs(parameter[index + 1] - density_initial) >= eps))
+            if ((std::abs(parameter[index] - density_initial) < eps) && (std::abs(parameter[index + 1] - density_initial) >= eps))
             {
                 start_diff = time[index];
                 break;
@@ -149,7 +149,7 @@ protected:
 
         for (size_t index = parameter.size() - 1; index > 0; --index)
         {
-            if ((abs(parameter[index] - density_final) < eps) && (abs(parameter[index - 1] - density_final) >= eps))
+            if ((std::abs(parameter[index] - density_final) < eps) && (std::abs(parameter[index - 1] - density_final) >= eps))
             {
                 end_diff = time[index];
                 break;
@@ -282,7 +282,7 @@ protected:
 
         const auto& x = advection_model->get_grid();
         double dx = x[1] - x[0];
-        double dt_ideal = abs(dx / v);
+        double dt_ideal = std::abs(dx / v);
 
         double t = 0; // текущее время
 
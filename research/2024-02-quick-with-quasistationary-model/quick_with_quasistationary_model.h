@@ -106,28 +106,22 @@ public:
         isothermal_quasistatic_task_t<Solver> task(pipe);
         task.solve(initial_boundaries);
 
-        time_t t = boundary_timeseries.get_start_date(); // Момент времени начала моделирования
-
-        // Печатаем профиль трубы и первый слой к нему
+        // Результаты пишутся в фоновом потоке. Для исследований нужны все слои,
+        // поэтому при заполнении очереди расчет ждет писателя, а не пропускает слой
+        async_layer_writer_settings_t writer_settings;
+        writer_settings.queue_capacity = 8;
+        writer_settings.wait_if_full = true;
+        async_layer_writer_t writer(
+            std::make_unique<csv_layer_sink_t>(path, task.get_output_profile_names()),
+            writer_settings);
+
+        // Печатаем профиль трубы и к нему начальный слой и слои всех шагов моделирования
         task.print_profile(path);
-        task.print_all(t, path);
-
-        do
-        {
-            // Интерполируем значения параметров в заданный момент времени
-            vector<double> values_in_time_model = boundary_timeseries(t);
-            isothermal_quasistatic_task_boundaries_t boundaries(values_in_time_model);
-
-            double time_step = dt;
-            if (std::isnan(time_step)) {
-                double v = boundaries.volumetric_flow / pipe.wall.getArea(); 
-                time_step = task.get_time_step_assuming_max_speed(v);
-            }
-            t += static_cast<time_t>(time_step);
+        for (const auto& [t, layer] : quasistatic_simulation_t(task, boundary_timeseries, dt)) {
+            task.print_all(t, writer);
+        }
 
-            task.step(time_step, boundaries);
-            task.print_all(t, path);
-        } while (t < boundary_timeseries.get_end_date());
+        writer.flush();
     }
 };
 
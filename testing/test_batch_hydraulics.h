@@ -0,0 +1,111 @@
+﻿#pragma once
+
+/// @brief Труба с рельефом и профилями партий в ячейках: три партии с границами в точках сетки
+static void prepare_batch_hydraulics_case(pipe_properties_t* pipe,
+    vector<double>* density, vector<double>* viscosity)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 20e3;
+    simple_pipe.dx = 100;
+    *pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    size_t n = pipe->profile.getPointCount();
+    for (size_t index = 0; index < n; ++index) {
+        pipe->profile.heights[index] = 30 * sin(3e-4 * pipe->profile.coordinates[index]);
+    }
+    density->assign(n - 1, 850);
+    viscosity->assign(n - 1, 15e-6);
+    for (size_t index = 53; index < 121; ++index) {
+        (*density)[index] = 870;
+        (*viscosity)[index] = 40e-6;
+    }
+    for (size_t index = 121; index < n - 1; ++index) {
+        (*density)[index] = 830;
+        (*viscosity)[index] = 5e-6;
+    }
+}
+
+/// @brief Давления на концах и профиль давления по участкам партий совпадают с методом Эйлера
+/// для партий в ячейках в обоих направлениях расчета
+TEST(BatchHydraulics, MatchesEulerForCellBatches)
+{
+    pipe_properties_t pipe;
+    vector<double> density, viscosity;
+    prepare_batch_hydraulics_case(&pipe, &density, &viscosity);
+    size_t n = pipe.profile.getPointCount();
+
+    batch_hydraulic_solver_t solver(pipe,
+        batch_hydraulic_solver_t::get_batches(pipe, density, viscosity));
+    ASSERT_EQ(solver.get_batches().size(), 3);
+    ASSERT_EQ(solver.get_batches()[1].begin, pipe.profile.coordinates[53]);
+
+    double flow = 0.5;
+    double pressure_in = 6e6;
+    vector<double> expected(n);
+    isothermal_pipe_PQ_parties_t<double> model_forward(pipe, density, viscosity, flow, +1);
+    solve_euler<1>(model_forward, +1, pressure_in, &expected);
+
+    ASSERT_NEAR(solver.solve_PQ(pressure_in, flow), expected.back(), 1e-9 * pressure_in);
+    vector<double> pressure;
+    solver.calc_pressure_profile(pressure_in, flow, &pressure);
+    ASSERT_EQ(pressure.size(), n);
+    for (size_t index = 0; index < n; ++index) {
+        ASSERT_NEAR(pressure[index], expected[index], 1e-9 * pressure_in);
+    }
+
+    double pressure_out = 1e6;
+    isothermal_pipe_PQ_parties_t<double> model_backward(pipe, density, viscosity, flow, -1);
+    solve_euler<1>(model_backward, -1, pressure_out, &expected);
+    ASSERT_NEAR(solver.solve_QP(pressure_out, flow), expected.front(), 1e-9 * pressure_in);
+}
+
+/// @brief Расход по давлениям на концах обращает расчет давления на выходе, в том числе при обратном течении
+TEST(BatchHydraulics, SolvePPInvertsSolvePQ)
+{
+    pipe_properties_t pipe;
+    vector<double> density, viscosity;
+    prepare_batch_hydraulics_case(&pipe, &density, &viscosity);
+    batch_hydraulic_solver_t solver(pipe,
+        batch_hydraulic_solver_t::get_batches(pipe, density, viscosity));
+
+    for (double flow : { 0.8, 0.2, 0.01, -0.4 }) {
+        double pressure_in = 5e6;
+        double pressure_out = solver.solve_PQ(pressure_in, flow);
+        ASSERT_NEAR(solver.solve_PP(pressure_in, pressure_out), flow, 1e-6 * std::abs(flow));
+    }
+}
+
+/// @brief Для партий в точках границы участков - середины между точками; одинаковые точки объединяются
+TEST(BatchHydraulics, BatchesFromPointProfile)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 1000;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    vector<float> density{ 850, 850, 850, 870, 870, 870, 870, 850, 850, 850, 850 };
+    vector<float> viscosity(density.size(), 15e-6f);
+
+    vector<batch_segment_t> batches = batch_hydraulic_solver_t::get_batches(pipe, density, viscosity);
+    ASSERT_EQ(batches.size(), 3);
+    ASSERT_EQ(batches[0].begin, 0);
+    ASSERT_EQ(batches[1].begin, 250);
+    ASSERT_EQ(batches[1].density, 870);
+    ASSERT_EQ(batches[2].begin, 650);
+
+    ASSERT_THROW(batch_hydraulic_solver_t::get_batches(pipe, density, vector<float>(3)), std::runtime_error);
+}
+
+/// @brief Участки, не начинающиеся в начале трубы или не упорядоченные, отклоняются
+TEST(BatchHydraulics, RejectsInvalidBatches)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 1000;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+
+    ASSERT_THROW(batch_hydraulic_solver_t(pipe, {}), std::runtime_error);
+    ASSERT_THROW(batch_hydraulic_solver_t(pipe, { { 100, 850, 15e-6 }, { 500, 870, 15e-6 } }),
+        std::runtime_error);
+    ASSERT_THROW(batch_hydraulic_solver_t(pipe, { { 0, 850, 15e-6 }, { 500, 870, 15e-6 }, { 300, 850, 15e-6 } }),
+        std::runtime_error);
+    ASSERT_NO_THROW(batch_hydraulic_solver_t(pipe, { { 0, 850, 15e-6 }, { 500, 870, 15e-6 } }));
+}
@@ -0,0 +1,173 @@
+﻿#pragma once
+
+/// @brief Буфер составных слоев восстанавливается вместе с положением текущего слоя
+TEST(Checkpoint, RestoresCompositeLayerBuffer)
+{
+    typedef composite_layer_t<profile_collection_t<2, 1>,
+        profile_collection_t<0, 0, 1, 2>> layer_type;
+
+    string path = prepare_test_folder();
+    string filename = path + "state.checkpoint";
+
+    ring_buffer_t<layer_type> buffer(3, 11);
+    for (int offset = 0; offset < 3; ++offset) {
+        layer_type& layer = buffer[offset];
+        for (size_t index = 0; index < 11; ++index) {
+            layer.vars.point_double[0][index] = 100 * offset + index;
+            layer.vars.point_double[1][index] = -(100.0 * offset + index) / 3;
+            std::get<0>(layer.specific).point_vector[0][index] = { 1.0 * offset, 0.5 * index };
+        }
+        for (size_t index = 0; index < 10; ++index) {
+            layer.vars.cell_double[0][index] = 1e6 + offset + index / 7.0;
+        }
+    }
+    buffer.advance(+1);
+
+    checkpoint_image_t image;
+    write_state(&image, buffer);
+    write_checkpoint_file(filename, "composite", 42.5, image);
+
+    ring_buffer_t<layer_type> restored(3, 2); // размеры профилей берутся из контрольной точки
+    double time = load_checkpoint(filename, "composite", &restored);
+    ASSERT_EQ(time, 42.5);
+    for (int offset = 0; offset < 3; ++offset) {
+        ASSERT_EQ(restored[offset].vars.point_double, buffer[offset].vars.point_double);
+        ASSERT_EQ(restored[offset].vars.cell_double, buffer[offset].vars.cell_double);
+        ASSERT_EQ(std::get<0>(restored[offset].specific).point_vector,
+            std::get<0>(buffer[offset].specific).point_vector);
+    }
+
+    ASSERT_THROW(load_checkpoint(filename, "other", &restored), std::runtime_error);
+    ring_buffer_t<layer_type> wrong_layer_count(2, 11);
+    ASSERT_THROW(load_checkpoint(filename, "composite", &wrong_layer_count), std::runtime_error);
+}
+
+/// @brief Поврежденные размеры и байты образа отклоняются до выделения памяти
+TEST(Checkpoint, RejectsCorruptedImage)
+{
+    string path = prepare_test_folder();
+    string filename = path + "corrupted.checkpoint";
+
+    vector<double> values{ 1.0, 2.0, 3.0 };
+    checkpoint_image_t image;
+    write_state(&image, values);
+
+    // Размер вектора, не помещающийся в образ
+    vector<char> data = image.get_data();
+    uint64_t huge_count = uint64_t(1) << 60;
+    std::memcpy(data.data(), &huge_count, sizeof(huge_count));
+    checkpoint_reader_t reader(data.data(), data.size());
+    vector<double> restored;
+    ASSERT_THROW(read_state(&reader, &restored), std::runtime_error);
+
+    write_checkpoint_file(filename, "values", 1.0, image);
+    ASSERT_EQ(load_checkpoint(filename, "values", &restored), 1.0);
+    ASSERT_EQ(restored, values);
+
+    std::string contents;
+    {
+        std::ifstream file(filename, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    auto rewrite = [&](const std::string& bytes) {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), bytes.size());
+    };
+
+    std::string flipped = contents;
+    flipped.back() ^= 0x01;
+    rewrite(flipped);
+    ASSERT_THROW(load_checkpoint(filename, "values", &restored), std::runtime_error);
+
+    rewrite(contents.substr(0, contents.size() - 8));
+    ASSERT_THROW(load_checkpoint(filename, "values", &restored), std::runtime_error);
+
+    // Другая версия формата (в том числе без контрольной суммы) не читается
+    std::string old_version = contents;
+    uint32_t version = 1;
+    std::memcpy(&old_version[8], &version, sizeof(version));
+    rewrite(old_version);
+    ASSERT_THROW(load_checkpoint(filename, "values", &restored), std::runtime_error);
+
+    // Длина вида, превышающая размер файла
+    std::string long_kind = contents;
+    uint32_t huge_kind_size = 0xFFFFFFF0u;
+    std::memcpy(&long_kind[12], &huge_kind_size, sizeof(huge_kind_size));
+    rewrite(long_kind);
+    ASSERT_THROW(load_checkpoint(filename, "values", &restored), std::runtime_error);
+}
+
+/// @brief Расчет, продолженный с контрольной точки, совпадает с непрерывным побитово
+TEST(Checkpoint, ResumedQuasistaticTaskMatchesContinuousRun)
+{
+    typedef isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> task_type;
+
+    string path = prepare_test_folder();
+    string filename = path + "task.checkpoint";
+
+    simple_pipe_properties simple_pipe;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+    double dt = 0.5 * simple_pipe.dx / (boundaries.volumetric_flow / pipe.wall.getArea());
+
+    auto make_step = [&](task_type& task, size_t step) {
+        isothermal_quasistatic_task_boundaries_t step_boundaries = boundaries;
+        step_boundaries.density += (step % 7 < 3) ? 10 : 0;
+        task.step(dt, step_boundaries);
+    };
+
+    task_type task(pipe);
+    task.solve(boundaries);
+    {
+        checkpoint_writer_t writer(filename, task_type::get_checkpoint_kind());
+        for (size_t step = 0; step < 10; ++step) {
+            make_step(task, step);
+        }
+        ASSERT_TRUE(writer.save(10 * dt, task));
+        writer.wait();
+        ASSERT_EQ(writer.get_written_count(), 1);
+    }
+    for (size_t step = 10; step < 20; ++step) {
+        make_step(task, step);
+    }
+
+    // Перезапуск: задача создается по другой трубе, состояние полностью берется из контрольной точки
+    task_type resumed_task(pipe_properties_t::build_simple_pipe(simple_pipe_properties()));
+    double time = load_checkpoint(filename, task_type::get_checkpoint_kind(), &resumed_task);
+    ASSERT_EQ(time, 10 * dt);
+    for (size_t step = 10; step < 20; ++step) {
+        make_step(resumed_task, step);
+    }
+
+    auto& expected = task.get_buffer().current();
+    auto& actual = resumed_task.get_buffer().current();
+    ASSERT_EQ(actual.density, expected.density);
+    ASSERT_EQ(actual.pressure, expected.pressure);
+    ASSERT_EQ(actual.pressure_delta, expected.pressure_delta);
+    ASSERT_EQ(resumed_task.get_coordinates(), task.get_coordinates());
+}
+
+/// @brief Пока предыдущая контрольная точка записывается, новая пропускается без ожидания
+TEST(Checkpoint, SkipsSaveWhileWriterIsBusy)
+{
+    string path = prepare_test_folder();
+    string filename = path + "state.checkpoint";
+
+    vector<double> state(1 << 22, 1.0); // 32 МБ
+    checkpoint_writer_t writer(filename, "vector");
+    size_t saved_count = 0;
+    for (size_t index = 0; index < 5; ++index) {
+        state[0] = static_cast<double>(index);
+        saved_count += writer.save(index, state) ? 1 : 0;
+    }
+    writer.wait();
+    ASSERT_EQ(saved_count + writer.get_skipped_count(), 5);
+    ASSERT_EQ(writer.get_written_count(), saved_count);
+
+    vector<double> restored;
+    double time = load_checkpoint(filename, "vector", &restored);
+    ASSERT_EQ(restored.size(), state.size());
+    ASSERT_EQ(restored[0], time);
+}
@@ -159,6 +159,139 @@ TEST(UniformProfile, PlotProfilesFromDifferentSourceProfiles)
 
 }
 
+/// @brief Для разреженного профиля максимум высотки на области притяжения 
+/// определяется точно по кусочно-линейному исходному профилю, без его уплотнения
+TEST(UniformProfile, TakesExactExtremumOfSparseProfile)
+{
+	PipeProfile source_prof;
+	source_prof.coordinates = { 0, 1000, 2000 };
+	source_prof.heights = { 0, 100, 0 };
+	source_prof.capacity = { 10e6, 5e6, 10e6 };
+
+	PipeProfile new_prof = create_uniform_profile(source_prof, 500);
+
+	ASSERT_EQ(new_prof.coordinates, vector<double>({ 0, 500, 1000, 1500, 2000 }));
+	ASSERT_EQ(new_prof.heights, vector<double>({ 0, 75, 100, 75, 0 }));
+	ASSERT_EQ(new_prof.capacity, vector<double>({ 10e6, 6.25e6, 5e6, 6.25e6, 10e6 }));
+}
+
+/// @brief Результат однопроходного построения совпадает с перебором мелкой выборки 
+/// исходного профиля по областям притяжения
+TEST(UniformProfile, MatchesBruteForceSampling)
+{
+	PipeProfile source_prof;
+	double x = 0;
+	for (size_t index = 0; index < 200; ++index) {
+		source_prof.coordinates.push_back(x);
+		source_prof.heights.push_back(50 * sin(0.37 * index) + 0.1 * index);
+		source_prof.capacity.push_back(8e6 + 1e6 * cos(0.23 * index));
+		x += 20 + 130 * (index % 7) / 6.0; // неравномерный шаг от 20 до 150 м
+	}
+
+	double desired_dx = 100;
+	PipeProfile new_prof = create_uniform_profile(source_prof, desired_dx);
+	const vector<double>& grid = new_prof.coordinates;
+	size_t n = grid.size();
+	double segment = grid[1] - grid[0]; // шаг сетки не меньше желаемого
+	ASSERT_NEAR(new_prof.heights.front(), source_prof.heights.front(), 1e-12);
+	ASSERT_NEAR(new_prof.heights.back(), source_prof.heights.back(), 1e-12);
+
+	// Интерполяция исходного профиля в точке
+	auto interpolate = [&](const vector<double>& values, double point) {
+		const vector<double>& coordinates = source_prof.coordinates;
+		if (point <= coordinates.front())
+			return values.front();
+		if (point >= coordinates.back())
+			return values.back();
+		size_t index = std::upper_bound(coordinates.begin(), coordinates.end(), point) - coordinates.begin() - 1;
+		double alpha = (point - coordinates[index]) / (coordinates[index + 1] - coordinates[index]);
+		return values[index] + alpha * (values[index + 1] - values[index]);
+	};
+
+	for (size_t j = 1; j + 1 < n; ++j) {
+		double left = j == 1 ? grid.front() : grid[j - 1] + 0.5 * segment;
+		double right = j + 2 == n ? grid.back() : grid[j] + 0.5 * segment;
+		double max_height = -std::numeric_limits<double>::infinity();
+		double min_capacity = std::numeric_limits<double>::infinity();
+		for (double point : source_prof.coordinates) {
+			if (point > left && point < right) {
+				max_height = std::max(max_height, interpolate(source_prof.heights, point));
+				min_capacity = std::min(min_capacity, interpolate(source_prof.capacity, point));
+			}
+		}
+		for (double point : { left, right }) {
+			max_height = std::max(max_height, interpolate(source_prof.heights, point));
+			min_capacity = std::min(min_capacity, interpolate(source_prof.capacity, point));
+		}
+		ASSERT_NEAR(new_prof.heights[j], max_height, 1e-9);
+		ASSERT_NEAR(new_prof.capacity[j], min_capacity, 1e-6);
+	}
+}
+
+/// @brief Быстрый разбор файла профиля совпадает с построчным чтением через потоки
+TEST(UniformProfile, ParsesCoordinatesAndHeights)
+{
+	std::string content = "km;m\r\n0;100.5\r\n 0.25 ; -3e1\r\n\r\n1.5;7;comment\r\n";
+	vector<vector<double>> coord_heights = parse_coordinates_and_heights(content.data(), content.size());
+	ASSERT_EQ(coord_heights[0], vector<double>({ 0, 250, 1500 }));
+	ASSERT_EQ(coord_heights[1], vector<double>({ 100.5, -30, 7 }));
+
+	std::string wrong_content = "km;m\n0,5;100\n";
+	ASSERT_THROW(parse_coordinates_and_heights(wrong_content.data(), wrong_content.size()), std::runtime_error);
+}
+
+/// @brief Пакетная подготовка профилей: параллельный результат совпадает с последовательным,
+/// при повторном запуске профили берутся из кэша, измененный файл строится заново
+TEST(UniformProfile, PreparesProfilesInParallelWithCache)
+{
+	string path = prepare_test_folder();
+	string cache_folder = path + "cache/";
+	std::filesystem::remove_all(cache_folder);
+
+	vector<string> filenames;
+	for (size_t file_index = 0; file_index < 6; ++file_index) {
+		string filename = path + "profile_" + std::to_string(file_index) + ".csv";
+		std::ofstream file(filename);
+		file << "km;m\n";
+		for (size_t index = 0; index <= 300; ++index) {
+			file << 0.037 * index << ";" << 100 + 20 * sin(0.1 * index + file_index) << "\n";
+		}
+		filenames.push_back(filename);
+	}
+	filenames.push_back(filenames.front()); // повторяющийся файл
+
+	uniform_profile_batch_settings_t settings;
+	settings.desired_segment = 200;
+	settings.cache_folder = cache_folder;
+	thread_pool_t pool(4);
+
+	size_t cache_hits;
+	vector<PipeProfile> cold = prepare_uniform_profiles(filenames, settings, &pool, &cache_hits);
+	ASSERT_EQ(cache_hits, 0);
+	ASSERT_EQ(cold.size(), filenames.size());
+	for (size_t index = 0; index < filenames.size(); ++index) {
+		PipeProfile expected = pipe_profile_uniform::get_uniform_profile_from_csv(200, filenames[index]);
+		ASSERT_EQ(cold[index].coordinates, expected.coordinates);
+		ASSERT_EQ(cold[index].heights, expected.heights);
+		ASSERT_EQ(cold[index].capacity, expected.capacity);
+	}
+
+	vector<PipeProfile> warm = prepare_uniform_profiles(filenames, settings, &pool, &cache_hits);
+	ASSERT_EQ(cache_hits, 6);
+	for (size_t index = 0; index < filenames.size(); ++index) {
+		ASSERT_EQ(warm[index].coordinates, cold[index].coordinates);
+		ASSERT_EQ(warm[index].heights, cold[index].heights);
+	}
+
+	// Изменение файла и шага меняют ключ кэша
+	std::ofstream(filenames[2], std::ios::app) << "11.2;150\n";
+	prepare_uniform_profiles(filenames, settings, &pool, &cache_hits);
+	ASSERT_EQ(cache_hits, 5);
+	settings.desired_segment = 250;
+	prepare_uniform_profiles(filenames, settings, &pool, &cache_hits);
+	ASSERT_EQ(cache_hits, 0);
+}
+
 /// @brief Пример созддания профиля, когда исходный профиль считывается из файла
 TEST(UniformProfile, UseCaseSourceProfFromFile)
 {
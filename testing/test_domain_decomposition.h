@@ -0,0 +1,160 @@
+﻿#pragma once
+
+/// @brief Подобласти покрывают диапазон без пропусков и пересечений
+TEST(DomainDecomposition, CoversRangeExactlyOnce)
+{
+    thread_pool_t pool(4);
+    domain_decomposition_t decomposition(pool, 1001, 100);
+    ASSERT_EQ(decomposition.get_subdomain_count(), 4);
+
+    // Диапазон ячеек (на одну меньше точек) и внутренних точек
+    for (auto [begin, end] : { std::make_pair<size_t, size_t>(0, 1000), std::make_pair<size_t, size_t>(1, 1000) }) {
+        vector<std::atomic<int>> visits(1001);
+        decomposition.for_each_subdomain(begin, end, [&](size_t subdomain_begin, size_t subdomain_end) {
+            for (size_t index = subdomain_begin; index < subdomain_end; ++index) {
+                visits[index]++;
+            }
+        });
+        for (size_t index = 0; index < visits.size(); ++index) {
+            ASSERT_EQ(visits[index], index >= begin && index < end ? 1 : 0);
+        }
+    }
+
+    // Короткая сетка не дробится
+    domain_decomposition_t short_decomposition(pool, 150, 100);
+    ASSERT_EQ(short_decomposition.get_subdomain_count(), 1);
+}
+
+/// @brief Параллельный шаг солверов конечных объемов побитово совпадает с последовательным,
+/// в том числе при смене направления течения на границе подобластей
+TEST(DomainDecomposition, FiniteVolumeSolversMatchSerialBitwise)
+{
+    typedef composite_layer_t<upstream_fv_solver::var_layer_data, upstream_fv_solver::specific_layer> layer_t;
+
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 100e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    size_t n = pipe.profile.getPointCount();
+
+    thread_pool_t pool(4);
+    domain_decomposition_t decomposition(pool, n, 100);
+    // Расход меняет знак ровно на границе первой подобласти
+    size_t boundary = decomposition.get_subdomain(1).first;
+    vector<double> Q(n);
+    for (size_t index = 0; index < n; ++index) {
+        Q[index] = index < boundary ? 0.5 : -0.5;
+    }
+    PipeQAdvection reversing_model(pipe, Q);
+    vector<double> Q_forward(n, 0.5);
+    PipeQAdvection forward_model(pipe, Q_forward);
+
+    auto initial_layer = [&](layer_t* layer) {
+        vector<double>& U = layer->vars.cell_double[0];
+        for (size_t cell = 0; cell < U.size(); ++cell) {
+            U[cell] = 850 + 10 * sin(0.05 * cell) + (cell % 17 == 0 ? 5 : 0);
+        }
+    };
+    double dt = 0.5 * simple_pipe.dx / (0.5 / pipe.wall.getArea());
+
+    auto run = [&](auto step, const domain_decomposition_t* used_decomposition) {
+        ring_buffer_t<layer_t> buffer(2, n);
+        initial_layer(&buffer.current());
+        for (size_t index = 0; index < 100; ++index) {
+            buffer.advance(+1);
+            step(buffer, used_decomposition);
+        }
+        return buffer.current().vars.cell_double[0];
+    };
+
+    auto upstream_step = [&](ring_buffer_t<layer_t>& buffer, const domain_decomposition_t* used_decomposition) {
+        upstream_fv_solver solver(reversing_model, buffer);
+        solver.step(dt, 860, 840, used_decomposition);
+    };
+    ASSERT_EQ(run(upstream_step, nullptr), run(upstream_step, &decomposition));
+
+    auto quickest_ultimate_step = [&](ring_buffer_t<layer_t>& buffer, const domain_decomposition_t* used_decomposition) {
+        quickest_ultimate_fv_solver solver(forward_model, 
+            buffer.previous().vars.cell_double[0], buffer.current().vars.cell_double[0],
+            std::get<0>(buffer.previous().specific), std::get<0>(buffer.current().specific));
+        solver.step(dt, 860, 840, used_decomposition);
+    };
+    ASSERT_EQ(run(quickest_ultimate_step, nullptr), run(quickest_ultimate_step, &decomposition));
+}
+
+/// @brief Параллельный шаг метода характеристик (гидроудар) побитово совпадает с последовательным
+TEST(DomainDecomposition, WaterhammerMatchesSerialBitwise)
+{
+    typedef composite_layer_t<profile_collection_t<2>, moc_solver<2>::specific_layer> layer_t;
+
+    pipe_properties_t pipe;
+    pipe.profile = PipeProfile::create(2000, 0, 200e3, 0, 0, 10e6);
+    oil_parameters_t oil;
+    PipeModelPGConstArea pipe_model(pipe, oil);
+
+    double G = 400;
+    double Pout = 5e5;
+    thread_pool_t pool(4);
+    domain_decomposition_t decomposition(pool, pipe.profile.getPointCount(), 100);
+
+    auto run = [&](const domain_decomposition_t* used_decomposition) {
+        ring_buffer_t<layer_t> buffer(2, pipe.profile.getPointCount());
+        profile_wrapper<double, 2> start_layer(get_profiles_pointers(buffer.current().vars.point_double));
+        solve_euler_corrector<2>(pipe_model, -1, { Pout, G }, &start_layer);
+
+        auto left_boundary = pipe_model.const_mass_flow_equation(G + 50);
+        auto right_boundary = pipe_model.const_pressure_equation(Pout);
+        for (size_t index = 0; index < 50; ++index) {
+            buffer.advance(+1);
+            moc_layer_wrapper<2> moc_current(buffer.current().vars, std::get<0>(buffer.current().specific));
+            moc_layer_wrapper<2> moc_previous(buffer.previous().vars, std::get<0>(buffer.previous().specific));
+            moc_solver<2> solver(pipe_model, moc_previous, moc_current);
+            solver.step(left_boundary, right_boundary, std::numeric_limits<double>::quiet_NaN(), used_decomposition);
+        }
+        return buffer.current().vars.point_double;
+    };
+
+    auto serial = run(nullptr);
+    auto parallel = run(&decomposition);
+    ASSERT_EQ(serial[0], parallel[0]);
+    ASSERT_EQ(serial[1], parallel[1]);
+}
+
+/// @brief Квазистационарная задача с разбиением сетки рассчитывает те же партии (побитово)
+/// и тот же профиль давления (с точностью до порядка суммирования), что и без разбиения
+TEST(DomainDecomposition, QuasistaticTaskMatchesSerial)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 50e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    size_t n = pipe.profile.getPointCount();
+
+    thread_pool_t pool(4);
+    domain_decomposition_t decomposition(pool, n, 100);
+
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> serial_task(pipe);
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> parallel_task(pipe);
+    parallel_task.set_decomposition(&decomposition);
+    serial_task.solve(boundaries);
+    parallel_task.solve(boundaries);
+
+    double v = boundaries.volumetric_flow / pipe.wall.getArea();
+    double dt = 0.5 * serial_task.get_time_step_assuming_max_speed(v);
+    boundaries.density = 870;
+    boundaries.viscosity = 25e-6;
+    for (size_t step = 0; step < 100; ++step) {
+        serial_task.step(dt, boundaries);
+        parallel_task.step(dt, boundaries);
+    }
+
+    const auto& serial_layer = serial_task.get_buffer().current();
+    const auto& parallel_layer = parallel_task.get_buffer().current();
+    ASSERT_EQ(parallel_layer.density, serial_layer.density);
+    ASSERT_EQ(parallel_layer.viscosity, serial_layer.viscosity);
+    for (size_t index = 0; index < n; ++index) {
+        ASSERT_NEAR(parallel_layer.pressure[index], serial_layer.pressure[index], 1e-3);
+    }
+}
@@ -0,0 +1,116 @@
+﻿#pragma once
+
+/// @brief Префиксные суммы дерева Фенвика совпадают с непосредственным суммированием после изменений
+TEST(IncrementalPressure, FenwickTreePrefixSums)
+{
+    vector<double> values(37);
+    for (size_t index = 0; index < values.size(); ++index) {
+        values[index] = 0.5 * static_cast<double>(index % 7) - 1;
+    }
+    fenwick_tree_t tree(values);
+    ASSERT_EQ(tree.size(), values.size());
+
+    for (size_t change = 0; change < 20; ++change) {
+        size_t index = (change * 11) % values.size();
+        double delta = 0.25 * static_cast<double>(change) - 2;
+        values[index] += delta;
+        tree.add(index, delta);
+
+        double sum = 0;
+        for (size_t count = 0; count <= values.size(); ++count) {
+            ASSERT_NEAR(tree.prefix_sum(count), sum, 1e-12);
+            if (count < values.size()) {
+                sum += values[count];
+            }
+        }
+    }
+}
+
+/// @brief После изменения реологии на участке и пересчета только затронутых приращений
+/// профиль давления побитово совпадает с полным расчетом solve_euler,
+/// для партий в точках и в ячейках, в обоих направлениях
+TEST(IncrementalPressure, PartialUpdateMatchesSolveEuler)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 20e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    size_t n = pipe.profile.getPointCount();
+    for (size_t index = 0; index < n; ++index) {
+        pipe.profile.heights[index] = 30 * sin(3e-4 * pipe.profile.coordinates[index]);
+    }
+
+    for (size_t rheology_size : { n, n - 1 }) {
+        for (int direction : { +1, -1 }) {
+            vector<double> density(rheology_size, 850);
+            vector<double> viscosity(rheology_size, 15e-6);
+            double initial_pressure = direction > 0 ? 6e6 : 1e6;
+            isothermal_pipe_PQ_parties_t<double> model(pipe, density, viscosity, 0.5, direction);
+
+            incremental_euler_solver_t solver;
+            solver.build(model, direction, initial_pressure);
+
+            // Фронт партии на участке [40, 47) и изменение на краях профиля
+            for (auto [begin, end] : { std::make_pair<size_t, size_t>(40, 47),
+                std::make_pair<size_t, size_t>(0, 1), std::make_pair(rheology_size - 1, rheology_size) })
+            {
+                for (size_t index = begin; index < end; ++index) {
+                    density[index] = 870;
+                    viscosity[index] = 25e-6;
+                }
+                auto [grid_begin, grid_end] = model.get_grid_range_by_rheology_range(begin, end);
+                solver.update(model, grid_begin, grid_end);
+
+                vector<double> expected(n);
+                solve_euler<1>(model, direction, initial_pressure, &expected);
+                ASSERT_EQ(solver.get_profile(), expected);
+                for (size_t index = 0; index < n; index += 7) {
+                    ASSERT_NEAR(solver.get_value(index), expected[index], 1e-9 * initial_pressure);
+                }
+            }
+
+            solver.set_initial_condition(initial_pressure + 1e5);
+            vector<double> expected(n);
+            solve_euler<1>(model, direction, initial_pressure + 1e5, &expected);
+            ASSERT_EQ(solver.get_profile(), expected);
+        }
+    }
+}
+
+/// @brief Квазистационарная задача с инкрементальным расчетом давления дает тот же профиль давления,
+/// что и без него, в том числе при смене расхода и давления на входе
+TEST(IncrementalPressure, QuasistaticTaskMatchesFullRecalculation)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 30e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+
+    auto check_task = [&](auto full_task, auto incremental_task) {
+        incremental_task.set_incremental_pressure(true);
+
+        isothermal_quasistatic_task_boundaries_t boundaries =
+            isothermal_quasistatic_task_boundaries_t::default_values();
+        full_task.solve(boundaries);
+        incremental_task.solve(boundaries);
+
+        double v = boundaries.volumetric_flow / pipe.wall.getArea();
+        double dt = full_task.get_time_step_assuming_max_speed(v);
+        boundaries.density = 870;
+        boundaries.viscosity = 25e-6;
+        for (size_t step = 0; step < 120; ++step) {
+            if (step == 60) {
+                boundaries.volumetric_flow *= 0.9;
+                boundaries.pressure_in += 2e5;
+            }
+            full_task.step(dt, boundaries);
+            incremental_task.step(dt, boundaries);
+            ASSERT_EQ(incremental_task.get_buffer().current().pressure,
+                full_task.get_buffer().current().pressure);
+        }
+    };
+    check_task(isothermal_quasistatic_task_t<advection_moc_solver>(pipe),
+        isothermal_quasistatic_task_t<advection_moc_solver>(pipe));
+    check_task(isothermal_quasistatic_task_t<quickest_ultimate_fv_solver>(pipe),
+        isothermal_quasistatic_task_t<quickest_ultimate_fv_solver>(pipe));
+}
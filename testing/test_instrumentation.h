@@ -0,0 +1,94 @@
+﻿#pragma once
+
+/// @brief Накопитель фазы считает вызовы, суммарное и максимальное время
+TEST(Instrumentation, PhaseCounterAccumulatesTimes)
+{
+    phase_counter_t counter;
+    counter.add(1000);
+    counter.add(3000);
+    counter.add(2000);
+
+    phase_stats_t stats = counter.get();
+    ASSERT_EQ(stats.call_count, 3);
+    ASSERT_NEAR(stats.total_time, 6e-6, 1e-15);
+    ASSERT_NEAR(stats.max_time, 3e-6, 1e-15);
+    ASSERT_NEAR(stats.mean_time(), 2e-6, 1e-15);
+
+    counter.reset();
+    ASSERT_EQ(counter.get().call_count, 0);
+    ASSERT_EQ(counter.get().max_time, 0);
+}
+
+/// @brief Замер фазы учитывает время до конца области видимости
+TEST(Instrumentation, ScopedTimerMeasuresScope)
+{
+    phase_counter_t counter;
+    {
+        scoped_phase_timer_t timer(counter);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    phase_stats_t stats = counter.get();
+    ASSERT_EQ(stats.call_count, 1);
+    ASSERT_GE(stats.total_time, 2e-3);
+    ASSERT_EQ(stats.total_time, stats.max_time);
+}
+
+/// @brief Шаг квазистационарной задачи заполняет статистику фаз, если инструментирование включено,
+/// и не меняет ее, если точки замера не скомпилированы
+TEST(Instrumentation, QuasistaticTaskStepRecordsPhases)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 10e3;
+    simple_pipe.diameter = 0.7;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+
+    isothermal_quasistatic_task_t<advection_moc_solver> task(pipe);
+    task.solve(boundaries);
+
+    reset_instrumentation();
+    double v = boundaries.volumetric_flow / pipe.wall.getArea();
+    double dt = task.get_time_step_assuming_max_speed(v);
+    for (size_t step = 0; step < 5; ++step) {
+        task.step(dt, boundaries);
+    }
+    instrumentation_stats_t stats = get_instrumentation_stats();
+
+    if (instrumentation_t::enabled) {
+        ASSERT_EQ(stats.make_rheology_step.call_count, 5);
+        ASSERT_EQ(stats.calc_pressure_layer.call_count, 5);
+        ASSERT_GT(stats.calc_pressure_layer.total_time, 0);
+        // Эйлер первого порядка: одна правая часть на каждую точку, кроме последней
+        ASSERT_EQ(stats.pde_callbacks, 5 * (pipe.profile.getPointCount() - 1));
+    }
+    else {
+        ASSERT_EQ(stats.make_rheology_step.call_count, 0);
+        ASSERT_EQ(stats.calc_pressure_layer.call_count, 0);
+        ASSERT_EQ(stats.pde_callbacks, 0);
+    }
+}
+
+/// @brief Периодический вывод печатает таблицу фаз по истечении периода и обнуляет статистику
+TEST(Instrumentation, PeriodicDumpPrintsAndResets)
+{
+    reset_instrumentation();
+    instrumentation_t::instance().calc_pressure_layer.add(5000);
+    instrumentation_t::instance().newton_iterations += 7;
+
+    std::ostringstream output;
+    periodic_instrumentation_dump_t dump(output, 3600);
+    ASSERT_FALSE(dump.poll()); // период еще не истек
+    ASSERT_TRUE(output.str().empty());
+
+    periodic_instrumentation_dump_t immediate_dump(output, 0);
+    ASSERT_TRUE(immediate_dump.poll());
+    string text = output.str();
+    ASSERT_NE(text.find("calc_pressure_layer"), string::npos);
+    ASSERT_NE(text.find("newton_iterations 7"), string::npos);
+
+    instrumentation_stats_t stats = get_instrumentation_stats();
+    ASSERT_EQ(stats.calc_pressure_layer.call_count, 0);
+    ASSERT_EQ(stats.newton_iterations, 0);
+}
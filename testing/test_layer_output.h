@@ -0,0 +1,284 @@
+﻿#pragma once
+
+/// @brief Приемник, сохраняющий снимки в памяти (для проверки писателя)
+class memory_layer_sink_t : public layer_sink_t {
+public:
+    vector<layer_snapshot_t> snapshots;
+    virtual void write(const layer_snapshot_t& snapshot) override {
+        snapshots.push_back(snapshot);
+    }
+};
+
+/// @brief Читает файл целиком в строку
+inline std::string read_whole_file(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+/// @brief Фоновый писатель с CSV-приемником дает те же файлы, что и синхронный print_all
+TEST(AsyncLayerWriter, CsvSinkMatchesPrintAll)
+{
+    string path = prepare_test_folder();
+    string path_sync = path + "sync/";
+    string path_async = path + "async/";
+    std::filesystem::create_directories(path_sync);
+    std::filesystem::create_directories(path_async);
+    for (const string& folder : { path_sync, path_async }) {
+        for (const auto& entry : std::filesystem::directory_iterator(folder)) {
+            std::filesystem::remove_all(entry.path());
+        }
+    }
+
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe_properties());
+    isothermal_quasistatic_task_t<advection_moc_solver> task(pipe);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+    task.solve(boundaries);
+
+    time_t t = 1712583773;
+    {
+        async_layer_writer_settings_t settings;
+        settings.wait_if_full = true;
+        async_layer_writer_t writer(
+            std::make_unique<csv_layer_sink_t>(path_async, task.get_output_profile_names()), settings);
+        for (size_t step = 0; step < 5; ++step) {
+            double dt = task.get_time_step_assuming_max_speed(
+                boundaries.volumetric_flow / pipe.wall.getArea());
+            boundaries.density += 1;
+            task.step(dt, boundaries);
+            t += static_cast<time_t>(dt);
+            task.print_all(t, path_sync);
+            task.print_all(t, writer);
+        }
+    }
+
+    for (const string& name : isothermal_quasistatic_task_t<advection_moc_solver>::get_output_profile_names()) {
+        string sync_content = read_whole_file(path_sync + "output " + name + ".csv");
+        string async_content = read_whole_file(path_async + "output " + name + ".csv");
+        ASSERT_FALSE(sync_content.empty());
+        ASSERT_EQ(sync_content, async_content);
+    }
+}
+
+/// @brief Проверка прореживания по времени и по пространству
+TEST(AsyncLayerWriter, HandlesDecimation)
+{
+    auto sink = std::make_unique<memory_layer_sink_t>();
+    memory_layer_sink_t& memory_sink = *sink;
+
+    async_layer_writer_settings_t settings;
+    settings.time_decimation = 2;
+    settings.space_decimation = 3;
+    settings.wait_if_full = true;
+
+    vector<double> points(11);
+    vector<double> cells(10);
+    async_layer_writer_t writer(std::move(sink), settings);
+    for (size_t step = 0; step < 5; ++step) {
+        for (size_t index = 0; index < points.size(); ++index) {
+            points[index] = 100.0 * step + index;
+        }
+        for (size_t index = 0; index < cells.size(); ++index) {
+            cells[index] = -(100.0 * step + index);
+        }
+        writer.push(static_cast<double>(step), points, cells);
+    }
+    writer.flush(); // после flush фоновый поток не обращается к приемнику
+    ASSERT_EQ(writer.get_written_count(), 3);
+
+    // Записываются слои 0, 2, 4
+    ASSERT_EQ(memory_sink.snapshots.size(), 3);
+    ASSERT_EQ(memory_sink.snapshots[1].time, 2.0);
+    // Точки 0, 3, 6, 9 и обязательно последняя 10
+    ASSERT_EQ(memory_sink.snapshots[1].profiles[0], vector<double>({ 200, 203, 206, 209, 210 }));
+    // Ячейки 0, 3, 6, 9 - последняя уже попала в прореживание
+    ASSERT_EQ(memory_sink.snapshots[1].profiles[1], vector<double>({ -200, -203, -206, -209 }));
+}
+
+/// @brief При заполненной очереди поток расчета не ждет, а пропускает слой
+TEST(AsyncLayerWriter, SkipsLayersWhenQueueIsFull)
+{
+    /// @brief Приемник, блокирующий запись до разрешения из теста
+    class blocking_sink_t : public layer_sink_t {
+        std::mutex& mutex;
+    public:
+        blocking_sink_t(std::mutex& mutex)
+            : mutex(mutex)
+        {}
+        virtual void write(const layer_snapshot_t&) override {
+            std::lock_guard<std::mutex> lock(mutex);
+        }
+    };
+
+    std::mutex disk_mutex;
+    std::unique_lock<std::mutex> disk_lock(disk_mutex); // "диск" занят
+
+    async_layer_writer_settings_t settings;
+    settings.queue_capacity = 2;
+    async_layer_writer_t writer(std::make_unique<blocking_sink_t>(disk_mutex), settings);
+
+    vector<double> profile(100, 1.0);
+    ASSERT_TRUE(writer.push(0, profile));
+    ASSERT_TRUE(writer.push(1, profile));
+    ASSERT_FALSE(writer.push(2, profile));
+    ASSERT_EQ(writer.get_dropped_count(), 1);
+
+    disk_lock.unlock();
+    writer.flush();
+    ASSERT_EQ(writer.get_written_count(), 2);
+}
+
+/// @brief Запись и чтение бинарного файла истории профилей через отображение в память
+TEST(BinaryProfileFormat, WritesAndReadsBackWithoutParsing)
+{
+    string path = prepare_test_folder();
+    string filename = path + "history.pdeprof";
+
+    vector<binary_profile_info_t> profiles(2);
+    profiles[0].name = "pressure";
+    profiles[0].units = "Pa";
+    profiles[0].value_count = 11;
+    profiles[1].name = "density";
+    profiles[1].units = "kg/m3";
+    profiles[1].on_cells = true;
+    profiles[1].value_count = 10;
+    vector<double> grid(11);
+    for (size_t index = 0; index < grid.size(); ++index) {
+        grid[index] = 100.0 * index;
+    }
+
+    auto make_layer = [](size_t step) {
+        vector<vector<double>> layer{ vector<double>(11), vector<double>(10) };
+        for (size_t index = 0; index < 11; ++index) {
+            layer[0][index] = 1e6 + 0.1 * step + index / 3.0;
+        }
+        for (size_t index = 0; index < 10; ++index) {
+            layer[1][index] = 850 + step + index / 7.0;
+        }
+        return layer;
+    };
+
+    {
+        binary_profile_writer_t writer(filename, profiles, false, grid);
+        for (size_t step = 0; step < 5; ++step) {
+            writer.write(60.0 * step, make_layer(step));
+        }
+    }
+
+    binary_profile_reader_t reader(filename);
+    ASSERT_FALSE(reader.is_float32());
+    ASSERT_EQ(reader.get_record_count(), 5);
+    ASSERT_EQ(reader.get_grid(), grid);
+    ASSERT_EQ(reader.get_profiles().size(), 2);
+    ASSERT_EQ(reader.get_profiles()[1].units, "kg/m3");
+    ASSERT_TRUE(reader.get_profiles()[1].on_cells);
+    ASSERT_EQ(reader.find_profile("density"), 1);
+
+    ASSERT_EQ(reader.get_time(3), 180.0);
+    ASSERT_EQ(reader.find_record(150.0), 3);
+    ASSERT_EQ(reader.find_record(1000.0), 5);
+
+    // Значения float64 доступны напрямую в отображении и совпадают побитово
+    vector<vector<double>> expected = make_layer(3);
+    const double* density = reader.get_values<double>(3, 1);
+    ASSERT_TRUE(std::equal(expected[1].begin(), expected[1].end(), density));
+    vector<double> pressure;
+    reader.read_profile(3, 0, &pressure);
+    ASSERT_EQ(pressure, expected[0]);
+    ASSERT_THROW(reader.get_values<float>(3, 1), std::logic_error);
+}
+
+/// @brief Файл незакрытого писателя (прерванный расчет) читается по размеру записей
+TEST(BinaryProfileFormat, ReadsUnclosedFloat32File)
+{
+    string path = prepare_test_folder();
+    string filename = path + "history.pdeprof";
+
+    vector<binary_profile_info_t> profiles(1);
+    profiles[0].name = "density";
+    profiles[0].value_count = 3; // нечетное количество float32 - с дополнением до 8 байт
+
+    binary_profile_writer_t writer(filename, profiles, true);
+    writer.write(0, { { 850.5, 851.25, 852.125 } });
+    writer.write(1, { { 860.5, 861.25, 862.125 } });
+    writer.flush();
+
+    binary_profile_reader_t reader(filename);
+    ASSERT_TRUE(reader.is_float32());
+    ASSERT_EQ(reader.get_record_count(), 2);
+    ASSERT_EQ(reader.get_time(1), 1.0);
+    const float* values = reader.get_values<float>(1, 0);
+    ASSERT_EQ(values[2], 862.125f);
+}
+
+/// @brief Бинарный приемник фонового писателя: те же значения, что в CSV, при меньшем размере
+TEST(AsyncLayerWriter, BinarySinkIsCompactAndExact)
+{
+    string path = prepare_test_folder();
+    for (const auto& entry : std::filesystem::directory_iterator(path)) {
+        std::filesystem::remove_all(entry.path());
+    }
+
+    typedef isothermal_quasistatic_task_t<advection_moc_solver> task_type;
+    simple_pipe_properties simple_pipe;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    task_type task(pipe);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+    task.solve(boundaries);
+
+    layer_snapshot_t last_layer;
+    time_t t = 1712583773;
+    {
+        async_layer_writer_settings_t settings;
+        settings.wait_if_full = true;
+        async_layer_writer_t csv_writer(
+            std::make_unique<csv_layer_sink_t>(path, task.get_output_profile_names()), settings);
+        async_layer_writer_t binary_writer(
+            std::make_unique<binary_layer_sink_t>(path + "output.pdeprof", 
+                task.get_output_profiles_info(), false, task.get_coordinates()), settings);
+        async_layer_writer_t float32_writer(
+            std::make_unique<binary_layer_sink_t>(path + "output32.pdeprof",
+                task.get_output_profiles_info(), true), settings);
+        auto memory_sink = std::make_unique<memory_layer_sink_t>();
+        memory_layer_sink_t& memory = *memory_sink;
+        async_layer_writer_t memory_writer(std::move(memory_sink), settings);
+        for (size_t step = 0; step < 20; ++step) {
+            double dt = task.get_time_step_assuming_max_speed(
+                boundaries.volumetric_flow / pipe.wall.getArea());
+            boundaries.density += 1;
+            task.step(dt, boundaries);
+            t += static_cast<time_t>(dt);
+            task.print_all(t, csv_writer);
+            task.print_all(t, binary_writer);
+            task.print_all(t, float32_writer);
+            task.print_all(t, memory_writer);
+        }
+        memory_writer.flush();
+        ASSERT_EQ(memory.snapshots.size(), 20);
+        last_layer = memory.snapshots.back();
+    }
+
+    binary_profile_reader_t reader(path + "output.pdeprof");
+    ASSERT_EQ(reader.get_record_count(), 20);
+    ASSERT_EQ(reader.get_time(19), static_cast<double>(t));
+    ASSERT_EQ(reader.get_grid(), pipe.profile.coordinates);
+    for (size_t profile = 0; profile < reader.get_profiles().size(); ++profile) {
+        vector<double> values;
+        reader.read_profile(19, profile, &values);
+        ASSERT_EQ(values, last_layer.profiles[profile]);
+    }
+
+    uintmax_t csv_size = 0;
+    for (const string& name : task_type::get_output_profile_names()) {
+        csv_size += std::filesystem::file_size(path + "output " + name + ".csv");
+    }
+    uintmax_t binary_size = std::filesystem::file_size(path + "output.pdeprof");
+    uintmax_t float32_size = std::filesystem::file_size(path + "output32.pdeprof");
+    ASSERT_LT(binary_size, csv_size);
+    ASSERT_LT(2 * float32_size, csv_size);
+}
@@ -53,6 +53,20 @@ inline std::string prepare_research_folder()
 #include "test_advection_moc_solver.h"
 #include "test_synthetic_timeseries.h"
 #include "test_create_pipe_profile.h"
+#include "test_layer_output.h"
+#include "test_checkpoint.h"
+#include "test_thread_pool.h"
+#include "test_quasistatic_network.h"
+#include "test_domain_decomposition.h"
+#include "test_mixed_precision.h"
+#include "test_instrumentation.h"
+#include "test_viscosity_table.h"
+#include "test_incremental_pressure.h"
+#include "test_batch_hydraulics.h"
+#include "test_scenario_fork.h"
+#include "test_quasistatic_simulation.h"
+#include "test_steady_state.h"
+#include "test_pipelined_step.h"
 
 #include "../research/2023-12-diffusion-of-advection/diffusion_of_advection.h"
 #include "../research/2024-02-quick-with-quasistationary-model/quick_with_quasistationary_model.h"
@@ -0,0 +1,164 @@
+﻿#pragma once
+
+/// @brief Максимальное отклонение профилей, хранящихся в разных типах
+template <typename ScalarA, typename ScalarB>
+inline double max_profile_deviation(const vector<ScalarA>& a, const vector<ScalarB>& b)
+{
+    double result = 0;
+    for (size_t index = 0; index < a.size(); ++index) {
+        result = std::max(result, std::abs(static_cast<double>(a[index]) - static_cast<double>(b[index])));
+    }
+    return result;
+}
+
+/// @brief QUICKEST-ULTIMATE на переменных в float совпадает с расчетом в double с точностью float
+TEST(MixedPrecision, FiniteVolumeSolverInFloat)
+{
+    typedef quickest_ultimate_fv_solver_t<scalar_fv_solver_traits<float>> float_solver;
+    typedef composite_layer_t<quickest_ultimate_fv_solver::var_layer_data,
+        quickest_ultimate_fv_solver::specific_layer> layer_t;
+    typedef composite_layer_t<float_solver::var_layer_data, float_solver::specific_layer> float_layer_t;
+
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 10e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    size_t point_count = pipe.profile.getPointCount();
+
+    vector<double> Q(point_count, 0.5);
+    PipeQAdvection advection_model(pipe, Q);
+    const auto& x = advection_model.get_grid();
+    double dt = 0.5 * (x[1] - x[0]) / advection_model.getEquationsCoeffs(0, 0);
+
+    ring_buffer_t<layer_t> buffer(2, point_count);
+    ring_buffer_t<float_layer_t> float_buffer(2, point_count);
+    buffer.previous().vars.cell_double[0].assign(point_count - 1, 850.0);
+    float_buffer.previous().vars.cell_double[0].assign(point_count - 1, 850.0f);
+
+    for (size_t step = 0; step < 200; ++step) {
+        double rho_in = step % 40 < 20 ? 870 : 850;
+        quickest_ultimate_fv_solver solver(advection_model, buffer);
+        solver.step(dt, rho_in, 850);
+        float_solver float_step_solver(advection_model, float_buffer);
+        float_step_solver.step(dt, rho_in, 850);
+        buffer.advance(+1);
+        float_buffer.advance(+1);
+    }
+
+    const vector<double>& rho = buffer.previous().vars.cell_double[0];
+    const vector<float>& rho_float = float_buffer.previous().vars.cell_double[0];
+    ASSERT_GT(*std::max_element(rho.begin(), rho.end()), 860); // партия вошла в трубу
+    ASSERT_LT(max_profile_deviation(rho, rho_float), 1e-2);
+}
+
+/// @brief Метод характеристик на профиле в float совпадает с расчетом в double с точностью float
+TEST(MixedPrecision, AdvectionMocInFloat)
+{
+    pipe_properties_t pipe = AdvectionMocSolver::PrepareTestPipe();
+    size_t point_count = pipe.profile.getPointCount();
+    double volumetric_flow = 0.5;
+
+    ring_buffer_t<vector<double>> buffer(2, point_count);
+    ring_buffer_t<vector<float>> float_buffer(2, point_count);
+    buffer.previous().assign(point_count, 850.0);
+    float_buffer.previous().assign(point_count, 850.0f);
+
+    for (size_t step = 0; step < 150; ++step) {
+        double rho_in = step % 30 < 15 ? 870 : 850;
+        advection_moc_solver solver(pipe, volumetric_flow, buffer.previous(), buffer.current());
+        double dt = 0.7 * solver.prepare_step();
+        solver.step(dt, rho_in, 850);
+        advection_moc_solver_t<float> float_solver(pipe, volumetric_flow,
+            float_buffer.previous(), float_buffer.current());
+        float_solver.step(dt, rho_in, 850);
+        buffer.advance(+1);
+        float_buffer.advance(+1);
+    }
+
+    ASSERT_LT(max_profile_deviation(buffer.previous(), float_buffer.previous()), 1e-2);
+}
+
+/// @brief Сравнивает квазистационарную задачу с партиями в double и в float
+template <typename Solver, typename FloatSolver>
+inline void check_float_quasistatic_task()
+{
+    typedef isothermal_quasistatic_task_t<Solver> task_type;
+    typedef isothermal_quasistatic_task_t<FloatSolver> float_task_type;
+
+    simple_pipe_properties simple_pipe;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+    double dt = 0.5 * simple_pipe.dx / (boundaries.volumetric_flow / pipe.wall.getArea());
+
+    task_type task(pipe);
+    float_task_type float_task(pipe);
+    task.solve(boundaries);
+    float_task.solve(boundaries);
+    ASSERT_NE(task_type::get_checkpoint_kind(), float_task_type::get_checkpoint_kind());
+
+    for (size_t step = 0; step < 100; ++step) {
+        isothermal_quasistatic_task_boundaries_t step_boundaries = boundaries;
+        step_boundaries.density += (step % 40 < 20) ? 20 : 0;
+        step_boundaries.viscosity *= (step % 40 < 20) ? 2 : 1;
+        task.step(dt, step_boundaries);
+        float_task.step(dt, step_boundaries);
+    }
+
+    const auto& layer = task.get_buffer().current();
+    const auto& float_layer = float_task.get_buffer().current();
+    static_assert(std::is_same<std::decay_t<decltype(float_layer.density)>, vector<float>>::value,
+        "density must be stored in float");
+    static_assert(std::is_same<std::decay_t<decltype(float_layer.pressure)>, vector<double>>::value,
+        "pressure must be stored in double");
+
+    ASSERT_LT(max_profile_deviation(layer.density, float_layer.density), 1e-2);
+    ASSERT_GT(max_profile_deviation(layer.pressure, task.get_pressure_initial()), 1e3); // партии повлияли на давление
+    ASSERT_LT(max_profile_deviation(layer.pressure, float_layer.pressure), 10);
+}
+
+/// @brief Квазистационарная задача с партиями в float: плотность и вязкость хранятся в float,
+/// давление рассчитывается в double и совпадает с расчетом в double с точностью партий
+TEST(MixedPrecision, QuasistaticTaskKeepsPressureInDouble)
+{
+    check_float_quasistatic_task<advection_moc_solver, advection_moc_solver_t<float>>();
+    check_float_quasistatic_task<quickest_ultimate_fv_solver,
+        quickest_ultimate_fv_solver_t<scalar_fv_solver_traits<float>>>();
+}
+
+/// @brief Память задачи: в слоях по времени только меняющиеся профили, начальное давление и потоки
+/// конечных объемов хранятся в одном экземпляре на задачу, профили партий в float занимают вдвое меньше
+TEST(MixedPrecision, QuasistaticTaskMemoryUsage)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 50e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    size_t n = pipe.profile.getPointCount();
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+
+    isothermal_quasistatic_task_t<advection_moc_solver> moc_task(pipe);
+    moc_task.solve(boundaries);
+    task_memory_usage_t moc_usage = moc_task.get_memory_usage();
+    // Два слоя: плотность, вязкость, давление и дифференциальное давление в точках
+    ASSERT_EQ(moc_usage.layers, 2 * 4 * n * sizeof(double));
+    // Координаты, высоты, несущая способность и начальный профиль давления
+    ASSERT_EQ(moc_usage.invariant, 4 * n * sizeof(double));
+    ASSERT_LT(moc_usage.scratch, 16 * sizeof(double));
+    ASSERT_EQ(moc_usage.total(), moc_usage.layers + moc_usage.invariant + moc_usage.scratch);
+
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> fv_task(pipe);
+    fv_task.solve(boundaries);
+    double dt = fv_task.get_time_step_assuming_max_speed(boundaries.volumetric_flow / pipe.wall.getArea());
+    fv_task.step(dt, boundaries);
+    task_memory_usage_t fv_usage = fv_task.get_memory_usage();
+    ASSERT_EQ(fv_usage.layers, 2 * (2 * (n - 1) + 2 * n) * sizeof(double));
+    // Один буфер потоков на задачу и профиль расхода
+    ASSERT_EQ(fv_usage.scratch, 2 * n * sizeof(double));
+
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver_t<scalar_fv_solver_traits<float>>> float_task(pipe);
+    float_task.solve(boundaries);
+    ASSERT_EQ(float_task.get_memory_usage().layers, 2 * (2 * (n - 1) * sizeof(float) + 2 * n * sizeof(double)));
+}
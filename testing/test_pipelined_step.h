@@ -0,0 +1,121 @@
+﻿#pragma once
+
+/// @brief Конвейерный расчет шагов дает побитово те же слои, что и последовательный, с задержкой
+/// давления на один шаг; flush_pipeline досчитывает давление последнего слоя
+TEST(PipelinedStep, MatchesSequentialSteps)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 30e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+
+    auto check_task = [&](auto sequential_task, auto pipelined_task, bool incremental_pressure) {
+        sequential_task.set_incremental_pressure(incremental_pressure);
+        pipelined_task.set_incremental_pressure(incremental_pressure);
+        pipelined_task.set_pipelined(true);
+
+        isothermal_quasistatic_task_boundaries_t boundaries =
+            isothermal_quasistatic_task_boundaries_t::default_values();
+        sequential_task.solve(boundaries);
+        pipelined_task.solve(boundaries);
+
+        double v = boundaries.volumetric_flow / pipe.wall.getArea();
+        double dt = sequential_task.get_time_step_assuming_max_speed(v);
+        boundaries.density = 870;
+        boundaries.viscosity = 25e-6;
+        auto previous_layer = sequential_task.get_buffer().current();
+        for (size_t step = 0; step < 80; ++step) {
+            if (step == 40) {
+                boundaries.volumetric_flow *= 0.9;
+                boundaries.pressure_in += 2e5;
+            }
+            sequential_task.step(dt, boundaries);
+            pipelined_task.step(dt, boundaries);
+            ASSERT_TRUE(pipelined_task.is_pressure_pending());
+
+            const auto& completed = pipelined_task.get_completed_layer();
+            ASSERT_EQ(completed.density, previous_layer.density);
+            ASSERT_EQ(completed.viscosity, previous_layer.viscosity);
+            ASSERT_EQ(completed.pressure, previous_layer.pressure);
+            // Реология текущего слоя уже рассчитана
+            ASSERT_EQ(pipelined_task.get_buffer().current().density,
+                sequential_task.get_buffer().current().density);
+            previous_layer = sequential_task.get_buffer().current();
+        }
+
+        pipelined_task.flush_pipeline();
+        ASSERT_FALSE(pipelined_task.is_pressure_pending());
+        ASSERT_EQ(pipelined_task.get_buffer().current().pressure,
+            sequential_task.get_buffer().current().pressure);
+        ASSERT_EQ(pipelined_task.get_buffer().current().viscosity,
+            sequential_task.get_buffer().current().viscosity);
+    };
+    for (bool incremental_pressure : { false, true }) {
+        check_task(isothermal_quasistatic_task_t<advection_moc_solver>(pipe),
+            isothermal_quasistatic_task_t<advection_moc_solver>(pipe), incremental_pressure);
+        check_task(isothermal_quasistatic_task_t<quickest_ultimate_fv_solver>(pipe),
+            isothermal_quasistatic_task_t<quickest_ultimate_fv_solver>(pipe), incremental_pressure);
+    }
+}
+
+/// @brief С разбиением сетки половины конвейерного шага рассчитываются по очереди на пуле разбиения
+/// и дают те же слои, что и последовательный расчет с тем же разбиением
+TEST(PipelinedStep, MatchesSequentialStepsWithDecomposition)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 30e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+
+    thread_pool_t pool(4);
+    domain_decomposition_t decomposition(pool, pipe.profile.getPointCount(), 100);
+
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> sequential_task(pipe);
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> pipelined_task(pipe);
+    sequential_task.set_decomposition(&decomposition);
+    pipelined_task.set_decomposition(&decomposition);
+    pipelined_task.set_pipelined(true);
+
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+    sequential_task.solve(boundaries);
+    pipelined_task.solve(boundaries);
+
+    double v = boundaries.volumetric_flow / pipe.wall.getArea();
+    double dt = sequential_task.get_time_step_assuming_max_speed(v);
+    boundaries.density = 870;
+    boundaries.viscosity = 25e-6;
+    for (size_t step = 0; step < 50; ++step) {
+        sequential_task.step(dt, boundaries);
+        pipelined_task.step(dt, boundaries);
+    }
+    pipelined_task.flush_pipeline();
+    ASSERT_EQ(pipelined_task.get_buffer().current().density,
+        sequential_task.get_buffer().current().density);
+    ASSERT_EQ(pipelined_task.get_buffer().current().pressure,
+        sequential_task.get_buffer().current().pressure);
+}
+
+/// @brief Слой с отложенным давлением не сохраняется в контрольную точку и не выводится
+TEST(PipelinedStep, RequiresFlushBeforeSavingAndPrinting)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 30e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    string path = prepare_test_folder();
+
+    isothermal_quasistatic_task_t<advection_moc_solver> task(pipe);
+    task.set_pipelined(true);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+    task.solve(boundaries);
+    task.step(10, boundaries);
+    checkpoint_image_t image;
+    ASSERT_THROW(task.write_state(&image), std::logic_error);
+    ASSERT_THROW(task.print_all(10, path), std::logic_error);
+    task.set_pipelined(false);
+    ASSERT_FALSE(task.is_pressure_pending());
+    ASSERT_NO_THROW(task.write_state(&image));
+    ASSERT_NO_THROW(task.print_all(10, path));
+}
@@ -0,0 +1,226 @@
+﻿#pragma once
+
+/// @brief Сеть "две трубы сходятся в узле, далее одна труба":
+/// узлы 0 и 1 - источники, 2 - узел смешения, 3 - конечный узел
+template <typename Solver>
+inline isothermal_quasistatic_network_task_t<Solver> create_confluence_network(size_t thread_count)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 12000;
+    simple_pipe.dx = 1000;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+
+    vector<isothermal_network_pipe_t> pipes(3);
+    pipes[0] = { pipe, 0, 2 };
+    pipes[1] = { pipe, 1, 2 };
+    pipes[2] = { pipe, 2, 3 };
+    return isothermal_quasistatic_network_task_t<Solver>(pipes, 4, thread_count);
+}
+
+/// @brief Краевые условия для сети create_confluence_network
+inline isothermal_quasistatic_network_boundaries_t confluence_network_boundaries()
+{
+    isothermal_quasistatic_network_boundaries_t boundaries;
+    boundaries.volumetric_flows = { 0.1, 0.3, 0.4 };
+    boundaries.source_pressures = { 6e6, 6e6, 0, 0 };
+    boundaries.source_densities = { 800, 900, 0, 0 };
+    boundaries.source_viscosities = { 10e-6, 20e-6, 0, 0 };
+    boundaries.pressure_increments = { 0, 0, 1e6, 0 }; // насос в узле смешения
+    return boundaries;
+}
+
+/// @brief В узле смешения плотность и вязкость средневзвешенные по расходу,
+/// давление на входе выходной трубы - с выхода первой входящей трубы плюс напор насоса
+TEST(QuasistaticNetwork, MixesFlowsInJunction)
+{
+    auto network = create_confluence_network<advection_moc_solver>(2);
+    isothermal_quasistatic_network_boundaries_t boundaries = confluence_network_boundaries();
+    network.solve(boundaries);
+
+    ASSERT_NEAR(network.get_node_densities()[2], 875, 1e-9);
+    ASSERT_NEAR(network.get_node_viscosities()[2], 17.5e-6, 1e-15);
+    const auto& outlet_layer = network.get_pipe_task(2).get_buffer().current();
+    ASSERT_NEAR(outlet_layer.density.back(), 875, 1e-9);
+
+    double first_pipe_outlet_pressure = network.get_pipe_task(0).get_buffer().current().pressure.back();
+    ASSERT_NEAR(network.get_node_pressures()[2], first_pipe_outlet_pressure + 1e6, 1e-6);
+    ASSERT_NEAR(outlet_layer.pressure.front(), first_pipe_outlet_pressure + 1e6, 1e-6);
+    ASSERT_NEAR(network.get_node_pressures()[3], outlet_layer.pressure.back(), 1e-6);
+
+    // Партия из источника 0 доходит до выхода сети, смешиваясь в узле 2
+    boundaries.source_densities[0] = 840;
+    double dt = network.get_time_step_assuming_max_speed(boundaries.volumetric_flows);
+    for (size_t step = 0; step < 300; ++step) {
+        network.step(dt, boundaries);
+    }
+    ASSERT_NEAR(network.get_node_densities()[2], 885, 1e-6);
+    ASSERT_NEAR(network.get_pipe_task(2).get_buffer().current().density.back(), 885, 1e-6);
+}
+
+/// @brief При нулевом расходе во всех входящих трубах узел получает среднее значений на их выходе,
+/// а не остается с нулевыми плотностью и вязкостью
+TEST(QuasistaticNetwork, JunctionWithoutFlowTakesMeanOfInlets)
+{
+    auto network = create_confluence_network<advection_moc_solver>(1);
+    isothermal_quasistatic_network_boundaries_t boundaries = confluence_network_boundaries();
+    boundaries.volumetric_flows = { 0, 0, 0 };
+    network.solve(boundaries);
+
+    ASSERT_NEAR(network.get_node_densities()[2], 850, 1e-9);
+    ASSERT_NEAR(network.get_node_viscosities()[2], 15e-6, 1e-15);
+    ASSERT_NEAR(network.get_pipe_task(2).get_buffer().current().density.front(), 850, 1e-9);
+}
+
+/// @brief Расхождение давлений на выходе входящих труб узла смешения доступно пользователю
+TEST(QuasistaticNetwork, ExposesJunctionPressureMismatch)
+{
+    auto network = create_confluence_network<advection_moc_solver>(1);
+    isothermal_quasistatic_network_boundaries_t boundaries = confluence_network_boundaries();
+    network.solve(boundaries);
+
+    double first_outlet = network.get_pipe_task(0).get_buffer().current().pressure.back();
+    double second_outlet = network.get_pipe_task(1).get_buffer().current().pressure.back();
+    const vector<double>& mismatches = network.get_node_pressure_mismatches();
+    ASSERT_GT(mismatches[2], 0);
+    ASSERT_NEAR(mismatches[2], std::abs(second_outlet - first_outlet), 1e-6);
+    ASSERT_EQ(mismatches[0], 0);
+    ASSERT_EQ(mismatches[3], 0);
+}
+
+/// @brief Результат параллельного расчета совпадает с последовательным побитово
+TEST(QuasistaticNetwork, ParallelStepMatchesSerial)
+{
+    auto serial = create_confluence_network<quickest_ultimate_fv_solver>(1);
+    auto parallel = create_confluence_network<quickest_ultimate_fv_solver>(3);
+    isothermal_quasistatic_network_boundaries_t boundaries = confluence_network_boundaries();
+    serial.solve(boundaries);
+    parallel.solve(boundaries);
+
+    double dt = serial.get_time_step_assuming_max_speed(boundaries.volumetric_flows);
+    for (size_t step = 0; step < 50; ++step) {
+        boundaries.source_densities[step % 2] += 1;
+        serial.step(dt, boundaries);
+        parallel.step(dt, boundaries);
+    }
+    for (size_t pipe = 0; pipe < serial.get_pipe_count(); ++pipe) {
+        const auto& serial_layer = serial.get_pipe_task(pipe).get_buffer().current();
+        const auto& parallel_layer = parallel.get_pipe_task(pipe).get_buffer().current();
+        ASSERT_EQ(serial_layer.density, parallel_layer.density);
+        ASSERT_EQ(serial_layer.pressure, parallel_layer.pressure);
+    }
+    ASSERT_EQ(serial.get_node_pressures(), parallel.get_node_pressures());
+}
+
+/// @brief Отрицательный расход (течение против направления трубы) отклоняется:
+/// смешение в узлах и порядок гидравлического расчета построены по направлению труб
+TEST(QuasistaticNetwork, RejectsReversedFlow)
+{
+    auto network = create_confluence_network<advection_moc_solver>(1);
+    isothermal_quasistatic_network_boundaries_t boundaries = confluence_network_boundaries();
+    isothermal_quasistatic_network_boundaries_t reversed = boundaries;
+    reversed.volumetric_flows[1] = -0.3;
+    ASSERT_THROW(network.solve(reversed), std::logic_error);
+
+    network.solve(boundaries);
+    double dt = network.get_time_step_assuming_max_speed(boundaries.volumetric_flows);
+    ASSERT_THROW(network.step(dt, reversed), std::logic_error);
+    ASSERT_THROW(network.step_local(dt, reversed), std::logic_error);
+}
+
+/// @brief Смешение и давление в узлах только читают слои труб: слой, разделяемый
+/// с ответвлением задачи трубы, не копируется
+TEST(QuasistaticNetwork, JunctionPhaseDoesNotCopySharedLayers)
+{
+    auto network = create_confluence_network<advection_moc_solver>(1);
+    isothermal_quasistatic_network_boundaries_t boundaries = confluence_network_boundaries();
+    network.solve(boundaries);
+
+    auto scenario = network.get_pipe_task(0).fork();
+    ASSERT_TRUE(network.get_pipe_task(0).get_buffer().is_shared(0));
+    double dt = network.get_time_step_assuming_max_speed(boundaries.volumetric_flows);
+    network.step(dt, boundaries);
+    // Бывший текущий слой трубы только читался (смешение в узле 2, шаг партий) и остался общим
+    ASSERT_TRUE(network.get_pipe_task(0).get_buffer().is_shared(-1));
+    ASSERT_FALSE(network.get_pipe_task(0).get_buffer().is_shared(0));
+}
+
+/// @brief Магистраль из последовательных труб (по одной трубе на уровень): профили давления,
+/// рассчитанные параллельно от нулевого давления и сдвинутые на давление в узлах, совпадают
+/// с расчетом методом Эйлера от давления в начальном узле трубы
+TEST(QuasistaticNetwork, TrunkLinePressureMatchesEuler)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 12000;
+    simple_pipe.dx = 1000;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    constexpr size_t pipe_count = 4;
+    vector<isothermal_network_pipe_t> pipes;
+    for (size_t index = 0; index < pipe_count; ++index) {
+        pipes.push_back({ pipe, index, index + 1 });
+    }
+    isothermal_quasistatic_network_task_t<advection_moc_solver> network(pipes, pipe_count + 1, 3);
+
+    isothermal_quasistatic_network_boundaries_t boundaries;
+    boundaries.volumetric_flows.assign(pipe_count, 0.3);
+    boundaries.source_pressures.assign(pipe_count + 1, 0);
+    boundaries.source_pressures[0] = 6e6;
+    boundaries.source_densities.assign(pipe_count + 1, 850);
+    boundaries.source_viscosities.assign(pipe_count + 1, 15e-6);
+    boundaries.pressure_increments.assign(pipe_count + 1, 0);
+    boundaries.pressure_increments[2] = 2e6; // насос в середине магистрали
+    network.solve(boundaries);
+
+    boundaries.source_densities[0] = 870;
+    boundaries.source_viscosities[0] = 25e-6;
+    double dt = network.get_time_step_assuming_max_speed(boundaries.volumetric_flows);
+    for (size_t step = 0; step < 30; ++step) {
+        network.step(dt, boundaries);
+    }
+
+    const vector<double>& node_pressures = network.get_node_pressures();
+    for (size_t index = 0; index < pipe_count; ++index) {
+        auto& pipe_task = network.get_pipe_task(index);
+        const auto& layer = std::as_const(pipe_task).get_buffer().current();
+        isothermal_pipe_PQ_parties_t<double> model(pipe_task.get_pipe(), layer.density, layer.viscosity,
+            boundaries.volumetric_flows[index], +1);
+        vector<double> expected(layer.pressure.size());
+        solve_euler<1>(model, +1, node_pressures[index], &expected);
+        for (size_t point = 0; point < expected.size(); ++point) {
+            ASSERT_NEAR(layer.pressure[point], expected[point], 1e-6);
+            ASSERT_NEAR(layer.pressure_delta[point],
+                pipe_task.get_pressure_initial()[point] - expected[point], 1e-6);
+        }
+        ASSERT_NEAR(node_pressures[index + 1],
+            layer.pressure.back() + boundaries.pressure_increments[index + 1], 1e-6);
+    }
+}
+
+/// @brief Сеть с циклом не поддерживается
+TEST(QuasistaticNetwork, RejectsCycles)
+{
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe_properties());
+    vector<isothermal_network_pipe_t> pipes{ { pipe, 0, 1 }, { pipe, 1, 2 }, { pipe, 2, 1 } };
+    ASSERT_THROW(isothermal_quasistatic_network_task_t<advection_moc_solver>(pipes, 3, 1), std::logic_error);
+}
+
+/// @brief Локальный шаг по времени: быстрые трубы делают больше подшагов (степень двойки),
+/// медленные - меньше; установившееся смешение то же, что при общем шаге
+TEST(QuasistaticNetwork, LocalTimeStepping)
+{
+    auto network = create_confluence_network<quickest_ultimate_fv_solver>(2);
+    isothermal_quasistatic_network_boundaries_t boundaries = confluence_network_boundaries();
+    network.solve(boundaries);
+
+    // Трубы одинаковые, скорости пропорциональны расходам 0.1, 0.3, 0.4
+    double dt = network.get_local_time_step(boundaries.volumetric_flows);
+    ASSERT_NEAR(dt, 4 * network.get_time_step_assuming_max_speed(boundaries.volumetric_flows), 1e-9);
+    vector<size_t> substep_counts = network.get_local_substep_counts(dt, boundaries.volumetric_flows);
+    ASSERT_EQ(substep_counts, vector<size_t>({ 1, 4, 4 })); // 9 шагов труб вместо 12 при общем шаге
+
+    boundaries.source_densities[0] = 840;
+    for (size_t step = 0; step < 100; ++step) {
+        network.step_local(dt, boundaries);
+    }
+    ASSERT_NEAR(network.get_node_densities()[2], 885, 1e-6);
+    ASSERT_NEAR(network.get_pipe_task(2).get_buffer().current().density.back(), 885, 1e-6);
+}
@@ -0,0 +1,164 @@
+﻿#pragma once
+
+/// @brief Временные ряды краевых условий квазистационарной задачи: скачок плотности и вязкости
+/// в середине периода, расход и давление на входе постоянны
+inline vector_timeseries_t create_simulation_boundary_timeseries(time_t duration)
+{
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+    time_t start = 1712583773;
+    vector<time_t> constant_times{ start, start + duration };
+    vector<time_t> jump_times{ start, start + duration / 2, start + duration / 2 + 1, start + duration };
+    return vector_timeseries_t({
+        { constant_times, { boundaries.volumetric_flow, boundaries.volumetric_flow } },
+        { constant_times, { boundaries.pressure_in, boundaries.pressure_in } },
+        { jump_times, { 850, 850, 870, 870 } },
+        { jump_times, { 15e-6, 15e-6, 25e-6, 25e-6 } },
+    });
+}
+
+/// @brief Ленивое моделирование выдает те же моменты времени и слои, что и цикл шагов задачи,
+/// и не рассчитывает шаги, которые не запрошены
+TEST(QuasistaticSimulation, YieldsSameLayersAsStepLoop)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 20e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    vector_timeseries_t timeseries = create_simulation_boundary_timeseries(20000);
+    isothermal_quasistatic_task_boundaries_t initial_boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+    double dt = 60;
+
+    // Эталон - явный цикл шагов
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> reference_task(pipe);
+    reference_task.solve(initial_boundaries);
+    vector<time_t> reference_times{ timeseries.get_start_date() };
+    vector<vector<double>> reference_pressures{ reference_task.get_buffer().current().pressure };
+    vector_timeseries_cursor_t cursor(timeseries);
+    vector<double> values;
+    time_t t = timeseries.get_start_date();
+    do {
+        cursor.interpolate(t, &values);
+        isothermal_quasistatic_task_boundaries_t boundaries(values);
+        t += static_cast<time_t>(dt);
+        reference_task.step(dt, boundaries);
+        reference_times.push_back(t);
+        reference_pressures.push_back(reference_task.get_buffer().current().pressure);
+    } while (t < timeseries.get_end_date());
+
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> task(pipe);
+    task.solve(initial_boundaries);
+    size_t step = 0;
+    for (const auto& [time, layer] : quasistatic_simulation_t(task, timeseries, dt)) {
+        ASSERT_LT(step, reference_times.size());
+        ASSERT_EQ(time, reference_times[step]);
+        ASSERT_EQ(layer.pressure, reference_pressures[step]);
+        step++;
+    }
+    ASSERT_EQ(step, reference_times.size());
+
+    // Остановка на шаге 10: следующий шаг не рассчитывается
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> stopped_task(pipe);
+    stopped_task.solve(initial_boundaries);
+    quasistatic_simulation_t simulation(stopped_task, timeseries, dt);
+    for (const auto& [time, layer] : simulation) {
+        if (time >= reference_times[10]) {
+            break;
+        }
+    }
+    ASSERT_EQ(simulation.get_time(), reference_times[10]);
+    ASSERT_EQ(stopped_task.get_buffer().current().pressure, reference_pressures[10]);
+    ASSERT_FALSE(simulation.is_finished());
+}
+
+/// @brief Моделирования с разными солверами продвигаются совместно без хранения слоев;
+/// по завершении next() не выполняет шагов
+TEST(QuasistaticSimulation, ZipsSimulationsInLockstep)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 20e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    vector_timeseries_t timeseries = create_simulation_boundary_timeseries(20000);
+    isothermal_quasistatic_task_boundaries_t initial_boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+
+    isothermal_quasistatic_task_t<advection_moc_solver> moc_task(pipe);
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> quickest_task(pipe);
+    moc_task.solve(initial_boundaries);
+    quickest_task.solve(initial_boundaries);
+    // Шаг для Cr = 1 по расходу одинаков в обеих задачах
+    quasistatic_simulation_t moc_simulation(moc_task, timeseries);
+    quasistatic_simulation_t quickest_simulation(quickest_task, timeseries);
+
+    size_t step_count = 0;
+    double max_pressure_difference = 0;
+    do {
+        ASSERT_EQ(moc_simulation.get_time(), quickest_simulation.get_time());
+        const auto& moc_pressure = moc_simulation.get_layer().pressure;
+        const auto& quickest_pressure = quickest_simulation.get_layer().pressure;
+        for (size_t index = 0; index < moc_pressure.size(); ++index) {
+            max_pressure_difference = std::max(max_pressure_difference,
+                std::abs(moc_pressure[index] - quickest_pressure[index]));
+        }
+        step_count++;
+    } while (moc_simulation.next() & quickest_simulation.next()); // без сокращенного вычисления: шаг в обеих
+
+    ASSERT_TRUE(moc_simulation.is_finished());
+    ASSERT_TRUE(quickest_simulation.is_finished());
+    ASSERT_GT(step_count, 2);
+    // Методы различаются только размытием фронта партии
+    ASSERT_LT(max_pressure_difference, 1e5);
+
+    time_t end_time = moc_simulation.get_time();
+    ASSERT_FALSE(moc_simulation.next());
+    ASSERT_EQ(moc_simulation.get_time(), end_time);
+    auto it = moc_simulation.begin();
+    ++it;
+    ASSERT_TRUE(it == moc_simulation.end());
+}
+
+/// @brief При выборе шага по событиям краевых условий шаги не больше шага для Cr = 1,
+/// попадают точно на скачок плотности и вязкости и на конец периода
+TEST(QuasistaticSimulation, AlignedStepsLandOnBoundaryJumps)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 20e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    time_t duration = 20001;
+    vector_timeseries_t timeseries = create_simulation_boundary_timeseries(duration);
+    isothermal_quasistatic_task_boundaries_t initial_boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+
+    isothermal_quasistatic_task_t<advection_moc_solver> task(pipe);
+    task.solve(initial_boundaries);
+    double v = initial_boundaries.volumetric_flow / pipe.wall.getArea();
+    double courant_step = task.get_time_step_assuming_max_speed(v);
+
+    quasistatic_simulation_t simulation(task, timeseries);
+    simulation.align_steps_to_boundaries();
+    time_t jump_time = timeseries.get_start_date() + duration / 2;
+    vector<time_t> times;
+    for (const auto& [time, layer] : simulation) {
+        if (!times.empty()) {
+            ASSERT_LE(static_cast<double>(time - times.back()), courant_step);
+        }
+        // Шаг, начатый в момент скачка (jump_time + 1), уже рассчитывается по новой плотности
+        bool after_jump = !times.empty() && times.back() > jump_time;
+        ASSERT_NEAR(layer.density.front(), after_jump ? 870 : 850, 1e-9);
+        times.push_back(time);
+    }
+    ASSERT_NE(std::find(times.begin(), times.end(), jump_time), times.end());
+    ASSERT_NE(std::find(times.begin(), times.end(), jump_time + 1), times.end());
+    ASSERT_EQ(times.back(), timeseries.get_end_date());
+
+    // Шаг меньше секунды не округляется вверх (Cr > 1), а отклоняется
+    isothermal_quasistatic_task_t<advection_moc_solver> fine_task(pipe);
+    fine_task.solve(initial_boundaries);
+    quasistatic_simulation_t fine_simulation(fine_task, timeseries, 0.5);
+    fine_simulation.align_steps_to_boundaries();
+    ASSERT_THROW(fine_simulation.next(), std::logic_error);
+    ASSERT_EQ(fine_simulation.get_time(), timeseries.get_start_date());
+}
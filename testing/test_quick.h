@@ -504,3 +504,92 @@ TEST_F(QUICKEST_ULTIMATE, CanConsiderFlowSwap) {
     ASSERT_GT(rho_curr.back(), rho_prev.back()); // плотность в конце выросла
     ASSERT_NEAR(rho_curr.front(), rho_prev.front(), 1e-8); // плотность в начале не изменилась
 }
+
+/// @brief Расчет плотности на заданном буфере слоев (ring_buffer_t или fixed_ring_buffer_t)
+/// @return Профили плотности после каждого шага
+template <typename Solver, typename Buffer>
+inline vector<vector<double>> calc_density_on_buffer(PipeQAdvection& advection_model, Buffer& buffer,
+    size_t step_count, double dt)
+{
+    auto& initial = buffer.previous().vars.cell_double[0];
+    std::fill(initial.begin(), initial.end(), 850.0);
+
+    vector<vector<double>> result;
+    for (size_t index = 0; index < step_count; ++index) {
+        double rho_in = index % 10 < 5 ? 860 : 870;
+        Solver solver(advection_model, buffer);
+        solver.step(dt, rho_in, 870);
+
+        const auto& rho = buffer.current().vars.cell_double[0];
+        result.emplace_back(rho.begin(), rho.end());
+        buffer.advance(+1);
+    }
+    return result;
+}
+
+/// @brief Сравнивает расчет солвера на слоях std::vector и на слоях фиксированного размера
+template <typename VectorSolver, typename FixedSolver, size_t PointCount>
+inline void check_fixed_layer_solver(PipeQAdvection& advection_model, double dt)
+{
+    typedef composite_layer_t<typename VectorSolver::var_layer_data,
+        typename VectorSolver::specific_layer> layer_t;
+    typedef composite_layer_t<typename FixedSolver::var_layer_data,
+        typename FixedSolver::specific_layer> fixed_layer_t;
+
+    ring_buffer_t<layer_t> buffer(2, PointCount);
+    fixed_ring_buffer_t<fixed_layer_t, 2> fixed_buffer(PointCount);
+
+    vector<vector<double>> expected = calc_density_on_buffer<VectorSolver>(advection_model, buffer, 50, dt);
+    vector<vector<double>> actual = calc_density_on_buffer<FixedSolver>(advection_model, fixed_buffer, 50, dt);
+    ASSERT_EQ(expected, actual);
+}
+
+/// @brief Солверы МКО на слоях фиксированного размера дают побитово тот же результат,
+/// что и на слоях std::vector
+TEST(FixedLayer, FiniteVolumeSolversMatchVectorLayers)
+{
+    constexpr size_t point_count = 32;
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 3100;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    ASSERT_EQ(pipe.profile.getPointCount(), point_count);
+
+    vector<double> Q(point_count, 0.5);
+    PipeQAdvection advection_model(pipe, Q);
+    const auto& x = advection_model.get_grid();
+    double dt = 0.5 * (x[1] - x[0]) / advection_model.getEquationsCoeffs(0, 0);
+
+    check_fixed_layer_solver<upstream_fv_solver, fixed_upstream_fv_solver<point_count>, point_count>(
+        advection_model, dt);
+    check_fixed_layer_solver<quick_fv_solver, fixed_quick_fv_solver<point_count>, point_count>(
+        advection_model, dt);
+    check_fixed_layer_solver<quickest_fv_solver, fixed_quickest_fv_solver<point_count>, point_count>(
+        advection_model, dt);
+    check_fixed_layer_solver<quickest_ultimate_fv_solver, fixed_quickest_ultimate_fv_solver<point_count>, point_count>(
+        advection_model, dt);
+}
+
+/// @brief Слой фиксированного размера не создается для сетки другого размера
+TEST(FixedLayer, RejectsWrongPointCount)
+{
+    typedef fixed_fv_solver_traits<8>::var_layer_data fixed_layer_t;
+    ASSERT_NO_THROW(fixed_layer_t(8));
+    ASSERT_THROW(fixed_layer_t(9), std::runtime_error);
+
+    fixed_ring_buffer_t<fixed_layer_t, 2> buffer(8);
+    buffer.current().cell_double[0].fill(1.0);
+    buffer.advance(+1);
+    ASSERT_EQ(buffer.previous().cell_double[0].size(), 7);
+    ASSERT_EQ(buffer.previous().cell_double[0][0], 1.0);
+    ASSERT_EQ(buffer.current().cell_double[0][0], 0.0);
+}
+
+/// @brief Число Куранта меньше единицы не обнуляется в аппроксимации QUICKEST на границе ячейки
+/// (модуль берется для double, а не для целого числа), в том числе при обратном течении
+TEST(QuickestBorderApproximation, KeepsFractionalCourant)
+{
+    // Cr = 0.5: Ub = 2 - 0.5 - 0.125
+    ASSERT_NEAR(quickest_border_approximation(0, 1, 3, 0, 1, 0.5, +1), 1.375, 1e-12);
+    ASSERT_NEAR(quickest_border_approximation(0, 1, 3, 0, 1, 0.5, -1), 1.375, 1e-12);
+}
@@ -0,0 +1,158 @@
+﻿#pragma once
+
+/// @brief Копия буфера разделяет слои с исходным до первой записи; запись копирует только свой слой
+TEST(CowRingBuffer, SharesLayersUntilWrite)
+{
+    typedef profile_collection_t<1> layer_type;
+    cow_ring_buffer_t<layer_type> buffer(2, 10);
+    buffer.current().point_double[0][3] = 1;
+    buffer.previous().point_double[0][3] = 2;
+    ASSERT_FALSE(buffer.is_shared(0));
+
+    cow_ring_buffer_t<layer_type> fork = buffer;
+    ASSERT_TRUE(fork.is_shared(0));
+    ASSERT_TRUE(fork.is_shared(-1));
+    const auto& const_fork = fork;
+    ASSERT_EQ(const_fork.current().point_double[0][3], 1);
+    ASSERT_EQ(&const_fork.current(), &std::as_const(buffer).current()); // константный доступ не копирует
+    ASSERT_TRUE(fork.is_shared(0));
+
+    fork.advance(+1);
+    fork.current().point_double[0][3] = 3;
+    ASSERT_FALSE(fork.is_shared(0));
+    ASSERT_TRUE(fork.is_shared(-1)); // непрочитанный на запись слой остается общим
+    ASSERT_FALSE(buffer.is_shared(-1));
+    ASSERT_TRUE(buffer.is_shared(0));
+
+    ASSERT_EQ(buffer.current().point_double[0][3], 1);
+    ASSERT_EQ(buffer.previous().point_double[0][3], 2);
+    ASSERT_EQ(fork.current().point_double[0][3], 3);
+    ASSERT_EQ(fork.previous().point_double[0][3], 1);
+}
+
+/// @brief Слой для перезаписи не копирует разделяемый слой, а создает новый по аргументам конструктора;
+/// неразделяемый слой перезаписывается на месте
+TEST(CowRingBuffer, OverwriteReplacesSharedLayerWithoutCopy)
+{
+    typedef profile_collection_t<1> layer_type;
+    cow_ring_buffer_t<layer_type> buffer(2, 10);
+    buffer.current().point_double[0][3] = 1;
+    layer_type* own_layer = &buffer.overwrite_current(10);
+    ASSERT_EQ(own_layer, &buffer.current());
+    ASSERT_EQ(own_layer->point_double[0][3], 1);
+
+    cow_ring_buffer_t<layer_type> fork = buffer;
+    layer_type& fresh = fork.overwrite_current(10);
+    ASSERT_FALSE(fork.is_shared(0));
+    ASSERT_FALSE(buffer.is_shared(0));
+    ASSERT_EQ(fresh.point_double[0].size(), 10);
+    ASSERT_EQ(fresh.point_double[0][3], 0); // содержимое не копировалось
+    ASSERT_EQ(std::as_const(buffer).current().point_double[0][3], 1);
+    ASSERT_TRUE(fork.is_shared(-1));
+}
+
+/// @brief Ответвление сценария продолжает расчет так же, как исходная задача, не влияя на нее;
+/// сразу после ответвления слои, труба и начальное давление разделяются, рабочие буферы не копируются
+TEST(ScenarioFork, ForkedTaskMatchesParentAndDoesNotAffectIt)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 30e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+
+    auto check_task = [&](auto parent) {
+        parent.solve(boundaries);
+        double dt = parent.get_time_step_assuming_max_speed(boundaries.volumetric_flow / pipe.wall.getArea());
+        isothermal_quasistatic_task_boundaries_t batch_boundaries = boundaries;
+        batch_boundaries.density = 870;
+        batch_boundaries.viscosity = 25e-6;
+        for (size_t step = 0; step < 30; ++step) {
+            parent.step(dt, batch_boundaries);
+        }
+        vector<double> parent_pressure = parent.get_buffer().current().pressure;
+
+        auto same_scenario = parent.fork();
+        auto other_scenario = parent.fork();
+        task_memory_usage_t usage = same_scenario.get_memory_usage();
+        ASSERT_EQ(usage.shared, usage.layers + usage.invariant);
+        ASSERT_EQ(usage.scratch, sizeof(double)); // буфер потоков еще не выделен
+
+        isothermal_quasistatic_task_boundaries_t other_boundaries = batch_boundaries;
+        other_boundaries.volumetric_flow *= 0.8;
+        other_boundaries.density = 830;
+        for (size_t step = 0; step < 20; ++step) {
+            other_scenario.step(dt, other_boundaries);
+        }
+        ASSERT_EQ(std::as_const(parent).get_buffer().current().pressure, parent_pressure);
+        ASSERT_EQ(other_scenario.get_memory_usage().shared, usage.invariant);
+
+        for (size_t step = 0; step < 20; ++step) {
+            parent.step(dt, batch_boundaries);
+            same_scenario.step(dt, batch_boundaries);
+        }
+        ASSERT_EQ(same_scenario.get_buffer().current().density, parent.get_buffer().current().density);
+        ASSERT_EQ(same_scenario.get_buffer().current().pressure, parent.get_buffer().current().pressure);
+        ASSERT_EQ(same_scenario.get_pressure_initial(), parent.get_pressure_initial());
+        ASSERT_NE(other_scenario.get_buffer().current().pressure, parent.get_buffer().current().pressure);
+    };
+    check_task(isothermal_quasistatic_task_t<advection_moc_solver>(pipe));
+    check_task(isothermal_quasistatic_task_t<quickest_ultimate_fv_solver>(pipe));
+}
+
+
+/// @brief Ответвления, разделяющие слои, рассчитываются в разных потоках так же, как последовательно
+/// и как задача без ответвления (перезаписываемые слои создаются заново, а не копируются)
+TEST(ScenarioFork, ForksStepInParallelThreads)
+{
+    typedef isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> task_type;
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 30e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+
+    task_type parent(pipe);
+    parent.solve(boundaries);
+    double dt = parent.get_time_step_assuming_max_speed(boundaries.volumetric_flow / pipe.wall.getArea());
+    auto scenario_boundaries = [&](size_t scenario) {
+        isothermal_quasistatic_task_boundaries_t result = boundaries;
+        result.density = 830 + 10.0 * scenario;
+        result.volumetric_flow *= 1 - 0.05 * scenario;
+        return result;
+    };
+    auto run = [&](task_type& task, size_t scenario) {
+        task.set_pipelined(scenario % 2 == 1);
+        for (size_t step = 0; step < 40; ++step) {
+            task.step(dt, scenario_boundaries(scenario));
+        }
+        task.flush_pipeline();
+    };
+
+    constexpr size_t scenario_count = 4;
+    vector<task_type> forks;
+    for (size_t scenario = 0; scenario < scenario_count; ++scenario) {
+        forks.push_back(parent.fork());
+    }
+    vector<std::thread> threads;
+    for (size_t scenario = 0; scenario < scenario_count; ++scenario) {
+        threads.emplace_back([&, scenario]() { run(forks[scenario], scenario); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t scenario = 0; scenario < scenario_count; ++scenario) {
+        task_type independent(pipe);
+        independent.solve(boundaries);
+        run(independent, scenario);
+        const auto& expected = std::as_const(independent).get_buffer().current();
+        const auto& actual = std::as_const(forks[scenario]).get_buffer().current();
+        ASSERT_EQ(actual.density, expected.density);
+        ASSERT_EQ(actual.viscosity, expected.viscosity);
+        ASSERT_EQ(actual.pressure, expected.pressure);
+        ASSERT_EQ(actual.pressure_delta, expected.pressure_delta);
+    }
+}
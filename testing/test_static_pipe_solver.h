@@ -26,3 +26,74 @@ TEST(Static_Hydraulic_Solver, UseCase)
 
 
 }
+
+/// @brief Профиль давления накопленной суммой: последовательно побитово совпадает с solve_euler,
+/// параллельно - с точностью до порядка суммирования; для партий в точках и в ячейках, в обоих направлениях
+TEST(Static_Hydraulic_Solver, StateIndependentEulerMatchesSolveEuler)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 100e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    size_t n = pipe.profile.getPointCount();
+    for (size_t index = 0; index < n; ++index) {
+        pipe.profile.heights[index] = 50 * sin(1e-4 * pipe.profile.coordinates[index]);
+    }
+
+    thread_pool_t pool(4);
+    domain_decomposition_t decomposition(pool, n, 100);
+
+    for (size_t rheology_size : { n, n - 1 }) {
+        vector<double> density(rheology_size);
+        vector<double> viscosity(rheology_size);
+        for (size_t index = 0; index < rheology_size; ++index) {
+            density[index] = index < rheology_size / 3 ? 860 : 840;
+            viscosity[index] = index < rheology_size / 3 ? 20e-6 : 10e-6;
+        }
+        for (int direction : { +1, -1 }) {
+            double initial_pressure = direction > 0 ? 6e6 : 1e6;
+            isothermal_pipe_PQ_parties_t<double> model(pipe, density, viscosity, 0.5, direction);
+            ASSERT_TRUE(model.is_state_independent());
+
+            vector<double> expected(n);
+            solve_euler<1>(model, direction, initial_pressure, &expected);
+
+            vector<double> serial(n);
+            solve_euler_state_independent<1>(model, direction, initial_pressure, &serial);
+            ASSERT_EQ(serial, expected);
+
+            vector<double> parallel(n);
+            solve_euler_state_independent<1>(model, direction, initial_pressure, &parallel, &decomposition);
+            for (size_t index = 0; index < n; ++index) {
+                ASSERT_NEAR(parallel[index], expected[index], 1e-9 * initial_pressure);
+            }
+        }
+    }
+
+    // Уравнение, правая часть которого зависит от решения, отклоняется
+    oil_parameters_t oil;
+    PipeModelPGConstArea state_dependent_model(pipe, oil);
+    vector<array<double, 2>> result(n);
+    ASSERT_THROW(solve_euler_state_independent<2>(state_dependent_model, -1, { 1e6, 0 }, &result),
+        std::logic_error);
+}
+
+/// @brief Трение при скорости меньше 1 м/с не обнуляется (модуль скорости берется для double)
+/// и направлено против течения
+TEST(Static_Hydraulic_Solver, FrictionGradientForSlowFlow)
+{
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe_properties());
+    size_t n = pipe.profile.getPointCount();
+    vector<double> density(n - 1, 850);
+    vector<double> viscosity(n - 1, 15e-6);
+    double area = pipe.wall.getArea();
+
+    for (double v : { 0.5, -0.5 }) {
+        isothermal_pipe_PQ_parties_t<double> model(pipe, density, viscosity, v * area, +1);
+        double Re = v * pipe.wall.diameter / 15e-6;
+        double lambda = pipe.resistance_function(Re, pipe.wall.relativeRoughness());
+        double expected = -4 * (lambda / 8 * 850 * v * std::abs(v)) / pipe.wall.diameter;
+        ASSERT_NE(expected, 0);
+        ASSERT_NEAR(model.ode_right_party(n / 2, 0.0), expected, 1e-9 * std::abs(expected));
+    }
+}
@@ -0,0 +1,101 @@
+﻿#pragma once
+
+/// @brief При неизменных краевых условиях и трубе, заполненной одной партией, шаги пропускаются,
+/// после смены партии рассчитываются до заполнения трубы новой партией, затем снова пропускаются;
+/// слои совпадают с расчетом без пропуска
+TEST(SteadyState, SkipsStepsWhenPipeIsFilledWithOneBatch)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 10e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    size_t n = pipe.profile.getPointCount();
+
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+    isothermal_quasistatic_task_t<advection_moc_solver> reference_task(pipe);
+    isothermal_quasistatic_task_t<advection_moc_solver> task(pipe);
+    task.set_steady_state_skipping(true);
+    reference_task.solve(boundaries);
+    task.solve(boundaries);
+
+    double v = boundaries.volumetric_flow / pipe.wall.getArea();
+    double dt = task.get_time_step_assuming_max_speed(v);
+    auto check_layers = [&]() {
+        const auto& layer = task.get_buffer().current();
+        const auto& reference_layer = reference_task.get_buffer().current();
+        for (size_t index = 0; index < n; ++index) {
+            ASSERT_NEAR(layer.density[index], reference_layer.density[index], 1e-9);
+            ASSERT_NEAR(layer.pressure[index], reference_layer.pressure[index], 1e-3);
+            ASSERT_NEAR(layer.pressure_delta[index], reference_layer.pressure_delta[index], 1e-3);
+        }
+    };
+
+    // Сразу после начального расчета труба заполнена одной партией
+    for (size_t step = 0; step < 50; ++step) {
+        reference_task.step(dt, boundaries);
+        task.step(dt, boundaries);
+        check_layers();
+    }
+    ASSERT_EQ(task.get_step_stats().computed_steps, 0);
+    ASSERT_EQ(task.get_step_stats().skipped_steps, 50);
+    ASSERT_NEAR(task.get_step_stats().skipped_time, 50 * dt, 1e-9);
+
+    // Новая партия: шаги рассчитываются, пока она не заполнит трубу (Cr = 1 - за n - 1 шаг)
+    task.reset_step_stats();
+    boundaries.density = 870;
+    boundaries.viscosity = 25e-6;
+    for (size_t step = 0; step < 2 * n; ++step) {
+        reference_task.step(dt, boundaries);
+        task.step(dt, boundaries);
+        check_layers();
+    }
+    ASSERT_EQ(task.get_step_stats().computed_steps, n);
+    ASSERT_EQ(task.get_step_stats().skipped_steps, n);
+
+    // Изменение давления на входе в пределах допуска не прерывает пропуск, за пределами - прерывает
+    task.reset_step_stats();
+    boundaries.pressure_in *= 1 + 1e-12;
+    task.step(dt, boundaries);
+    ASSERT_EQ(task.get_step_stats().skipped_steps, 1);
+    boundaries.pressure_in += 1e5;
+    reference_task.step(dt, boundaries);
+    task.step(dt, boundaries);
+    ASSERT_EQ(task.get_step_stats().computed_steps, 1);
+    check_layers();
+}
+
+/// @brief Пропуск шагов выключен по умолчанию; в конвейерном режиме при пропуске
+/// досчитывается отложенное давление
+TEST(SteadyState, DisabledByDefaultAndFlushesPipeline)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 10e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+    isothermal_quasistatic_task_boundaries_t boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> task(pipe);
+    task.solve(boundaries);
+    for (size_t step = 0; step < 5; ++step) {
+        task.step(10, boundaries);
+    }
+    ASSERT_EQ(task.get_step_stats().computed_steps, 5);
+    ASSERT_EQ(task.get_step_stats().skipped_steps, 0);
+
+    isothermal_quasistatic_task_t<quickest_ultimate_fv_solver> reference_task = task.fork();
+    task.set_steady_state_skipping(true);
+    task.set_pipelined(true);
+    // Давление на входе меняется: шаг рассчитывается, давление откладывается
+    boundaries.pressure_in += 1e5;
+    task.step(10, boundaries);
+    reference_task.step(10, boundaries);
+    ASSERT_TRUE(task.is_pressure_pending());
+    // Следующий шаг пропускается, отложенное давление досчитывается
+    task.step(10, boundaries);
+    ASSERT_FALSE(task.is_pressure_pending());
+    ASSERT_EQ(task.get_step_stats().computed_steps, 6);
+    ASSERT_EQ(task.get_step_stats().skipped_steps, 1);
+    ASSERT_EQ(task.get_buffer().current().pressure, reference_task.get_buffer().current().pressure);
+}
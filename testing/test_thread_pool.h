@@ -0,0 +1,35 @@
+﻿#pragma once
+
+/// @brief Каждый индекс обрабатывается ровно один раз
+TEST(ThreadPool, ProcessesEveryIndexOnce)
+{
+    thread_pool_t pool(4);
+    ASSERT_EQ(pool.get_thread_count(), 4);
+
+    for (size_t count : { 0, 1, 7, 1000 }) {
+        vector<std::atomic<int>> visits(count);
+        pool.parallel_for(count, [&](size_t index) {
+            visits[index]++;
+        });
+        for (size_t index = 0; index < count; ++index) {
+            ASSERT_EQ(visits[index], 1);
+        }
+    }
+}
+
+/// @brief Исключение при обработке элемента пробрасывается вызывающему, пул остается работоспособным
+TEST(ThreadPool, RethrowsExceptionAndStaysUsable)
+{
+    thread_pool_t pool(3);
+    ASSERT_THROW(pool.parallel_for(100, [](size_t index) {
+        if (index == 42) {
+            throw std::runtime_error("item failed");
+        }
+    }), std::runtime_error);
+
+    std::atomic<size_t> sum{ 0 };
+    pool.parallel_for(100, [&](size_t index) {
+        sum += index;
+    });
+    ASSERT_EQ(sum, 4950);
+}
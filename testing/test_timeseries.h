@@ -37,6 +37,93 @@ TEST(CsvRead, ReadStreamWithPeriod)
     ASSERT_NEAR(6200.0, values[1], 1);
 }
 
+/// @brief Эталонный построчный разбор (getline, split_str, StringToUnix, str2double)
+/// для проверки быстрого разбора csv_tag_reader
+inline pair<vector<time_t>, vector<double>> read_csv_reference(std::istream& input_stream, const string& dimension,
+    time_t time_begin = std::numeric_limits<time_t>::min(), time_t time_end = std::numeric_limits<time_t>::max())
+{
+    pair<vector<time_t>, vector<double>> result;
+    string line;
+    while (getline(input_stream, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        vector<string> fields = split_str(line, ';');
+        time_t ut = StringToUnix(fields[0]);
+        if (ut < time_begin) {
+            continue;
+        }
+        if (ut > time_end) {
+            break;
+        }
+        result.first.push_back(ut);
+        result.second.push_back(dimension_converter().convert(str2double(fields[1], ','), dimension));
+    }
+    return result;
+}
+
+/// @brief Формирует синтетические исторические данные с шагом 1 с (запятая - десятичный разделитель)
+inline string generate_scada_csv(size_t line_count, const string& line_end = "\n")
+{
+    string result;
+    time_t t = StringToUnix("31.12.2020 23:59:00");
+    for (size_t index = 0; index < line_count; ++index) {
+        string value = std::to_string(5 + 0.001 * (index % 1000));
+        std::replace(value.begin(), value.end(), '.', ',');
+        result += UnixToString(t + index) + ";" + value + line_end;
+    }
+    return result;
+}
+
+/// @brief Быстрый разбор совпадает с построчным, включая перевод единиц, 
+/// переводы строк Windows и пустые строки
+TEST(CsvRead, FastParserMatchesLineByLineParsing)
+{
+    string content = generate_scada_csv(5000, "\r\n") + "\r\n\n";
+    content += "01.01.2021 02:00:00;  7,25\n";
+    content += "01.01.2021 02:00:01;8.5e-1";
+
+    stringstream reference_stream(content);
+    auto [reference_time, reference_values] = read_csv_reference(reference_stream, "kgf/cm2");
+    stringstream stream(content);
+    auto [time, values] = csv_tag_reader::read_from_stream(stream, "kgf/cm2");
+
+    ASSERT_EQ(time.size(), 5002);
+    ASSERT_EQ(time, reference_time);
+    ASSERT_EQ(values, reference_values);
+}
+
+/// @brief Параллельный разбор большого файла по частям совпадает с последовательным,
+/// в том числе при остановке на конце периода внутри одной из частей
+TEST(CsvRead, ParallelFileParsingMatchesSequential)
+{
+    string path = prepare_test_folder();
+    string tag = path + "pressure";
+    string content = generate_scada_csv(300000); // ~9 МБ, больше порога параллельного разбора
+    {
+        std::ofstream file(tag + ".csv", std::ios::binary);
+        file << content;
+    }
+
+    time_t time_begin = StringToUnix("01.01.2021 00:10:00");
+    time_t time_end = StringToUnix("01.01.2021 02:30:00");
+
+    stringstream reference_stream(content);
+    auto reference = read_csv_reference(reference_stream, "MPa", time_begin, time_end);
+    auto data = csv_tag_reader(tag, "MPa").read_csv(time_begin, time_end);
+
+    ASSERT_EQ(data.first.front(), time_begin);
+    ASSERT_EQ(data.first.back(), time_end);
+    ASSERT_EQ(data.first, reference.first);
+    ASSERT_EQ(data.second, reference.second);
+
+    auto whole_file = csv_tag_reader(tag, "MPa").read_csv();
+    ASSERT_EQ(whole_file.first.size(), 300000);
+}
+
 /// @brief Проверка функции интерполяции временных рядов 
 TEST(VectorTimeseries, InterpolateTimeseries)
 {
@@ -90,6 +177,177 @@ TEST(VectorTimeseries, CheckWrongTime)
     ASSERT_ANY_THROW(timeseries(wrong_time));
 }
 
+/// @brief Курсор дает те же значения, что и vector_timeseries_t::operator(), 
+/// включая моменты после окончания рядов и совпадающие с точками данных
+TEST(VectorTimeseries, CursorMatchesInterpolation)
+{
+    vector<time_t> pressure_times{ 1000, 1600, 2200, 6100 };
+    vector<double> pressure_values{ 5e6, 6e6, 6.2e6, 5.5e6 };
+    vector<time_t> density_times;
+    vector<double> density_values;
+    for (time_t t = 900; t <= 7000; t += 50) {
+        density_times.push_back(t);
+        density_values.push_back(850 + 0.01 * (t % 700));
+    }
+    vector_timeseries_t timeseries({ { pressure_times, pressure_values }, { density_times, density_values } });
+
+    vector_timeseries_cursor_t cursor(timeseries);
+    vector<double> values;
+    for (time_t t = 1000; t <= 7200; t += 37) {
+        vector<double> expected = timeseries(t);
+        cursor.interpolate(t, &values);
+        for (size_t index = 0; index < expected.size(); ++index) {
+            if (std::isnan(expected[index])) {
+                ASSERT_TRUE(std::isnan(values[index]));
+            }
+            else {
+                ASSERT_EQ(values[index], expected[index]);
+            }
+        }
+    }
+    cursor.interpolate(2200, &values);
+    ASSERT_EQ(values[0], 6.2e6);
+}
+
+/// @brief Независимые курсоры над одними данными, в том числе с движением назад во времени
+TEST(VectorTimeseries, IndependentCursorsAllowTimeGoingBack)
+{
+    vector<time_t> times{ 0, 100, 200, 300 };
+    vector<double> values{ 0, 10, 20, 30 };
+    const vector_timeseries_t timeseries({ { times, values } });
+
+    vector_timeseries_cursor_t forward(timeseries);
+    vector_timeseries_cursor_t backward(timeseries);
+    double value;
+
+    forward.interpolate(250, &value);
+    ASSERT_DOUBLE_EQ(value, 25);
+    backward.interpolate(50, &value); // второй курсор не зависит от первого
+    ASSERT_DOUBLE_EQ(value, 5);
+
+    forward.interpolate(120, &value); // назад во времени - без исключения
+    ASSERT_DOUBLE_EQ(value, 12);
+    forward.interpolate(300, &value);
+    ASSERT_DOUBLE_EQ(value, 30);
+    forward.interpolate(301, &value);
+    ASSERT_TRUE(std::isnan(value));
+}
+
+/// @brief Шаги по времени попадают точно на изломы рядов и конец периода,
+/// постоянные и линейные участки событиями не являются
+TEST(VectorTimeseries, TimeStepControllerLandsOnEvents)
+{
+    vector<time_t> times;
+    vector<double> density;
+    vector<double> flow;
+    vector<double> pressure;
+    for (time_t t = 0; t <= 3600; t += 60) {
+        times.push_back(t);
+        density.push_back(t <= 1800 ? 850 : 870); // скачок между 1800 и 1860
+        flow.push_back(0.2 + 1e-5 * static_cast<double>(t)); // линейное изменение
+        pressure.push_back(6e6 * (1 + ((t / 60) % 2 == 0 ? 1e-7 : -1e-7))); // шум ниже порога
+    }
+    const vector_timeseries_t timeseries({ { times, density }, { times, flow }, { times, pressure } });
+
+    timeseries_time_step_controller_t controller(timeseries, 1e-6);
+    ASSERT_EQ(controller.get_event_times(), (vector<time_t>{ 1800, 1860, 3600 }));
+    // Без порога шум в каждом отсчете давления - событие
+    timeseries_time_step_controller_t strict_controller(timeseries);
+    ASSERT_EQ(strict_controller.get_event_times().size(), times.size() - 1);
+
+    vector<time_t> step_times{ 0 };
+    time_t t = 0;
+    while (time_t step = controller.get_time_step(t, 700.9)) {
+        ASSERT_LE(step, 700);
+        t += step;
+        step_times.push_back(t);
+    }
+    ASSERT_EQ(step_times, (vector<time_t>{ 0, 700, 1400, 1800, 1860, 2560, 3260, 3600 }));
+
+    // Шаг не превышает max_dt: при max_dt < 1 с целого шага нет; NaN - шаг до ближайшего события
+    ASSERT_EQ(controller.get_time_step(1000, 1.0), 1);
+    ASSERT_THROW(controller.get_time_step(1000, 0.3), std::logic_error);
+    ASSERT_EQ(controller.get_time_step(1000, std::numeric_limits<double>::quiet_NaN()), 800);
+    // Движение назад во времени
+    ASSERT_EQ(controller.get_time_step(10, 1e6), 1790);
+    ASSERT_EQ(controller.get_time_step(3600, 100), 0);
+}
+
+/// @brief Матрица значений на равномерной сетке совпадает с интерполяцией курсором,
+/// в том числе вне периода рядов с разными моментами отсчетов
+TEST(VectorTimeseries, MatrixMatchesCursor)
+{
+    vector<time_t> pressure_times{ 100, 160, 170, 400, 1000 };
+    vector<double> pressure_values{ 6e6, 6.1e6, 5.9e6, 6.3e6, 6.2e6 };
+    vector<time_t> density_times{ 50, 300, 1200 };
+    vector<double> density_values{ 850, 860, 855 };
+    const vector_timeseries_t timeseries({ { pressure_times, pressure_values }, { density_times, density_values } });
+
+    // Сетка начинается до начала и заканчивается после конца рядов
+    timeseries_matrix_t matrix(timeseries, 40, 7, 200);
+    ASSERT_EQ(matrix.get_row_count(), 200);
+    ASSERT_EQ(matrix.get_column_count(), 2);
+    ASSERT_EQ(matrix.get_values().size(), 400);
+
+    vector_timeseries_cursor_t cursor(timeseries);
+    vector<double> expected;
+    for (size_t row = 0; row < matrix.get_row_count(); ++row) {
+        cursor.interpolate(matrix.get_time(row), &expected);
+        for (size_t column = 0; column < matrix.get_column_count(); ++column) {
+            double value = matrix.row(row)[column];
+            if (std::isnan(expected[column])) {
+                ASSERT_TRUE(std::isnan(value));
+            }
+            else {
+                ASSERT_EQ(value, expected[column]);
+            }
+        }
+    }
+
+    // Равномерная сетка по периоду рядов
+    timeseries_matrix_t period_matrix = timeseries_matrix_t::resample(timeseries, 60);
+    ASSERT_EQ(period_matrix.get_time(0), timeseries.get_start_date());
+    ASSERT_EQ(period_matrix.get_row_count(), 16); // 100..1000 с шагом 60
+    ASSERT_LE(period_matrix.get_time(period_matrix.get_row_count() - 1), timeseries.get_end_date());
+    ASSERT_THROW(timeseries_matrix_t(timeseries, 0, 0, 10), std::logic_error);
+}
+
+/// @brief Квазистационарный расчет по строкам матрицы краевых условий совпадает
+/// с расчетом по интерполяции курсором на каждом шаге
+TEST(VectorTimeseries, QuasistaticTaskConsumesMatrixRows)
+{
+    simple_pipe_properties simple_pipe;
+    simple_pipe.length = 10e3;
+    simple_pipe.dx = 100;
+    pipe_properties_t pipe = pipe_properties_t::build_simple_pipe(simple_pipe);
+
+    vector<time_t> times{ 0, 3600, 3660, 7200 };
+    const vector_timeseries_t timeseries({
+        { times, { 0.2, 0.2, 0.25, 0.25 } },
+        { times, { 6e6, 6e6, 6.2e6, 6.2e6 } },
+        { times, { 850, 850, 870, 870 } },
+        { times, { 15e-6, 15e-6, 25e-6, 25e-6 } },
+    });
+    const time_t dt = 45;
+    timeseries_matrix_t matrix = timeseries_matrix_t::resample(timeseries, dt);
+
+    isothermal_quasistatic_task_boundaries_t initial_boundaries =
+        isothermal_quasistatic_task_boundaries_t::default_values();
+    isothermal_quasistatic_task_t<advection_moc_solver> cursor_task(pipe);
+    isothermal_quasistatic_task_t<advection_moc_solver> matrix_task(pipe);
+    cursor_task.solve(initial_boundaries);
+    matrix_task.solve(initial_boundaries);
+
+    vector_timeseries_cursor_t cursor(timeseries);
+    vector<double> values;
+    for (size_t row = 0; row < matrix.get_row_count(); ++row) {
+        cursor.interpolate(matrix.get_time(row), &values);
+        cursor_task.step(static_cast<double>(dt), isothermal_quasistatic_task_boundaries_t(values));
+        matrix_task.step(static_cast<double>(dt), isothermal_quasistatic_task_boundaries_t(matrix.row(row)));
+        ASSERT_EQ(matrix_task.get_buffer().current().pressure, cursor_task.get_buffer().current().pressure);
+    }
+}
+
 /// @brief Пример использование библиотеки timeseries.h 
 TEST(Timeseries, UseCase)
 {
@@ -0,0 +1,64 @@
+﻿#pragma once
+
+/// @brief Экспонента без ветвлений совпадает с std::exp до нескольких ulp во всем рабочем диапазоне
+TEST(ViscosityTableProfile, BranchlessExpMatchesStdExp)
+{
+    for (double x = -700; x <= 700; x += 0.37) {
+        double expected = std::exp(x);
+        ASSERT_NEAR(viscosity_table_profile_t::exp(x), expected, 4e-16 * expected);
+    }
+    ASSERT_EQ(viscosity_table_profile_t::exp(0), 1.0);
+    ASSERT_TRUE(std::isnan(viscosity_table_profile_t::exp(std::numeric_limits<double>::quiet_NaN())));
+}
+
+/// @brief Профиль из чередующихся партий с разными моделями (ФФТ, Филонов-Рейнольдс, константа)
+/// рассчитывается так же, как поточечный viscosity_table_model_t::calc
+TEST(ViscosityTableProfile, MatchesPointwiseModelForInterleavedBatches)
+{
+    vector<array<double, 3>> batch_tables{
+        { 50e-6, 20e-6, 8e-6 },         // ФФТ
+        { 40e-6, 20e-6, 7.071067811865475e-6 }, // Филонов-Рейнольдс: nu3 = nu2 * (nu2 / nu1)^1.5
+        { 15e-6, 15e-6, 15e-6 },        // константа
+    };
+
+    const size_t point_count = 1000;
+    vector<array<double, 3>> tables(point_count);
+    vector<double> temperature(point_count);
+    for (size_t index = 0; index < point_count; ++index) {
+        tables[index] = batch_tables[(index / 70) % batch_tables.size()];
+        temperature[index] = KELVIN_OFFSET + 5 + 40.0 * index / point_count;
+    }
+
+    viscosity_table_profile_t profile = viscosity_table_profile_t::reconstruct(tables);
+    ASSERT_EQ(profile.model[0], viscosity_table_profile_t::model_vft);
+    ASSERT_EQ(profile.model[70], viscosity_table_profile_t::model_filonov_reynolds);
+    ASSERT_EQ(profile.model[140], viscosity_table_profile_t::model_constant);
+
+    vector<double> viscosity(point_count);
+    profile.calc(temperature, &viscosity);
+
+    vector<array<double, 3>> approximations(point_count);
+    for (size_t index = 0; index < point_count; ++index) {
+        approximations[index] = viscosity_table_model_t::reconstruct(tables[index]);
+        double expected = viscosity_table_model_t::calc(approximations[index], temperature[index]);
+        ASSERT_NEAR(viscosity[index], expected, 1e-14 * expected);
+        ASSERT_NEAR(profile.calc(index, temperature[index]), viscosity[index], 1e-14 * expected);
+    }
+
+    // Профиль по готовым аппроксимациям (как в fluid_properties_profile_t) дает тот же результат
+    viscosity_table_profile_t profile_from_approximations =
+        viscosity_table_profile_t::from_approximations(approximations);
+    vector<double> viscosity_from_approximations(point_count);
+    profile_from_approximations.calc(temperature, &viscosity_from_approximations);
+    ASSERT_EQ(viscosity_from_approximations, viscosity);
+}
+
+/// @brief Размеры профиля температуры и результата проверяются
+TEST(ViscosityTableProfile, RejectsSizeMismatch)
+{
+    viscosity_table_profile_t profile = viscosity_table_profile_t::reconstruct(
+        vector<array<double, 3>>(10, array<double, 3>{ 15e-6, 15e-6, 15e-6 }));
+    vector<double> temperature(10, KELVIN_OFFSET + 20);
+    vector<double> viscosity(9);
+    ASSERT_THROW(profile.calc(temperature, &viscosity), std::runtime_error);
+}
@@ -0,0 +1,94 @@
+%% Читает историю профилей из бинарного колоночного файла (*.pdeprof),
+% записанного binary_profile_writer_t / binary_layer_sink_t
+% Возвращает: time - моменты времени слоев (столбец),
+% data = Map<имя профиля, матрица [количество значений x количество слоев]>,
+% unitof = Map<имя, единицы измерения>, gridof = Map<имя, 'points' или 'cells'>,
+% grid - координаты сетки (пусто, если не записывались)
+function [time, data, unitof, gridof, grid] = read_binary_profiles(filename)
+
+fid = fopen(filename, 'r', 'ieee-le');
+if fid < 0
+    error('Cannot open file %s', filename);
+end
+cleanup = onCleanup(@() fclose(fid));
+
+% заголовок
+magic = fread(fid, [1 8], '*char');
+if ~strcmp(magic, 'PDEPRF01')
+    error('%s is not a profile file', filename);
+end
+version = fread(fid, 1, 'uint32');
+if version ~= 1
+    error('Unsupported format version %d', version);
+end
+flags = fread(fid, 1, 'uint32');
+profile_count = fread(fid, 1, 'uint32');
+fread(fid, 1, 'uint32');
+grid_size = fread(fid, 1, 'uint64');
+record_size = fread(fid, 1, 'uint64');
+data_offset = fread(fid, 1, 'uint64');
+
+if bitand(flags, 1)
+    value_type = 'float32';
+    value_size = 4;
+else
+    value_type = 'float64';
+    value_size = 8;
+end
+
+% описания профилей и смещения столбцов внутри записи
+names = cell(profile_count, 1);
+counts = zeros(profile_count, 1);
+offsets = zeros(profile_count, 1);
+unitof = containers.Map;
+gridof = containers.Map;
+offset = 8; % время слоя
+for i = 1:profile_count
+    on_cells = fread(fid, 1, 'uint32');
+    fread(fid, 1, 'uint32');
+    counts(i) = fread(fid, 1, 'uint64');
+    names{i} = read_string(fid);
+    unitof(names{i}) = read_string(fid);
+    if on_cells
+        gridof(names{i}) = 'cells';
+    else
+        gridof(names{i}) = 'points';
+    end
+    offsets(i) = offset;
+    offset = offset + ceil(counts(i) * value_size / 8) * 8;
+end
+
+fseek(fid, data_offset - 8 * grid_size, 'bof');
+grid = fread(fid, grid_size, 'float64');
+
+% количество слоев - из индекса, а если файл не закрыт - по размеру
+fseek(fid, 0, 'eof');
+file_size = ftell(fid);
+record_count = floor((file_size - data_offset) / record_size);
+if file_size >= data_offset + 24
+    fseek(fid, file_size - 8, 'bof');
+    if strcmp(fread(fid, [1 8], '*char'), 'PDEIDX01')
+        fseek(fid, file_size - 24, 'bof');
+        record_count = fread(fid, 1, 'uint64');
+    end
+end
+
+% столбцы читаются целиком с пропуском остальной части записи
+fseek(fid, data_offset, 'bof');
+time = fread(fid, record_count, 'float64', record_size - 8);
+
+data = containers.Map;
+for i = 1:profile_count
+    fseek(fid, data_offset + offsets(i), 'bof');
+    precision = sprintf('%d*%s', counts(i), value_type);
+    data(names{i}) = fread(fid, [counts(i) record_count], precision, ...
+        record_size - counts(i) * value_size);
+end
+
+end
+
+%%
+function value = read_string(fid)
+value_length = fread(fid, 1, 'uint32');
+value = native2unicode(fread(fid, [1 value_length], '*uint8'), 'UTF-8');
+end
@@ -0,0 +1,72 @@
+import struct
+import numpy as np
+
+# Чтение истории профилей из бинарного колоночного файла (*.pdeprof),
+# записанного binary_profile_writer_t / binary_layer_sink_t.
+# Файл отображается в память, профили возвращаются как представления numpy без разбора и копирования
+
+HEADER_FORMAT = '<8sIIIIQQQ'
+TRAILER_FORMAT = '<QQ8s'
+
+
+def read_binary_profiles(filename):
+    """Возвращает словарь:
+    time - моменты времени слоев,
+    profiles - {имя: массив [количество слоев x количество значений]},
+    units - {имя: единицы измерения}, on_cells - {имя: профиль на ячейках},
+    grid - координаты сетки (пустой массив, если не записывались)"""
+    raw = np.memmap(filename, dtype=np.uint8, mode='r')
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    magic, version, flags, profile_count, _, grid_size, record_size, data_offset = \
+        struct.unpack(HEADER_FORMAT, raw[:header_size].tobytes())
+    if magic != b'PDEPRF01':
+        raise ValueError(filename + ' is not a profile file')
+    if version != 1:
+        raise ValueError('Unsupported format version %d' % version)
+    value_type = '<f4' if flags & 1 else '<f8'
+    value_size = np.dtype(value_type).itemsize
+
+    def read(fmt, offset):
+        size = struct.calcsize(fmt)
+        return struct.unpack(fmt, raw[offset:offset + size].tobytes()), offset + size
+
+    def read_string(offset):
+        (length,), offset = read('<I', offset)
+        return raw[offset:offset + length].tobytes().decode('utf-8'), offset + length
+
+    names, formats, offsets = ['time'], ['<f8'], [0]
+    units, on_cells = {}, {}
+    offset = header_size
+    column_offset = 8
+    for _ in range(profile_count):
+        (cells, _, count), offset = read('<IIQ', offset)
+        name, offset = read_string(offset)
+        units[name], offset = read_string(offset)
+        on_cells[name] = cells != 0
+        names.append(name)
+        formats.append((value_type, (count,)))
+        offsets.append(column_offset)
+        column_offset += (count * value_size + 7) // 8 * 8
+
+    grid = np.ndarray((grid_size,), dtype='<f8', buffer=raw, offset=data_offset - 8 * grid_size)
+
+    # Количество слоев - из индекса, а если файл не закрыт - по размеру
+    record_count = (raw.size - data_offset) // record_size
+    trailer_size = struct.calcsize(TRAILER_FORMAT)
+    if raw.size >= data_offset + trailer_size:
+        (count, _, index_magic), _ = read(TRAILER_FORMAT, raw.size - trailer_size)
+        if index_magic == b'PDEIDX01':
+            record_count = count
+
+    record_type = np.dtype({'names': names, 'formats': formats,
+                            'offsets': offsets, 'itemsize': record_size})
+    records = np.ndarray((record_count,), dtype=record_type, buffer=raw, offset=data_offset)
+
+    return {
+        'time': records['time'],
+        'profiles': {name: records[name] for name in names[1:]},
+        'units': units,
+        'on_cells': on_cells,
+        'grid': grid,
+    }